@@ -0,0 +1,127 @@
+#include "BenchmarkPage.h"
+#include "StringConverter.h"
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+static const wchar_t* RESULTS_FILE_PATH = L"BenchmarkResults.csv";
+
+BenchmarkPage::BenchmarkPage(std::shared_ptr<DX::ManualClock> benchmarkClock, uint32_t windowCount):
+	BenchmarkClock(benchmarkClock),
+	WindowCount(windowCount)
+{
+}
+
+void BenchmarkPage::Initialize(DivergenceEngine::Window* windowReference)
+{
+	WindowReference = windowReference;
+
+	//Frames are not held back by the display, so the results show how long the engine itself takes to make them
+	WindowReference->GraphicsController->SetVerticalSync(false);
+
+	Scenarios = CreateBenchmarkScenarios();
+	StartScenario();
+
+	DivergenceEngine::Logger::Log(L"BenchmarkPage Constructed");
+}
+
+BenchmarkPage::~BenchmarkPage()
+{
+	DivergenceEngine::Logger::Log(L"BenchmarkPage Destructed");
+}
+
+void BenchmarkPage::UpdatePage(const DX::StepTimer& timer)
+{
+	//Step time to the next frame, so the application draws it as soon as this one is done
+	if (BenchmarkClock)
+	{
+		BenchmarkClock->Advance(DX::ManualClock::TicksPerSecond / DivergenceEngine::Application::GetFrameRate());
+	}
+
+	if (CurrentScenarioIndex >= Scenarios.size())
+	{
+		return;
+	}
+
+	Scenarios[CurrentScenarioIndex]->Step(WindowReference, FrameInScenario);
+	FrameInScenario++;
+
+	if (FrameInScenario == WARMUP_FRAMES)
+	{
+		WindowReference->ResetRenderStatistics();
+		MeasurementStartTime = std::chrono::steady_clock::now();
+	}
+	else if (FrameInScenario == WARMUP_FRAMES + MEASURED_FRAMES)
+	{
+		FinishScenario();
+	}
+}
+
+//Private helpers----------------------------------------------------------------------------------
+void BenchmarkPage::StartScenario()
+{
+	//Every scenario starts drawn on the main thread, and only the ones measuring the render thread turn it on
+	WindowReference->SetRenderPipeline(DivergenceEngine::Window::RenderPipelineClass::Serial);
+	WindowReference->ClearAllLayers();
+	FrameInScenario = 0;
+	Scenarios[CurrentScenarioIndex]->Populate(WindowReference);
+	WindowReference->ResetRenderStatistics();
+
+	DIVERGENCE_LOG_INFO(L"Benchmark started: {}", Scenarios[CurrentScenarioIndex]->GetName());
+}
+
+void BenchmarkPage::FinishScenario()
+{
+	//The clock is stepped by hand, so only the wall clock knows how fast the frames really went
+	std::chrono::duration<double> measuredTime = std::chrono::steady_clock::now() - MeasurementStartTime;
+	double framesPerSecond = static_cast<double>(MEASURED_FRAMES) / measuredTime.count();
+
+	const BenchmarkScenario& scenario = *Scenarios[CurrentScenarioIndex];
+	const DivergenceEngine::Window::RenderStatistics& statistics = WindowReference->GetRenderStatistics();
+	DIVERGENCE_LOG_INFO(L"Benchmark finished: {} - {:.3f} ms CPU per frame, {:.1f} frames per second {}",
+		scenario.GetName(), statistics.AverageFrameCPUMilliseconds, framesPerSecond, scenario.GetDetails());
+	AppendResult(scenario, framesPerSecond);
+
+	CurrentScenarioIndex++;
+	if (CurrentScenarioIndex < Scenarios.size())
+	{
+		StartScenario();
+	}
+	else
+	{
+		PostMessage(WindowReference->GetHandle(), WM_CLOSE, 0, 0);
+	}
+}
+
+void BenchmarkPage::AppendResult(const BenchmarkScenario& scenario, double framesPerSecond)
+{
+	bool isNewFile = !std::filesystem::exists(RESULTS_FILE_PATH) || std::filesystem::file_size(RESULTS_FILE_PATH) == 0;
+	std::ofstream resultsFile(RESULTS_FILE_PATH, std::ios::out | std::ios::app);
+	if (!resultsFile.is_open())
+	{
+		throw std::runtime_error("BenchmarkPage::AppendResult() - Could not open BenchmarkResults.csv");
+	}
+
+	if (isNewFile)
+	{
+		resultsFile << "scenario,window,windows,window_threading,frames,average_frame_cpu_ms,frames_per_second,frames_presented,frames_skipped,layers_redrawn,process_cpu_usage,average_render_thread_ms,details\n";
+	}
+
+	bool isRenderThreadPerWindow = DivergenceEngine::Application::GetWindowThreading() == DivergenceEngine::WindowThreadingClass::RenderThreadPerWindow;
+	const DivergenceEngine::Window::RenderStatistics& statistics = WindowReference->GetRenderStatistics();
+	resultsFile << std::format("{},{},{},{},{},{:.4f},{:.2f},{},{},{},{:.3f},{:.4f},{}\n",
+		DivergenceEngine::StringConverter::ConvertWideStringToUTF8(scenario.GetName()),
+		DivergenceEngine::StringConverter::ConvertWideStringToUTF8(WindowReference->GetWindowTitle()),
+		WindowCount,
+		isRenderThreadPerWindow ? "RenderThreadPerWindow" : "Shared",
+		MEASURED_FRAMES,
+		statistics.AverageFrameCPUMilliseconds,
+		framesPerSecond,
+		statistics.FramesPresented,
+		statistics.FramesSkipped,
+		statistics.LayersRedrawn,
+		statistics.ProcessCPUUsage,
+		statistics.AverageRenderThreadMilliseconds,
+		DivergenceEngine::StringConverter::ConvertWideStringToUTF8(scenario.GetDetails()));
+}
\ No newline at end of file
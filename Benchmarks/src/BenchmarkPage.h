@@ -0,0 +1,41 @@
+#pragma once
+#include "DivergenceEngine.h"
+#include "BenchmarkScenarios.h"
+#include <chrono>
+#include <memory>
+#include <vector>
+
+//Runs every benchmark scenario in its window, one after the other, appending how each one did to BenchmarkResults.csv. Closes the window once they are all done
+class BenchmarkPage : public DivergenceEngine::IPage
+{
+private:
+	//Constants
+	static constexpr uint64_t WARMUP_FRAMES = 30; //Left out of the results, while caches fill and the layers settle
+	static constexpr uint64_t MEASURED_FRAMES = 300;
+
+	//Datafields
+	DivergenceEngine::Window* WindowReference = nullptr;
+	std::shared_ptr<DX::ManualClock> BenchmarkClock; //Steps the application to the next frame after every update. Only one page is given it
+	uint32_t WindowCount;
+	std::vector<std::unique_ptr<BenchmarkScenario>> Scenarios;
+	size_t CurrentScenarioIndex = 0;
+	uint64_t FrameInScenario = 0;
+	std::chrono::steady_clock::time_point MeasurementStartTime;
+
+	//Private helpers
+	void StartScenario();
+	void FinishScenario();
+	void AppendResult(const BenchmarkScenario& scenario, double framesPerSecond);
+
+public:
+	//Constructors and destructors
+	BenchmarkPage(std::shared_ptr<DX::ManualClock> benchmarkClock, uint32_t windowCount);
+	void Initialize(DivergenceEngine::Window* windowReference) override;
+	~BenchmarkPage();
+
+	//Overridden functions
+	void UpdatePage(const DX::StepTimer& timer) override;
+	void HandleScroll(int scrollDelta) override {}
+	void HandleMouseMove(DirectX::XMINT2 newMousePos) override {}
+	bool OnWindowDestructionRequest() override { return true; }
+};
\ No newline at end of file
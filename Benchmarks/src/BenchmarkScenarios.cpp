@@ -0,0 +1,437 @@
+#include "BenchmarkScenarios.h"
+#include <algorithm>
+#include <cmath>
+#include <format>
+
+using namespace DivergenceEngine::Templates;
+
+//The benchmarks borrow the Demo's assets, and are run from their project folder, like the Demo
+static const wchar_t* SPRITE_TEXTURE_PATH = L"..\\Demo\\Images\\TypableTitlePage\\Bison.png";
+static constexpr int32_t SPRITE_SIZE = 4;
+static const wchar_t* TEXT_FONT_PATH = L"..\\Demo\\Fonts\\M PLUS 1 (Size_16).spritefont";
+
+//Helpers------------------------------------------------------------------------------------------
+static const wchar_t* GetCommandRecordingName(DivergenceEngine::Window::CommandRecordingClass commandRecording)
+{
+	switch (commandRecording)
+	{
+	case DivergenceEngine::Window::CommandRecordingClass::Serial:
+		return L"Serial";
+
+	case DivergenceEngine::Window::CommandRecordingClass::Parallel:
+		return L"Parallel";
+
+	default:
+		return L"Off";
+	}
+}
+
+//Tiles the buffer with sprites, wrapping back to the top left once it is covered, so any number of them stay on screen
+static std::shared_ptr<Image> CreateGridSprite(DivergenceEngine::Window* window, size_t spriteIndex)
+{
+	DirectX::XMINT2 bufferSize = window->GraphicsController->GetBufferSize();
+	size_t columns = static_cast<size_t>(bufferSize.x / SPRITE_SIZE);
+	size_t rows = static_cast<size_t>(bufferSize.y / SPRITE_SIZE);
+
+	DirectX::SimpleMath::Vector2 position(
+		static_cast<float>((spriteIndex % columns) * SPRITE_SIZE),
+		static_cast<float>(((spriteIndex / columns) % rows) * SPRITE_SIZE));
+	return std::make_shared<Image>(SPRITE_TEXTURE_PATH, window->GraphicsController, position, DirectX::SimpleMath::Vector2(SPRITE_SIZE, SPRITE_SIZE));
+}
+
+//Posts one frame's worth of mouse moves, at the pace a high rate mouse would send them, then a click. The messages are
+//handled before the next frame is drawn
+static void PostMouseSweep(DivergenceEngine::Window* window, uint64_t frameIndex, uint32_t eventsPerSecond)
+{
+	DirectX::XMINT2 bufferSize = window->GraphicsController->GetBufferSize();
+	uint64_t eventsPerFrame = eventsPerSecond / DivergenceEngine::Application::GetFrameRate();
+	for (uint64_t eventIndex = 0; eventIndex < eventsPerFrame; eventIndex++)
+	{
+		//A diagonal sweep that wraps around, so the mouse is over something new on most events
+		uint64_t step = frameIndex * eventsPerFrame + eventIndex;
+		int x = static_cast<int>((step * 7) % static_cast<uint64_t>(bufferSize.x));
+		int y = static_cast<int>((step * 3) % static_cast<uint64_t>(bufferSize.y));
+		PostMessage(window->GetHandle(), WM_MOUSEMOVE, 0, MAKELPARAM(x, y));
+	}
+
+	PostMessage(window->GetHandle(), WM_LBUTTONDOWN, MK_LBUTTON, 0);
+	PostMessage(window->GetHandle(), WM_LBUTTONUP, 0, 0);
+}
+
+//SpriteScenario-----------------------------------------------------------------------------------
+SpriteScenario::SpriteScenario(DivergenceEngine::Window::CommandRecordingClass commandRecording, size_t spriteCount):
+	CommandRecording(commandRecording),
+	SpriteCount(spriteCount)
+{
+}
+
+std::wstring SpriteScenario::GetName() const
+{
+	return std::format(L"Sprites{}-Recording{}", SpriteCount, GetCommandRecordingName(CommandRecording));
+}
+
+void SpriteScenario::Populate(DivergenceEngine::Window* window)
+{
+	window->SetRenderMode(DivergenceEngine::Window::RenderModeClass::Immediate);
+	window->SetCommandRecording(CommandRecording);
+	for (size_t spriteIndex = 0; spriteIndex < SpriteCount; spriteIndex++)
+	{
+		window->AddDrawableComponent(CreateGridSprite(window, spriteIndex), 0);
+	}
+}
+
+//ButtonHitTestScenario----------------------------------------------------------------------------
+ButtonHitTestScenario::CountingButton::CountingButton(ButtonHitTestScenario& scenario, std::weak_ptr<DivergenceEngine::Graphics> graphicsController, DirectX::SimpleMath::Rectangle bounds):
+	Scenario(scenario),
+	WindowGraphicsController(graphicsController),
+	Bounds(bounds)
+{
+	WindowGraphicsController.lock()->LoadTexture(SPRITE_TEXTURE_PATH, ButtonTexture);
+}
+
+void ButtonHitTestScenario::CountingButton::Draw()
+{
+	if (IsHovered)
+	{
+		WindowGraphicsController.lock()->DrawSizedSprite(ButtonTexture->ShaderResourceView.Get(),
+			DirectX::SimpleMath::Vector2(static_cast<float>(Bounds.x), static_cast<float>(Bounds.y)),
+			DirectX::SimpleMath::Vector2(static_cast<float>(Bounds.width), static_cast<float>(Bounds.height)));
+	}
+}
+
+bool ButtonHitTestScenario::CountingButton::IsCoordInObject(DirectX::XMINT2 mousePos)
+{
+	return Bounds.Contains(static_cast<long>(mousePos.x), static_cast<long>(mousePos.y));
+}
+
+void ButtonHitTestScenario::CountingButton::OnMouseEnter(DirectX::XMINT2 mousePos)
+{
+	Scenario.Enters++;
+	IsHovered = true;
+	MarkDirty();
+}
+
+void ButtonHitTestScenario::CountingButton::OnMouseLeave()
+{
+	Scenario.Leaves++;
+	IsHovered = false;
+	MarkDirty();
+}
+
+bool ButtonHitTestScenario::CountingButton::OnLeftPress(DirectX::XMINT2 mousePos)
+{
+	Scenario.Presses++;
+	return true;
+}
+
+ButtonHitTestScenario::ButtonHitTestScenario(size_t buttonCount):
+	ButtonCount(buttonCount)
+{
+}
+
+std::wstring ButtonHitTestScenario::GetName() const
+{
+	return std::format(L"Buttons{}-Mouse{}Hz", ButtonCount, MOUSE_EVENTS_PER_SECOND);
+}
+
+std::wstring ButtonHitTestScenario::GetDetails() const
+{
+	return std::format(L"enters={} leaves={} presses={}", Enters, Leaves, Presses);
+}
+
+void ButtonHitTestScenario::Populate(DivergenceEngine::Window* window)
+{
+	//Only the buttons the mouse comes over or leaves are drawn again, so the frame time is mostly the hit testing
+	window->SetRenderMode(DivergenceEngine::Window::RenderModeClass::Retained);
+	window->SetCommandRecording(DivergenceEngine::Window::CommandRecordingClass::Off);
+	Enters = 0;
+	Leaves = 0;
+	Presses = 0;
+
+	//As square a grid as fits the buffer
+	DirectX::XMINT2 bufferSize = window->GraphicsController->GetBufferSize();
+	size_t columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(ButtonCount))));
+	size_t rows = (ButtonCount + columns - 1) / columns;
+	long buttonWidth = (std::max)(1L, static_cast<long>(bufferSize.x / columns));
+	long buttonHeight = (std::max)(1L, static_cast<long>(bufferSize.y / rows));
+	for (size_t buttonIndex = 0; buttonIndex < ButtonCount; buttonIndex++)
+	{
+		DirectX::SimpleMath::Rectangle bounds(
+			static_cast<long>(buttonIndex % columns) * buttonWidth,
+			static_cast<long>(buttonIndex / columns) * buttonHeight,
+			buttonWidth,
+			buttonHeight);
+		window->AddDrawableComponent(std::make_shared<CountingButton>(*this, window->GraphicsController, bounds), 0);
+	}
+}
+
+void ButtonHitTestScenario::Step(DivergenceEngine::Window* window, uint64_t frameIndex)
+{
+	PostMouseSweep(window, frameIndex, MOUSE_EVENTS_PER_SECOND);
+}
+
+//LayerStoreChurnScenario--------------------------------------------------------------------------
+LayerStoreChurnScenario::LayerStoreChurnScenario(size_t spriteCount, size_t layerCount, size_t churnPerFrame):
+	SpriteCount(spriteCount),
+	LayerCount(layerCount),
+	ChurnPerFrame(churnPerFrame)
+{
+}
+
+std::wstring LayerStoreChurnScenario::GetName() const
+{
+	return std::format(L"LayerStore{}-Layers{}-Churn{}", SpriteCount, LayerCount, ChurnPerFrame);
+}
+
+void LayerStoreChurnScenario::Populate(DivergenceEngine::Window* window)
+{
+	window->SetRenderMode(DivergenceEngine::Window::RenderModeClass::Immediate);
+	window->SetCommandRecording(DivergenceEngine::Window::CommandRecordingClass::Off);
+
+	Handles.clear();
+	Handles.reserve(SpriteCount);
+	for (size_t spriteIndex = 0; spriteIndex < SpriteCount; spriteIndex++)
+	{
+		Handles.push_back(window->AddDrawableComponent(CreateGridSprite(window, spriteIndex), spriteIndex % LayerCount));
+	}
+	ChurnCursor = 0;
+}
+
+void LayerStoreChurnScenario::Step(DivergenceEngine::Window* window, uint64_t frameIndex)
+{
+	//The oldest sprites are replaced by new ones, which leaves tombstones in the layers to be compacted
+	for (size_t churnIndex = 0; churnIndex < ChurnPerFrame; churnIndex++)
+	{
+		size_t spriteIndex = ChurnCursor;
+		ChurnCursor = (ChurnCursor + 1) % SpriteCount;
+
+		window->RemoveDrawableComponent(Handles[spriteIndex]);
+		Handles[spriteIndex] = window->AddDrawableComponent(CreateGridSprite(window, spriteIndex), (spriteIndex + frameIndex) % LayerCount);
+	}
+
+	//The sprites do not take input, but every one under the mouse is still hit tested through the grid
+	PostMouseSweep(window, frameIndex, MOUSE_EVENTS_PER_SECOND);
+}
+
+//RenderPipelineScenario--------------------------------------------------------------------------
+RenderPipelineScenario::RenderPipelineScenario(DivergenceEngine::Window::RenderPipelineClass renderPipeline, size_t spriteCount, size_t churnPerFrame):
+	RenderPipeline(renderPipeline),
+	SpriteCount(spriteCount),
+	ChurnPerFrame(churnPerFrame)
+{
+}
+
+std::wstring RenderPipelineScenario::GetName() const
+{
+	const wchar_t* renderPipelineName = RenderPipeline == DivergenceEngine::Window::RenderPipelineClass::Pipelined ? L"Pipelined" : L"Serial";
+	return std::format(L"Pipeline{}-Sprites{}-Churn{}", renderPipelineName, SpriteCount, ChurnPerFrame);
+}
+
+void RenderPipelineScenario::Populate(DivergenceEngine::Window* window)
+{
+	window->SetRenderMode(DivergenceEngine::Window::RenderModeClass::Immediate);
+	window->SetCommandRecording(DivergenceEngine::Window::CommandRecordingClass::Off);
+	window->SetRenderPipeline(RenderPipeline);
+
+	Handles.clear();
+	Handles.reserve(SpriteCount);
+	for (size_t spriteIndex = 0; spriteIndex < SpriteCount; spriteIndex++)
+	{
+		Handles.push_back(window->AddDrawableComponent(CreateGridSprite(window, spriteIndex), 0));
+	}
+	ChurnCursor = 0;
+}
+
+void RenderPipelineScenario::Step(DivergenceEngine::Window* window, uint64_t frameIndex)
+{
+	//While pipelined, the removed sprites are kept alive until the render thread is done with the snapshot that drew them
+	for (size_t churnIndex = 0; churnIndex < ChurnPerFrame; churnIndex++)
+	{
+		size_t spriteIndex = ChurnCursor;
+		ChurnCursor = (ChurnCursor + 1) % SpriteCount;
+
+		window->RemoveDrawableComponent(Handles[spriteIndex]);
+		Handles[spriteIndex] = window->AddDrawableComponent(CreateGridSprite(window, spriteIndex), 0);
+	}
+}
+
+//TextScenario-------------------------------------------------------------------------------------
+TextScenario::TextScenario(size_t textCount, size_t changesPerFrame):
+	TextCount(textCount),
+	ChangesPerFrame(changesPerFrame)
+{
+}
+
+std::wstring TextScenario::GetName() const
+{
+	return std::format(L"Text{}-Changes{}", TextCount, ChangesPerFrame);
+}
+
+void TextScenario::Populate(DivergenceEngine::Window* window)
+{
+	window->SetRenderMode(DivergenceEngine::Window::RenderModeClass::Immediate);
+	window->SetCommandRecording(DivergenceEngine::Window::CommandRecordingClass::Off);
+
+	//Short lines in columns, overlapping once the buffer is full
+	static constexpr float LINE_WIDTH = 160;
+	static constexpr float LINE_HEIGHT = 18;
+	DirectX::XMINT2 bufferSize = window->GraphicsController->GetBufferSize();
+	size_t columns = (std::max)(static_cast<size_t>(1), static_cast<size_t>(bufferSize.x / LINE_WIDTH));
+	size_t rows = (std::max)(static_cast<size_t>(1), static_cast<size_t>(bufferSize.y / LINE_HEIGHT));
+
+	Texts.clear();
+	Texts.reserve(TextCount);
+	for (size_t textIndex = 0; textIndex < TextCount; textIndex++)
+	{
+		DirectX::SimpleMath::Vector2 position(
+			static_cast<float>(textIndex % columns) * LINE_WIDTH,
+			static_cast<float>((textIndex / columns) % rows) * LINE_HEIGHT);
+		std::shared_ptr<PlainText> text = std::make_shared<PlainText>(window->GraphicsController, std::format(L"Line {} of the benchmark", textIndex), TEXT_FONT_PATH, position,
+			PlainText::TextOriginClass::TopLeft, DirectX::Colors::White.v, textIndex % 3 == 0);
+		if (textIndex % 3 == 1)
+		{
+			text->SetOutline(1, DirectX::Colors::Black.v);
+		}
+
+		window->AddDrawableComponent(text, 0);
+		Texts.push_back(text);
+	}
+}
+
+void TextScenario::Step(DivergenceEngine::Window* window, uint64_t frameIndex)
+{
+	for (size_t changeIndex = 0; changeIndex < ChangesPerFrame; changeIndex++)
+	{
+		size_t textIndex = static_cast<size_t>((frameIndex * ChangesPerFrame + changeIndex) % TextCount);
+		Texts[textIndex]->SetTextString(std::format(L"Line {} changed on frame {}", textIndex, frameIndex));
+	}
+}
+
+//DeviceLostScenario------------------------------------------------------------------------------
+DeviceLostScenario::ResourceProbe::ResourceProbe(DeviceLostScenario& scenario, std::weak_ptr<DivergenceEngine::Graphics> graphicsController):
+	Scenario(scenario),
+	WindowGraphicsController(graphicsController)
+{
+	std::shared_ptr<DivergenceEngine::Graphics> graphicsControllerLock = WindowGraphicsController.lock();
+	graphicsControllerLock->LoadTexture(SPRITE_TEXTURE_PATH, ProbeTexture);
+	graphicsControllerLock->LoadFont(TEXT_FONT_PATH, ProbeFont);
+}
+
+void DeviceLostScenario::ResourceProbe::Draw()
+{
+	std::shared_ptr<DivergenceEngine::Graphics> graphicsController = WindowGraphicsController.lock();
+	std::shared_ptr<DirectX::SpriteFont> probeFont = ProbeFont.lock();
+
+	//The first draw after each loss can only come from the window redrawing the layer
+	uint32_t deviceLostCount = graphicsController->GetDeviceLostCount();
+	if (deviceLostCount != Scenario.ProbedDeviceLostCount)
+	{
+		Scenario.ProbedDeviceLostCount = deviceLostCount;
+		Scenario.RedrawsAfterLoss++;
+	}
+
+	//A texture or font left on the old device would not share a device with the rest
+	Microsoft::WRL::ComPtr<ID3D11Device> textureDevice;
+	Microsoft::WRL::ComPtr<ID3D11Device> fontDevice;
+	ProbeTexture->ShaderResourceView->GetDevice(&textureDevice);
+	probeFont->GetSpriteSheet()->GetDevice(&fontDevice);
+	if (textureDevice != fontDevice)
+	{
+		Scenario.MismatchedDraws++;
+	}
+
+	graphicsController->DrawSizedSprite(ProbeTexture->ShaderResourceView.Get(), DirectX::SimpleMath::Vector2(0, 0), DirectX::SimpleMath::Vector2(64, 64), ProbeTexture->TextureAlpha);
+	graphicsController->DrawString(probeFont.get(), L"Device lost probe", DirectX::SimpleMath::Vector2(72, 0), DirectX::SimpleMath::Vector2(0, 0), DirectX::Colors::White.v, true);
+}
+
+DeviceLostScenario::DeviceLostScenario(size_t spriteCount, size_t textCount):
+	SpriteCount(spriteCount),
+	TextCount(textCount)
+{
+}
+
+std::wstring DeviceLostScenario::GetName() const
+{
+	return std::format(L"DeviceLost-Sprites{}-Text{}", SpriteCount, TextCount);
+}
+
+std::wstring DeviceLostScenario::GetDetails() const
+{
+	//Every loss should be recovered from once and redrawn after, with nothing drawn from the old device. A stale outline atlas or
+	//font would be drawn with the wrong device, which loses the device again and shows up as more losses than were injected
+	return std::format(L"injected={} recovered={} redrawn={} mismatched={}", LossesInjected, LossesRecovered, RedrawsAfterLoss, MismatchedDraws);
+}
+
+void DeviceLostScenario::Populate(DivergenceEngine::Window* window)
+{
+	window->SetRenderMode(DivergenceEngine::Window::RenderModeClass::Retained);
+	window->SetCommandRecording(DivergenceEngine::Window::CommandRecordingClass::Off);
+	DeviceLostCountAtStart = window->GraphicsController->GetDeviceLostCount();
+	ProbedDeviceLostCount = DeviceLostCountAtStart;
+	LossesInjected = 0;
+	LossesRecovered = 0;
+	RedrawsAfterLoss = 0;
+	MismatchedDraws = 0;
+
+	for (size_t spriteIndex = 0; spriteIndex < SpriteCount; spriteIndex++)
+	{
+		window->AddDrawableComponent(CreateGridSprite(window, spriteIndex), 0);
+	}
+
+	//Every text either has a drop shadow or an outline, so both kinds of outline atlas have to be baked again
+	DirectX::XMINT2 bufferSize = window->GraphicsController->GetBufferSize();
+	for (size_t textIndex = 0; textIndex < TextCount; textIndex++)
+	{
+		DirectX::SimpleMath::Vector2 position(0, static_cast<float>((textIndex * 18 + 72) % static_cast<size_t>((std::max)(1, bufferSize.y))));
+		std::shared_ptr<PlainText> text = std::make_shared<PlainText>(window->GraphicsController, std::format(L"Line {} survives a lost device", textIndex), TEXT_FONT_PATH, position,
+			PlainText::TextOriginClass::TopLeft, DirectX::Colors::White.v, textIndex % 2 == 0);
+		if (textIndex % 2 == 1)
+		{
+			text->SetOutline(1, DirectX::Colors::Black.v);
+		}
+		window->AddDrawableComponent(text, 1);
+	}
+
+	window->AddDrawableComponent(std::make_shared<ResourceProbe>(*this, window->GraphicsController), 2);
+}
+
+void DeviceLostScenario::Step(DivergenceEngine::Window* window, uint64_t frameIndex)
+{
+	LossesRecovered = window->GraphicsController->GetDeviceLostCount() - DeviceLostCountAtStart;
+
+	//Halfway between losses, so the last one is recovered from before the scenario ends
+	if (frameIndex % FRAMES_BETWEEN_LOSSES == FRAMES_BETWEEN_LOSSES / 2)
+	{
+		window->GraphicsController->SimulateDeviceRemoved();
+		LossesInjected++;
+	}
+}
+
+//Scenario list------------------------------------------------------------------------------------
+std::vector<std::unique_ptr<BenchmarkScenario>> CreateBenchmarkScenarios()
+{
+	std::vector<std::unique_ptr<BenchmarkScenario>> scenarios;
+
+	//The same 100k sprites drawn straight into the sprite batch, then recorded on the render thread, then recorded on workers
+	scenarios.push_back(std::make_unique<SpriteScenario>(DivergenceEngine::Window::CommandRecordingClass::Off, 100000));
+	scenarios.push_back(std::make_unique<SpriteScenario>(DivergenceEngine::Window::CommandRecordingClass::Serial, 100000));
+	scenarios.push_back(std::make_unique<SpriteScenario>(DivergenceEngine::Window::CommandRecordingClass::Parallel, 100000));
+
+	//Hit testing 10k buttons, which only finds the buttons in the cell under the mouse
+	scenarios.push_back(std::make_unique<ButtonHitTestScenario>(10000));
+
+	//Drawing and hit testing 100k sprites spread over layers, with 1% of them removed and added again every frame
+	scenarios.push_back(std::make_unique<LayerStoreChurnScenario>(100000, 4, 1000));
+
+	//The same 50k sprites, with 1% of them replaced every frame, drawn serially and then recorded while the render thread presents
+	scenarios.push_back(std::make_unique<RenderPipelineScenario>(DivergenceEngine::Window::RenderPipelineClass::Serial, 50000, 500));
+	scenarios.push_back(std::make_unique<RenderPipelineScenario>(DivergenceEngine::Window::RenderPipelineClass::Pipelined, 50000, 500));
+
+	//Losing the device every second while retained layers of sprites and text are on screen
+	scenarios.push_back(std::make_unique<DeviceLostScenario>(1000, 20));
+
+	//2k lines of text, with 1% of them changed every frame
+	scenarios.push_back(std::make_unique<TextScenario>(2000, 20));
+
+	return scenarios;
+}
\ No newline at end of file
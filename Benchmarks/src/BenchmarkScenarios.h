@@ -0,0 +1,211 @@
+#pragma once
+#include "DivergenceEngine.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+//One workload for the benchmark page to measure. It fills an empty window when it starts, and may change it on every update after
+class BenchmarkScenario
+{
+public:
+	virtual ~BenchmarkScenario() {};
+
+	virtual std::wstring GetName() const = 0;
+
+	//Anything the scenario counted itself, added to the end of its results
+	virtual std::wstring GetDetails() const { return L""; }
+
+	/// <summary>
+	/// Sets up the window the way the scenario is measured, such as its render mode and command recording, then adds its drawables.
+	/// </summary>
+	/// <param name="window">The window, with every layer cleared and drawn serially</param>
+	virtual void Populate(DivergenceEngine::Window* window) = 0;
+
+	/// <summary>
+	/// Called on every update, before the frame is drawn.
+	/// </summary>
+	/// <param name="window">The window the scenario populated</param>
+	/// <param name="frameIndex">How many frames the scenario has run, counting the warmup</param>
+	virtual void Step(DivergenceEngine::Window* window, uint64_t frameIndex) {}
+};
+
+//Small sprites that are all drawn every frame, recorded in the given way
+class SpriteScenario : public BenchmarkScenario
+{
+private:
+	//Datafields
+	DivergenceEngine::Window::CommandRecordingClass CommandRecording;
+	size_t SpriteCount;
+
+public:
+	SpriteScenario(DivergenceEngine::Window::CommandRecordingClass commandRecording, size_t spriteCount);
+
+	//Overridden functions
+	std::wstring GetName() const override;
+	void Populate(DivergenceEngine::Window* window) override;
+};
+
+//A grid of buttons with the mouse swept over them at 1 kHz, with a click on every frame, as posted window messages
+class ButtonHitTestScenario : public BenchmarkScenario
+{
+private:
+	//A button that only counts what happens to it, and lights up while hovered
+	class CountingButton : public DivergenceEngine::IDrawable
+	{
+	private:
+		//Datafields
+		ButtonHitTestScenario& Scenario;
+		std::weak_ptr<DivergenceEngine::Graphics> WindowGraphicsController;
+		std::shared_ptr<DivergenceEngine::Texture> ButtonTexture;
+		DirectX::SimpleMath::Rectangle Bounds;
+		bool IsHovered = false;
+
+	public:
+		CountingButton(ButtonHitTestScenario& scenario, std::weak_ptr<DivergenceEngine::Graphics> graphicsController, DirectX::SimpleMath::Rectangle bounds);
+
+		//Overridden functions
+		void Draw() override;
+		bool IsCoordInObject(DirectX::XMINT2 mousePos) override;
+		std::optional<DirectX::SimpleMath::Rectangle> GetBounds() override { return Bounds; }
+		void OnMouseEnter(DirectX::XMINT2 mousePos) override;
+		void OnMouseMove(DirectX::XMINT2 mousePos) override {}
+		void OnMouseLeave() override;
+		bool OnLeftPress(DirectX::XMINT2 mousePos) override;
+		bool OnLeftRelease(DirectX::XMINT2 mousePos) override { return false; }
+		bool OnMiddlePress(DirectX::XMINT2 mousePos) override { return false; }
+		bool OnMiddleRelease(DirectX::XMINT2 mousePos) override { return false; }
+		bool OnRightPress(DirectX::XMINT2 mousePos) override { return false; }
+		bool OnRightRelease(DirectX::XMINT2 mousePos) override { return false; }
+	};
+
+	//Constants
+	static constexpr uint32_t MOUSE_EVENTS_PER_SECOND = 1000;
+
+	//Datafields
+	size_t ButtonCount;
+	uint64_t Enters = 0;
+	uint64_t Leaves = 0;
+	uint64_t Presses = 0;
+
+public:
+	ButtonHitTestScenario(size_t buttonCount);
+
+	//Overridden functions
+	std::wstring GetName() const override;
+	std::wstring GetDetails() const override;
+	void Populate(DivergenceEngine::Window* window) override;
+	void Step(DivergenceEngine::Window* window, uint64_t frameIndex) override;
+};
+
+//Sprites spread over several layers, with some of them removed and replaced every frame, and the mouse swept over them
+class LayerStoreChurnScenario : public BenchmarkScenario
+{
+private:
+	//Constants
+	static constexpr uint32_t MOUSE_EVENTS_PER_SECOND = 1000;
+
+	//Datafields
+	size_t SpriteCount;
+	size_t LayerCount;
+	size_t ChurnPerFrame;
+	std::vector<DivergenceEngine::DrawableHandle> Handles;
+	size_t ChurnCursor = 0;
+
+public:
+	LayerStoreChurnScenario(size_t spriteCount, size_t layerCount, size_t churnPerFrame);
+
+	//Overridden functions
+	std::wstring GetName() const override;
+	void Populate(DivergenceEngine::Window* window) override;
+	void Step(DivergenceEngine::Window* window, uint64_t frameIndex) override;
+};
+
+//Sprites that are all drawn every frame, with some of them replaced every frame. Presented on the main thread, or on a render thread while
+//the next frame is recorded
+class RenderPipelineScenario : public BenchmarkScenario
+{
+private:
+	//Datafields
+	DivergenceEngine::Window::RenderPipelineClass RenderPipeline;
+	size_t SpriteCount;
+	size_t ChurnPerFrame;
+	std::vector<DivergenceEngine::DrawableHandle> Handles;
+	size_t ChurnCursor = 0;
+
+public:
+	RenderPipelineScenario(DivergenceEngine::Window::RenderPipelineClass renderPipeline, size_t spriteCount, size_t churnPerFrame);
+
+	//Overridden functions
+	std::wstring GetName() const override;
+	void Populate(DivergenceEngine::Window* window) override;
+	void Step(DivergenceEngine::Window* window, uint64_t frameIndex) override;
+};
+
+//Lines of text all drawn every frame, a third of them with drop shadows and a third outlined. A few change every frame,
+//so their layout is built again while the rest come from the cache
+class TextScenario : public BenchmarkScenario
+{
+private:
+	//Datafields
+	size_t TextCount;
+	size_t ChangesPerFrame;
+	std::vector<std::shared_ptr<DivergenceEngine::Templates::PlainText>> Texts;
+
+public:
+	TextScenario(size_t textCount, size_t changesPerFrame);
+
+	//Overridden functions
+	std::wstring GetName() const override;
+	void Populate(DivergenceEngine::Window* window) override;
+	void Step(DivergenceEngine::Window* window, uint64_t frameIndex) override;
+};
+
+//Sprites, text with drop shadows and outlined text in retained layers, with the device lost every second. Counts whether each loss
+//was recovered from, whether the retained layers were drawn again after it, and whether anything was drawn from the old device
+class DeviceLostScenario : public BenchmarkScenario
+{
+private:
+	//Draws a texture and a string with a drop shadow, checking both were made again on the same device. It is never marked dirty,
+	//so in retained mode it is only drawn again when the window redraws its layer by itself
+	class ResourceProbe : public DivergenceEngine::UnclickableDrawable
+	{
+	private:
+		//Datafields
+		DeviceLostScenario& Scenario;
+		std::weak_ptr<DivergenceEngine::Graphics> WindowGraphicsController;
+		std::shared_ptr<DivergenceEngine::Texture> ProbeTexture;
+		std::weak_ptr<DirectX::SpriteFont> ProbeFont;
+
+	public:
+		ResourceProbe(DeviceLostScenario& scenario, std::weak_ptr<DivergenceEngine::Graphics> graphicsController);
+
+		//Overridden functions
+		void Draw() override;
+		bool IsCoordInObject(DirectX::XMINT2 mousePos) override { return false; }
+	};
+
+	//Constants
+	static constexpr uint64_t FRAMES_BETWEEN_LOSSES = 60;
+
+	//Datafields
+	size_t SpriteCount;
+	size_t TextCount;
+	uint32_t DeviceLostCountAtStart = 0;
+	uint32_t LossesInjected = 0;
+	uint32_t LossesRecovered = 0;
+	uint32_t ProbedDeviceLostCount = 0;
+	uint32_t RedrawsAfterLoss = 0;
+	uint64_t MismatchedDraws = 0;
+
+public:
+	DeviceLostScenario(size_t spriteCount, size_t textCount);
+
+	//Overridden functions
+	std::wstring GetName() const override;
+	std::wstring GetDetails() const override;
+	void Populate(DivergenceEngine::Window* window) override;
+	void Step(DivergenceEngine::Window* window, uint64_t frameIndex) override;
+};
+
+//Every scenario, in the order they are run
+std::vector<std::unique_ptr<BenchmarkScenario>> CreateBenchmarkScenarios();
\ No newline at end of file
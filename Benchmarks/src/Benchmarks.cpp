@@ -0,0 +1,58 @@
+#include "Benchmarks.h"
+#include "BenchmarkPage.h"
+#include <algorithm>
+#include <format>
+#include <sstream>
+
+//The frame rate is fixed instead of taken from the display, so every machine steps through the same frames
+static constexpr uint32_t BENCHMARK_FRAME_RATE = 60;
+static constexpr uint32_t MAX_BENCHMARK_WINDOWS = 4;
+
+//Sends the Application object to the Engine
+DivergenceEngine::Application* DivergenceEngine::CreateApplication(LPWSTR lpCmdLine)
+{
+	return new Benchmarks(lpCmdLine, BENCHMARK_FRAME_RATE);
+}
+
+//Class functions----------------------------------------------------------------------------------
+Benchmarks::Benchmarks(LPWSTR lpCmdLine, uint32_t frameRate)
+	:Application(frameRate, lpCmdLine)
+{
+	DivergenceEngine::Logger::Log(L"Benchmarks Constructed");
+}
+
+Benchmarks::~Benchmarks()
+{
+	DivergenceEngine::Logger::Log(L"Benchmarks Destructed");
+}
+
+void Benchmarks::Initialize()
+{
+	//Time only moves when the benchmark page steps it by one frame, so every run updates and draws exactly the same frames, as fast as the machine can
+	BenchmarkClock = std::make_shared<DX::ManualClock>();
+	SetClock(BenchmarkClock);
+
+	//The command line is "[window count] [perwindow]", for one to four windows that run the scenarios side by side, drawn on the main thread or
+	//each on their own render thread
+	std::wistringstream commandLineStream(CommandLineArgs);
+	uint32_t windowCount = 1;
+	std::wstring windowThreading;
+	commandLineStream >> windowCount >> windowThreading;
+	windowCount = std::clamp(windowCount, 1u, MAX_BENCHMARK_WINDOWS);
+	if (windowThreading == L"perwindow")
+	{
+		SetWindowThreading(DivergenceEngine::WindowThreadingClass::RenderThreadPerWindow);
+	}
+
+	//Only the first window steps the clock, so every window draws once per frame
+	for (uint32_t windowIndex = 0; windowIndex < windowCount; windowIndex++)
+	{
+		AddWindow(std::make_unique<DivergenceEngine::Window>(800, 450, std::format(L"Divergence Engine Benchmarks {}", windowIndex + 1).c_str(),
+			std::make_unique<BenchmarkPage>(windowIndex == 0 ? BenchmarkClock : nullptr, windowCount)));
+	}
+
+	//The first frame is due straight away. The page steps to every frame after it
+	BenchmarkClock->Advance(DX::ManualClock::TicksPerSecond / GetFrameRate());
+
+	DivergenceEngine::Logger::Log(L"Benchmarks Initialized");
+}
\ No newline at end of file
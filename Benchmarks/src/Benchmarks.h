@@ -0,0 +1,16 @@
+#pragma once
+#include <DivergenceEngine.h>
+#include "Application/EntryPoint.h"
+
+class Benchmarks : public DivergenceEngine::Application
+{
+private:
+	//Datafields
+	std::shared_ptr<DX::ManualClock> BenchmarkClock;
+
+public:
+	Benchmarks(LPWSTR lpCmdLine, uint32_t frameRate);
+	~Benchmarks() override;
+
+	void Initialize() override;
+};
\ No newline at end of file
@@ -81,6 +81,9 @@ void MainMenuPage::Initialize(DivergenceEngine::Window* windowReference)
 	std::shared_ptr<ButtonMenu> mainMenu = std::make_shared<ButtonMenu>(buttonDescriptions);
 	WindowReference->AddDrawableComponent(mainMenu, 2);
 
+	//The menu only changes when a button is hovered, so there is no need to draw it every frame
+	WindowReference->SetRenderMode(DivergenceEngine::Window::RenderModeClass::Retained);
+
 	DivergenceEngine::Logger::Log(L"MainMenuPage Constructed");
 }
 
@@ -1,5 +1,7 @@
 #include "Application.h"
 #include "Logger/Logger.h"
+#include "Profiler/Profiler.h"
+#include <algorithm>
 
 namespace DivergenceEngine
 {
@@ -42,6 +44,7 @@ namespace DivergenceEngine
 		//By default, set the timer to 60 fps
 		Timer.SetFixedTimeStep(true);
 		Timer.SetTargetElapsedSeconds(1.0 / (double)FrameRate);
+		ApplyCatchUpCap();
 		
 		DivergenceEngine::Logger::Log(L"Application Constructed");
 	}
@@ -57,8 +60,189 @@ namespace DivergenceEngine
 		return FrameRate;
 	}
 
+	FramePacingClass Application::GetFramePacing()
+	{
+		return FramePacing;
+	}
+
+	FramePacingStatistics Application::GetFramePacingStatistics()
+	{
+		//Only the waitable timer pacing has anything to report
+		return Pacer ? Pacer->GetStatistics() : FramePacingStatistics();
+	}
+
+	void Application::SetFramePacing(FramePacingClass framePacing)
+	{
+		//The swap chains or the pacer decide when a frame starts, so the timer only measures elapsed time instead of waiting for a fixed step
+		FramePacing = framePacing;
+		Timer.SetFixedTimeStep(FramePacing == FramePacingClass::FixedTimeStep);
+		Timer.ResetElapsedTime();
+
+		if (FramePacing == FramePacingClass::WaitableTimer)
+		{
+			Pacer = std::make_unique<FramePacer>(1.0 / (double)FrameRate);
+		}
+		else
+		{
+			Pacer = nullptr;
+		}
+	}
+
+	void Application::ResetFramePacingStatistics()
+	{
+		if (Pacer)
+		{
+			Pacer->ResetStatistics();
+		}
+	}
+
+	WindowThreadingClass Application::GetWindowThreading()
+	{
+		return WindowThreading;
+	}
+
+	//Each window already has its own device and context, so giving each a render thread lets their presents wait on their
+	//displays at the same time. Messages are still pumped, and pages still updated, on the main thread
+	void Application::SetWindowThreading(WindowThreadingClass windowThreading)
+	{
+		WindowThreading = windowThreading;
+		for (std::unique_ptr<Window>& window : ListOfApplicationWindows)
+		{
+			window->SetRenderPipeline(WindowThreading == WindowThreadingClass::RenderThreadPerWindow ? Window::RenderPipelineClass::Pipelined : Window::RenderPipelineClass::Serial);
+		}
+	}
+
+	SimulationClass Application::GetSimulation()
+	{
+		return Simulation;
+	}
+
+	const SimulationStatistics& Application::GetSimulationStatistics()
+	{
+		return SimulationStats;
+	}
+
+	void Application::SetSimulation(SimulationClass simulation, uint32_t updateRate)
+	{
+		//The update rate only matters to the fixed interpolated simulation. If it is 0, the pages update at the frame rate
+		if (updateRate == 0)
+		{
+			updateRate = FrameRate;
+		}
+
+		Simulation = simulation;
+		SimulationTimer.SetFixedTimeStep(Simulation == SimulationClass::FixedInterpolated);
+		SimulationTimer.SetTargetElapsedSeconds(1.0 / (double)updateRate);
+		SimulationTimer.ResetElapsedTime();
+		Timer.ResetElapsedTime();
+		ApplyCatchUpCap();
+
+		//Only the fixed interpolated simulation sets this each frame, so the other modes would keep whatever it was left at
+		if (Simulation != SimulationClass::FixedInterpolated)
+		{
+			IDrawable::InterpolationAlpha = 1.0f;
+		}
+	}
+
+	void Application::SetMaxCatchUpUpdates(uint32_t maxCatchUpUpdates)
+	{
+		//0 lets a frame catch up on every update it is behind on
+		MaxCatchUpUpdates = maxCatchUpUpdates;
+		ApplyCatchUpCap();
+	}
+
+	void Application::ResetSimulationStatistics()
+	{
+		SimulationStats = SimulationStatistics();
+	}
+
+	//A manual clock lets the application be stepped deterministically, at any number of frames per second
+	void Application::SetClock(std::shared_ptr<DX::IClock> clock)
+	{
+		Timer.SetClock(clock);
+		SimulationTimer.SetClock(clock);
+	}
+
+	void Application::ApplyCatchUpCap()
+	{
+		//Outside the locked simulation, the frame timer only decides when a frame is drawn. It should never draw a burst of frames to catch up
+		if (Simulation == SimulationClass::LockedToFrameRate)
+		{
+			Timer.SetMaxUpdatesPerTick(MaxCatchUpUpdates);
+		}
+		else
+		{
+			Timer.SetMaxUpdatesPerTick(1);
+		}
+
+		SimulationTimer.SetMaxUpdatesPerTick(MaxCatchUpUpdates);
+	}
+
+	void Application::RecordSimulationStep(const DX::StepTimer& timer)
+	{
+		uint32_t updates = timer.GetUpdatesLastTick();
+		SimulationStats.Updates += updates;
+		SimulationStats.DroppedUpdates += timer.GetDroppedUpdatesLastTick();
+		SimulationStats.MostUpdatesInAFrame = (std::max)(SimulationStats.MostUpdatesInAFrame, updates);
+		if (updates > 1)
+		{
+			SimulationStats.Hitches++;
+		}
+	}
+
+	void Application::UpdateThenDrawAllWindows()
+	{
+		for (std::unique_ptr<Window>& window : ListOfApplicationWindows)
+		{
+			window->BeginFrame();
+		}
+
+		//The pages may update any number of times, including none, before the windows draw once
+		SimulationTimer.Tick([&]()
+			{
+				for (std::unique_ptr<Window>& window : ListOfApplicationWindows)
+				{
+					window->UpdateWindow(SimulationTimer);
+				}
+			});
+
+		SimulationStats.Frames++;
+		RecordSimulationStep(SimulationTimer);
+
+		IDrawable::InterpolationAlpha = static_cast<float>(SimulationTimer.GetStepProgress());
+		for (std::unique_ptr<Window>& window : ListOfApplicationWindows)
+		{
+			window->DrawFrame();
+		}
+		WaitOutSkippedFrame();
+		Profiler::EndFrame();
+	}
+
+	//A window with nothing new to present skips its frame. Windows that do present are paced by their swap chains, so the
+	//frame is only waited out here when every window skipped it, and then only once
+	void Application::WaitOutSkippedFrame()
+	{
+		if (ListOfApplicationWindows.empty())
+		{
+			return;
+		}
+
+		for (std::unique_ptr<Window>& window : ListOfApplicationWindows)
+		{
+			if (!window->WasLastFrameSkipped())
+			{
+				return;
+			}
+		}
+		ListOfApplicationWindows.front()->GraphicsController->WaitForVerticalBlank();
+	}
+
 	void Application::AddWindow(std::unique_ptr<Window>&& window)
 	{
+		if (WindowThreading == WindowThreadingClass::RenderThreadPerWindow)
+		{
+			window->SetRenderPipeline(Window::RenderPipelineClass::Pipelined);
+		}
 		ListOfApplicationWindows.push_back(std::move(window));
 	}
 
@@ -81,6 +265,19 @@ namespace DivergenceEngine
 
 	void Application::UpdateAndDrawAllWindows()
 	{
+		//Sleep until the next frame is due. If a message comes in first, go back to the message loop to handle it
+		if (Pacer && !Pacer->WaitForNextFrame())
+		{
+			return;
+		}
+
+		//The frame timer decides when the windows are drawn. Pages updated apart from it are ticked by the simulation timer
+		if (Simulation != SimulationClass::LockedToFrameRate)
+		{
+			Timer.Tick([]() { UpdateThenDrawAllWindows(); });
+			return;
+		}
+
 		//Ensure the update and draw only happens at the target frame rate
 		Timer.Tick([&]()
 			{
@@ -89,6 +286,14 @@ namespace DivergenceEngine
 				{
 					window->UpdateAndDraw(Timer);
 				}
+				WaitOutSkippedFrame();
+				Profiler::EndFrame();
 			});
+
+		if (Timer.GetUpdatesLastTick() != 0)
+		{
+			SimulationStats.Frames += Timer.GetUpdatesLastTick();
+			RecordSimulationStep(Timer);
+		}
 	}
 }
\ No newline at end of file
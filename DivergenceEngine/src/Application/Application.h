@@ -5,17 +5,63 @@
 #include <memory>
 #include "Window/Window.h"
 #include "StepTimer.h"
+#include "FramePacer.h"
 #include "Window/IPage.h"
 
 
 namespace DivergenceEngine
 {
+	//How the application decides when to start the next frame
+	enum class FramePacingClass
+	{
+		FixedTimeStep, //The step timer polls the clock until a frame is due
+		SwapChainWaitable, //Each window sleeps until its swap chain can queue another frame, so input is read as late as possible
+		WaitableTimer //The main thread sleeps on a high resolution timer until a frame is due, waking early to handle messages
+	};
+
+	//Which thread each window draws and presents on
+	enum class WindowThreadingClass
+	{
+		Shared, //Every window is updated, drawn and presented in turn on the main thread
+		RenderThreadPerWindow //Every window presents from its own render thread, so a window waiting on its display does not hold up the others
+	};
+
+	//How often pages are updated compared to how often windows are drawn
+	enum class SimulationClass
+	{
+		LockedToFrameRate, //Pages update once per frame with a step of one frame. A late frame is caught up with several updates and draws in a row
+		Variable, //Pages update once per frame with however much time actually passed
+		FixedInterpolated //Pages update at their own fixed rate, apart from the frame rate. Drawables are given how far each frame is between two updates
+	};
+
+	struct SimulationStatistics
+	{
+		uint64_t Frames = 0;
+		uint64_t Updates = 0;
+		uint64_t Hitches = 0; //Frames that needed more than one update to catch up
+		uint64_t DroppedUpdates = 0; //Updates skipped because a frame reached the catch-up cap
+		uint32_t MostUpdatesInAFrame = 0;
+	};
+
 	class Application
 	{
 	private:
 		inline static std::vector<std::unique_ptr<Window>> ListOfApplicationWindows;
 		inline static DX::StepTimer Timer;
 		inline static uint32_t FrameRate;
+		inline static FramePacingClass FramePacing = FramePacingClass::FixedTimeStep;
+		inline static std::unique_ptr<FramePacer> Pacer;
+		inline static WindowThreadingClass WindowThreading = WindowThreadingClass::Shared;
+		inline static SimulationClass Simulation = SimulationClass::LockedToFrameRate;
+		inline static DX::StepTimer SimulationTimer;
+		inline static uint32_t MaxCatchUpUpdates = 4;
+		inline static SimulationStatistics SimulationStats;
+
+		//Helpers
+		static void ApplyCatchUpCap();
+		static void RecordSimulationStep(const DX::StepTimer& timer);
+		static void UpdateThenDrawAllWindows();
+		static void WaitOutSkippedFrame();
 		
 	protected:
 		HINSTANCE ProcessInstance = nullptr;
@@ -28,6 +74,20 @@ namespace DivergenceEngine
 
 		//Getters
 		static uint32_t GetFrameRate();
+		static FramePacingClass GetFramePacing();
+		static FramePacingStatistics GetFramePacingStatistics();
+		static WindowThreadingClass GetWindowThreading();
+		static SimulationClass GetSimulation();
+		static const SimulationStatistics& GetSimulationStatistics();
+
+		//Setters
+		static void SetFramePacing(FramePacingClass framePacing);
+		static void ResetFramePacingStatistics();
+		static void SetWindowThreading(WindowThreadingClass windowThreading);
+		static void SetSimulation(SimulationClass simulation, uint32_t updateRate = 0);
+		static void SetMaxCatchUpUpdates(uint32_t maxCatchUpUpdates);
+		static void ResetSimulationStatistics();
+		static void SetClock(std::shared_ptr<DX::IClock> clock);
 
 		//Initialization functions
 		virtual void Initialize() = 0;
@@ -0,0 +1,105 @@
+//
+// Clock.h - Sources of time that a StepTimer can be driven by
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+
+namespace DX
+{
+    // A monotonic source of time. Ticks are in the clock's own unit, GetFrequency of them per second.
+    class IClock
+    {
+    public:
+        virtual ~IClock() = default;
+
+        virtual uint64_t GetFrequency() const = 0;
+        virtual uint64_t GetTicks() const = 0;
+    };
+
+    // Portable clock backed by std::chrono::steady_clock.
+    class SteadyClock : public IClock
+    {
+    public:
+        uint64_t GetFrequency() const noexcept override
+        {
+            return static_cast<uint64_t>(std::chrono::steady_clock::period::den / std::chrono::steady_clock::period::num);
+        }
+
+        uint64_t GetTicks() const noexcept override
+        {
+            return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        }
+    };
+
+#ifdef _WIN32
+    // Clock backed by QueryPerformanceCounter, the most precise clock on Windows.
+    class QueryPerformanceClock : public IClock
+    {
+    public:
+        QueryPerformanceClock() noexcept(false)
+        {
+            LARGE_INTEGER frequency;
+            if (!QueryPerformanceFrequency(&frequency))
+            {
+                throw std::runtime_error("QueryPerformanceClock::QueryPerformanceClock() - QueryPerformanceFrequency failed");
+            }
+
+            m_frequency = static_cast<uint64_t>(frequency.QuadPart);
+        }
+
+        uint64_t GetFrequency() const noexcept override { return m_frequency; }
+
+        uint64_t GetTicks() const override
+        {
+            LARGE_INTEGER currentTime;
+            if (!QueryPerformanceCounter(&currentTime))
+            {
+                throw std::runtime_error("QueryPerformanceClock::GetTicks() - QueryPerformanceCounter failed");
+            }
+
+            return static_cast<uint64_t>(currentTime.QuadPart);
+        }
+
+    private:
+        uint64_t m_frequency;
+    };
+#endif
+
+    // Clock that only moves when it is advanced. Timing driven by it is deterministic, can be replayed exactly,
+    // and can run any number of frames per second regardless of how long they actually take.
+    class ManualClock : public IClock
+    {
+    public:
+        // Ticks are 100 nanoseconds, the same as the canonical StepTimer tick.
+        static constexpr uint64_t TicksPerSecond = 10000000;
+
+        uint64_t GetFrequency() const noexcept override { return TicksPerSecond; }
+        uint64_t GetTicks() const noexcept override { return m_ticks; }
+
+        void Advance(uint64_t ticks) noexcept { m_ticks += ticks; }
+        void AdvanceSeconds(double seconds) noexcept { m_ticks += static_cast<uint64_t>(seconds * TicksPerSecond); }
+
+    private:
+        uint64_t m_ticks = 0;
+    };
+
+    // The clock a StepTimer uses unless it is given another.
+    inline std::shared_ptr<IClock> CreateDefaultClock()
+    {
+#ifdef _WIN32
+        return std::make_shared<QueryPerformanceClock>();
+#else
+        return std::make_shared<SteadyClock>();
+#endif
+    }
+}
\ No newline at end of file
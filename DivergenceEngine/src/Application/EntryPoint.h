@@ -26,6 +26,8 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 	returnCode = ReleaseEntryPoint(hInstance, hPrevInstance, lpCmdLine, nCmdShow);
 #endif
 
+	//Write out everything still queued before the process goes away
+	DivergenceEngine::Logger::Shutdown();
 	return returnCode;
 }
 
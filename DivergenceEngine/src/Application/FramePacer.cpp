@@ -0,0 +1,177 @@
+#include "FramePacer.h"
+#include <timeapi.h>
+#include <cmath>
+#include <stdexcept>
+
+#pragma comment(lib, "winmm.lib")
+
+namespace DivergenceEngine
+{
+	FramePacer::FramePacer(double targetFrameSeconds)
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		CounterFrequency = frequency.QuadPart;
+
+		//High resolution timers wake within about half a millisecond. Older versions of Windows do not have them, and the
+		//regular timer is only as precise as the system timer, so that is raised to 1 ms for as long as the pacer exists
+		WaitableTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+		IsTimerHighResolution = WaitableTimer != nullptr;
+		if (!IsTimerHighResolution)
+		{
+			WaitableTimer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+			if (WaitableTimer == nullptr)
+			{
+				throw std::runtime_error("FramePacer::FramePacer() - could not create a waitable timer");
+			}
+			timeBeginPeriod(1);
+		}
+		Statistics.IsTimerHighResolution = IsTimerHighResolution;
+
+		SpinTicks = static_cast<int64_t>((IsTimerHighResolution ? HIGH_RESOLUTION_SPIN_SECONDS : LOW_RESOLUTION_SPIN_SECONDS) * CounterFrequency);
+		SetTargetFrameSeconds(targetFrameSeconds);
+	}
+
+	FramePacer::~FramePacer()
+	{
+		if (!IsTimerHighResolution)
+		{
+			timeEndPeriod(1);
+		}
+		CloseHandle(WaitableTimer);
+	}
+
+	bool FramePacer::WaitForNextFrame()
+	{
+		int64_t currentTicks = QueryCounter();
+
+		//After a stall of more than a frame, start pacing again from now instead of rushing out the missed frames
+		if (NextFrameTicks == 0 || currentTicks - NextFrameTicks > FramePeriodTicks)
+		{
+			NextFrameTicks = currentTicks;
+		}
+
+		//Sleep until just before the frame is due, unless a message comes in first
+		int64_t wakeTicks = NextFrameTicks - SpinTicks;
+		if (currentTicks < wakeTicks)
+		{
+			//A negative due time is relative, in 100 nanosecond units
+			LARGE_INTEGER dueTime;
+			dueTime.QuadPart = -((wakeTicks - currentTicks) * 10'000'000 / CounterFrequency);
+			if (!SetWaitableTimerEx(WaitableTimer, &dueTime, 0, nullptr, nullptr, nullptr, 0))
+			{
+				throw std::runtime_error("FramePacer::WaitForNextFrame() - could not set the waitable timer");
+			}
+
+			DWORD waitResult = MsgWaitForMultipleObjectsEx(1, &WaitableTimer, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+			if (waitResult == WAIT_OBJECT_0 + 1)
+			{
+				CancelWaitableTimer(WaitableTimer);
+				Statistics.WakeupsForInput++;
+				return false;
+			}
+			if (waitResult == WAIT_FAILED)
+			{
+				throw std::runtime_error("FramePacer::WaitForNextFrame() - could not wait on the waitable timer");
+			}
+		}
+
+		//Spin out the rest, which is too short for the timer to hit precisely
+		int64_t spinStartTicks = QueryCounter();
+		while ((currentTicks = QueryCounter()) < NextFrameTicks)
+		{
+			YieldProcessor();
+		}
+
+		RecordFrame(currentTicks, currentTicks - spinStartTicks);
+		NextFrameTicks += FramePeriodTicks;
+		return true;
+	}
+
+	//Setters--------------------------------------------------------------------------------------
+	void FramePacer::SetTargetFrameSeconds(double targetFrameSeconds) noexcept
+	{
+		FramePeriodTicks = static_cast<int64_t>(targetFrameSeconds * CounterFrequency);
+	}
+
+	//Statistics-----------------------------------------------------------------------------------
+	const FramePacingStatistics& FramePacer::GetStatistics() const noexcept
+	{
+		return Statistics;
+	}
+
+	void FramePacer::ResetStatistics() noexcept
+	{
+		Statistics = FramePacingStatistics();
+		Statistics.IsTimerHighResolution = IsTimerHighResolution;
+		TotalFrameIntervalMilliseconds = 0;
+		TotalJitterMilliseconds = 0;
+		TotalSpinMilliseconds = 0;
+		LastFrameTicks = 0;
+	}
+
+	//Helpers--------------------------------------------------------------------------------------
+	int64_t FramePacer::QueryCounter() const noexcept
+	{
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		return counter.QuadPart;
+	}
+
+	void FramePacer::RecordFrame(int64_t frameTicks, int64_t spinTicks) noexcept
+	{
+		double ticksToMilliseconds = 1000.0 / static_cast<double>(CounterFrequency);
+		TotalSpinMilliseconds += spinTicks * ticksToMilliseconds;
+		Statistics.FramesPaced++;
+		Statistics.AverageSpinMilliseconds = TotalSpinMilliseconds / Statistics.FramesPaced;
+
+		//The first frame has nothing before it to measure an interval from
+		if (LastFrameTicks != 0)
+		{
+			uint64_t intervalCount = Statistics.FramesPaced - 1;
+			Statistics.LastFrameIntervalMilliseconds = (frameTicks - LastFrameTicks) * ticksToMilliseconds;
+			TotalFrameIntervalMilliseconds += Statistics.LastFrameIntervalMilliseconds;
+			Statistics.AverageFrameIntervalMilliseconds = TotalFrameIntervalMilliseconds / intervalCount;
+
+			Statistics.LastJitterMilliseconds = std::abs(Statistics.LastFrameIntervalMilliseconds - FramePeriodTicks * ticksToMilliseconds);
+			TotalJitterMilliseconds += Statistics.LastJitterMilliseconds;
+			Statistics.AverageJitterMilliseconds = TotalJitterMilliseconds / intervalCount;
+			if (Statistics.LastJitterMilliseconds > Statistics.MaximumJitterMilliseconds)
+			{
+				Statistics.MaximumJitterMilliseconds = Statistics.LastJitterMilliseconds;
+			}
+		}
+		LastFrameTicks = frameTicks;
+
+		UpdateThreadCPUUsage();
+	}
+
+	void FramePacer::UpdateThreadCPUUsage() noexcept
+	{
+		//Only sample about once a second, since GetThreadTimes is coarse
+		FILETIME currentTime;
+		GetSystemTimeAsFileTime(&currentTime);
+		uint64_t currentTimeTicks = (static_cast<uint64_t>(currentTime.dwHighDateTime) << 32) | currentTime.dwLowDateTime;
+		if (currentTimeTicks - CPUUsageSampleTime < 10'000'000)
+		{
+			return;
+		}
+
+		FILETIME creationTime, exitTime, kernelTime, userTime;
+		if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+		{
+			return;
+		}
+		uint64_t threadTimeTicks =
+			((static_cast<uint64_t>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime) +
+			((static_cast<uint64_t>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime);
+
+		if (CPUUsageSampleTime != 0)
+		{
+			Statistics.ThreadCPUUsage = static_cast<double>(threadTimeTicks - CPUUsageSampleThreadTime) / static_cast<double>(currentTimeTicks - CPUUsageSampleTime);
+		}
+
+		CPUUsageSampleTime = currentTimeTicks;
+		CPUUsageSampleThreadTime = threadTimeTicks;
+	}
+}
\ No newline at end of file
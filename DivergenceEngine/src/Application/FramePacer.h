@@ -0,0 +1,74 @@
+#pragma once
+#include <Windows.h>
+#include <cstdint>
+
+namespace DivergenceEngine
+{
+	//How steadily frames are being started, and how much of a core the thread starting them uses
+	struct FramePacingStatistics
+	{
+		uint64_t FramesPaced = 0;
+		uint64_t WakeupsForInput = 0; //Times the wait was cut short so queued messages could be handled
+		double LastFrameIntervalMilliseconds = 0;
+		double AverageFrameIntervalMilliseconds = 0;
+		double LastJitterMilliseconds = 0; //How far the last frame interval was from the target
+		double AverageJitterMilliseconds = 0;
+		double MaximumJitterMilliseconds = 0;
+		double AverageSpinMilliseconds = 0; //Time spent spinning out the last fraction of each wait
+		double ThreadCPUUsage = 0; //Fraction of one core used by the pacing thread over the last second or so
+		bool IsTimerHighResolution = false;
+	};
+
+	//Starts frames at a target rate without spinning through the wait. The thread sleeps on a waitable timer until just
+	//before the frame is due, then spins the last fraction of a millisecond away, since timers wake up a little late.
+	//Window messages wake it early, so input is never left waiting for the frame
+	class FramePacer
+	{
+	private:
+		//Constants
+		static constexpr double HIGH_RESOLUTION_SPIN_SECONDS = 0.001;
+		static constexpr double LOW_RESOLUTION_SPIN_SECONDS = 0.002;
+
+		//Datafields
+		HANDLE WaitableTimer = nullptr;
+		bool IsTimerHighResolution = false;
+		int64_t CounterFrequency;
+		int64_t FramePeriodTicks;
+		int64_t SpinTicks;
+		int64_t NextFrameTicks = 0;
+		int64_t LastFrameTicks = 0;
+
+		//Statistics
+		FramePacingStatistics Statistics;
+		double TotalFrameIntervalMilliseconds = 0;
+		double TotalJitterMilliseconds = 0;
+		double TotalSpinMilliseconds = 0;
+		uint64_t CPUUsageSampleTime = 0;
+		uint64_t CPUUsageSampleThreadTime = 0;
+
+		//Helpers
+		int64_t QueryCounter() const noexcept;
+		void RecordFrame(int64_t frameTicks, int64_t spinTicks) noexcept;
+		void UpdateThreadCPUUsage() noexcept;
+
+	public:
+		//Constructors and Destructors
+		FramePacer(double targetFrameSeconds);
+		~FramePacer();
+
+		//Deleted stuff
+		FramePacer(const FramePacer&) = delete;
+		FramePacer& operator=(const FramePacer&) = delete;
+
+		//Public functions
+		//Waits until the next frame is due and returns true, or returns false as soon as a message is waiting to be handled
+		bool WaitForNextFrame();
+
+		//Setters
+		void SetTargetFrameSeconds(double targetFrameSeconds) noexcept;
+
+		//Statistics
+		const FramePacingStatistics& GetStatistics() const noexcept;
+		void ResetStatistics() noexcept;
+	};
+}
\ No newline at end of file
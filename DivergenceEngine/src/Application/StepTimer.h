@@ -4,10 +4,12 @@
 
 #pragma once
 
-#include <Windows.h>
+#include "Clock.h"
 #include <cmath>
 #include <cstdint>
-#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <utility>
 
 
 namespace DX
@@ -16,31 +18,46 @@ namespace DX
     class StepTimer
     {
     public:
-        StepTimer() noexcept(false) :
+        explicit StepTimer(std::shared_ptr<IClock> clock = CreateDefaultClock()) noexcept(false) :
             m_elapsedTicks(0),
             m_totalTicks(0),
             m_leftOverTicks(0),
             m_frameCount(0),
             m_framesPerSecond(0),
             m_framesThisSecond(0),
-            m_qpcSecondCounter(0),
+            m_clockSecondCounter(0),
             m_isFixedTimeStep(false),
-            m_targetElapsedTicks(TicksPerSecond / 60)
+            m_targetElapsedTicks(TicksPerSecond / 60),
+            m_maxUpdatesPerTick(0),
+            m_updatesLastTick(0),
+            m_droppedUpdatesLastTick(0)
         {
-            if (!QueryPerformanceFrequency(&m_qpcFrequency))
+            SetClock(std::move(clock));
+        }
+
+        // Set the source of time. Timing continues from the new clock's current time.
+        void SetClock(std::shared_ptr<IClock> clock)
+        {
+            if (!clock)
             {
-                throw std::exception();
+                throw std::invalid_argument("StepTimer::SetClock() - The clock cannot be null");
             }
 
-            if (!QueryPerformanceCounter(&m_qpcLastTime))
+            m_clock = std::move(clock);
+            m_clockFrequency = m_clock->GetFrequency();
+            if (m_clockFrequency == 0)
             {
-                throw std::exception();
+                throw std::invalid_argument("StepTimer::SetClock() - The clock frequency cannot be 0");
             }
 
+            m_clockLastTime = m_clock->GetTicks();
+
             // Initialize max delta to 1/10 of a second.
-            m_qpcMaxDelta = static_cast<uint64_t>(m_qpcFrequency.QuadPart / 10);
+            m_clockMaxDelta = m_clockFrequency / 10;
         }
 
+        const std::shared_ptr<IClock>& GetClock() const noexcept { return m_clock; }
+
         // Get elapsed time since the previous Update call.
         uint64_t GetElapsedTicks() const noexcept { return m_elapsedTicks; }
         double GetElapsedSeconds() const noexcept { return TicksToSeconds(m_elapsedTicks); }
@@ -55,6 +72,17 @@ namespace DX
         // Get the current framerate.
         uint32_t GetFramesPerSecond() const noexcept { return m_framesPerSecond; }
 
+        // Get how many Update calls the last Tick made, and how many it skipped because of the cap.
+        uint32_t GetUpdatesLastTick() const noexcept { return m_updatesLastTick; }
+        uint64_t GetDroppedUpdatesLastTick() const noexcept { return m_droppedUpdatesLastTick; }
+
+        // Get how far the clock is between the last fixed timestep update and the next, from 0 to 1.
+        // In variable timestep mode every Tick updates up to the current time, so this is always 1.
+        double GetStepProgress() const noexcept
+        {
+            return m_isFixedTimeStep ? static_cast<double>(m_leftOverTicks) / static_cast<double>(m_targetElapsedTicks) : 1.0;
+        }
+
         // Set whether to use fixed or variable timestep mode.
         void SetFixedTimeStep(bool isFixedTimestep) noexcept { m_isFixedTimeStep = isFixedTimestep; }
 
@@ -62,6 +90,9 @@ namespace DX
         void SetTargetElapsedTicks(uint64_t targetElapsed) noexcept { m_targetElapsedTicks = targetElapsed; }
         void SetTargetElapsedSeconds(double targetElapsed) noexcept { m_targetElapsedTicks = SecondsToTicks(targetElapsed); }
 
+        // Set the most Update calls one Tick may make to catch up in fixed timestep mode. 0 means no cap.
+        void SetMaxUpdatesPerTick(uint32_t maxUpdates) noexcept { m_maxUpdatesPerTick = maxUpdates; }
+
         // Integer format represents time using 10,000,000 ticks per second.
         static constexpr uint64_t TicksPerSecond = 10000000;
 
@@ -74,15 +105,12 @@ namespace DX
 
         void ResetElapsedTime()
         {
-            if (!QueryPerformanceCounter(&m_qpcLastTime))
-            {
-                throw std::exception();
-            }
+            m_clockLastTime = m_clock->GetTicks();
 
             m_leftOverTicks = 0;
             m_framesPerSecond = 0;
             m_framesThisSecond = 0;
-            m_qpcSecondCounter = 0;
+            m_clockSecondCounter = 0;
         }
 
         // Update timer state, calling the specified Update function the appropriate number of times.
@@ -90,29 +118,26 @@ namespace DX
         void Tick(const TUpdate& update)
         {
             // Query the current time.
-            LARGE_INTEGER currentTime;
-
-            if (!QueryPerformanceCounter(&currentTime))
-            {
-                throw std::exception();
-            }
+            const uint64_t currentTime = m_clock->GetTicks();
 
-            uint64_t timeDelta = static_cast<uint64_t>(currentTime.QuadPart - m_qpcLastTime.QuadPart);
+            uint64_t timeDelta = currentTime - m_clockLastTime;
 
-            m_qpcLastTime = currentTime;
-            m_qpcSecondCounter += timeDelta;
+            m_clockLastTime = currentTime;
+            m_clockSecondCounter += timeDelta;
 
             // Clamp excessively large time deltas (e.g. after paused in the debugger).
-            if (timeDelta > m_qpcMaxDelta)
+            if (timeDelta > m_clockMaxDelta)
             {
-                timeDelta = m_qpcMaxDelta;
+                timeDelta = m_clockMaxDelta;
             }
 
-            // Convert QPC units into a canonical tick format. This cannot overflow due to the previous clamp.
+            // Convert clock units into a canonical tick format. This cannot overflow due to the previous clamp.
             timeDelta *= TicksPerSecond;
-            timeDelta /= static_cast<uint64_t>(m_qpcFrequency.QuadPart);
+            timeDelta /= m_clockFrequency;
 
             const uint32_t lastFrameCount = m_frameCount;
+            m_updatesLastTick = 0;
+            m_droppedUpdatesLastTick = 0;
 
             if (m_isFixedTimeStep)
             {
@@ -134,10 +159,20 @@ namespace DX
 
                 while (m_leftOverTicks >= m_targetElapsedTicks)
                 {
+                    // Past the cap, drop the whole steps that are left but keep the partial one, so the
+                    // step progress carries on smoothly into the next Tick.
+                    if (m_maxUpdatesPerTick != 0 && m_updatesLastTick == m_maxUpdatesPerTick)
+                    {
+                        m_droppedUpdatesLastTick = m_leftOverTicks / m_targetElapsedTicks;
+                        m_leftOverTicks %= m_targetElapsedTicks;
+                        break;
+                    }
+
                     m_elapsedTicks = m_targetElapsedTicks;
                     m_totalTicks += m_targetElapsedTicks;
                     m_leftOverTicks -= m_targetElapsedTicks;
                     m_frameCount++;
+                    m_updatesLastTick++;
 
                     update();
                 }
@@ -149,6 +184,7 @@ namespace DX
                 m_totalTicks += timeDelta;
                 m_leftOverTicks = 0;
                 m_frameCount++;
+                m_updatesLastTick = 1;
 
                 update();
             }
@@ -159,19 +195,20 @@ namespace DX
                 m_framesThisSecond++;
             }
 
-            if (m_qpcSecondCounter >= static_cast<uint64_t>(m_qpcFrequency.QuadPart))
+            if (m_clockSecondCounter >= m_clockFrequency)
             {
                 m_framesPerSecond = m_framesThisSecond;
                 m_framesThisSecond = 0;
-                m_qpcSecondCounter %= static_cast<uint64_t>(m_qpcFrequency.QuadPart);
+                m_clockSecondCounter %= m_clockFrequency;
             }
         }
 
     private:
-        // Source timing data uses QPC units.
-        LARGE_INTEGER m_qpcFrequency;
-        LARGE_INTEGER m_qpcLastTime;
-        uint64_t m_qpcMaxDelta;
+        // Source timing data uses the clock's units.
+        std::shared_ptr<IClock> m_clock;
+        uint64_t m_clockFrequency;
+        uint64_t m_clockLastTime;
+        uint64_t m_clockMaxDelta;
 
         // Derived timing data uses a canonical tick format.
         uint64_t m_elapsedTicks;
@@ -182,10 +219,15 @@ namespace DX
         uint32_t m_frameCount;
         uint32_t m_framesPerSecond;
         uint32_t m_framesThisSecond;
-        uint64_t m_qpcSecondCounter;
+        uint64_t m_clockSecondCounter;
 
         // Members for configuring fixed timestep mode.
         bool m_isFixedTimeStep;
         uint64_t m_targetElapsedTicks;
+        uint32_t m_maxUpdatesPerTick;
+
+        // Members for tracking catch-up updates.
+        uint32_t m_updatesLastTick;
+        uint64_t m_droppedUpdatesLastTick;
     };
 }
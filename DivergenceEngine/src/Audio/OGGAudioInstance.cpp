@@ -2,6 +2,8 @@
 #include "Audio/IAudioInstance.h"
 #include "Audio/OGGAudioInstance.h"
 #include "Logger/Logger.h"
+#include "Profiler/Profiler.h"
+#include "Metrics/Metrics.h"
 #include <algorithm>
 #include <stdexcept>
 #include <stdio.h>
@@ -100,7 +102,7 @@ namespace DivergenceEngine
 		ThreadIsRunning = true;
 		BankLoadingThreadObject = std::thread(&OGGAudioInstance::BankLoadingThread, this);
 
-		Logger::Log(std::format(L"Loaded {}", FilePath));
+		DIVERGENCE_LOG_DEBUG(L"Loaded {}", FilePath);
 	}
 
 	OGGAudioInstance::~OGGAudioInstance()
@@ -114,12 +116,13 @@ namespace DivergenceEngine
 		BankLoadingThreadObject.join();
 
 		ov_clear(&VorbisFileObject);
-		Logger::Log(std::format(L"Destroyed {}", FilePath));
+		DIVERGENCE_LOG_DEBUG(L"Destroyed {}", FilePath);
 	}
 
 	void OGGAudioInstance::Play(bool isLoop)
 	{
 		IsLoop = isLoop;
+		HasSubmittedSinceStart = false;
 		SoundEffectInstance->Play();
 	}
 
@@ -187,9 +190,19 @@ namespace DivergenceEngine
 
 	void OGGAudioInstance::BufferNeeded(DirectX::DynamicSoundEffectInstance* instance)
 	{
+		Profiler::Zone profileZone("OGGAudioInstance::BufferNeeded");
+		static Counter& buffersSubmitted = MetricsRegistry::GetCounter("Audio.BuffersSubmitted");
+		static Counter& underruns = MetricsRegistry::GetCounter("Audio.Underruns");
+
 		//Lock the current bank
 		std::unique_lock<std::mutex> lock(BankMutexArray[CurrentBankIndex]);
 
+		//Every buffer already played out before this one was asked for, so there was a gap in the sound
+		if (HasSubmittedSinceStart && !StopLoadingBuffers && instance->GetState() == DirectX::PLAYING && instance->GetPendingBufferCount() == 0)
+		{
+			underruns.Add();
+		}
+
 		//If the bank has 0 size, the file must be over
 		if (TrueBankSizeArray[CurrentBankIndex] == 0)
 		{
@@ -201,6 +214,8 @@ namespace DivergenceEngine
 			//Submit the next buffer
 			long bufferSize = std::min(MAX_BUFFER_SIZE, TrueBankSizeArray[CurrentBankIndex] - CurrentBankDataIndex);
 			instance->SubmitBuffer(reinterpret_cast<uint8_t*>(&BankArray[CurrentBankIndex][CurrentBankDataIndex]), bufferSize);
+			buffersSubmitted.Add();
+			HasSubmittedSinceStart = true;
 			CurrentBankDataIndex += bufferSize;
 
 			//If we are at the end of the bank, load the next bank in the currently expired bank and increase the bank index
@@ -261,9 +276,13 @@ namespace DivergenceEngine
 
 	void OGGAudioInstance::LoadBank(uint32_t bankIndex)
 	{
+		Profiler::Zone profileZone("OGGAudioInstance::LoadBank");
+		static Histogram& bankRefillMicroseconds = MetricsRegistry::GetHistogram("Audio.BankRefillMicroseconds");
+		ScopedHistogramTimer refillTimer(bankRefillMicroseconds);
+
 		//Lock the bank
 		std::lock_guard<std::mutex> lock(BankMutexArray[bankIndex]);
-		//Logger::Log(std::format(L"Begin loading bank {}", bankIndex));
+		DIVERGENCE_LOG_TRACE(L"Begin loading bank {}", bankIndex);
 
 		//Fill the bank until it is either full or the file is finished and loop is disabled
 		TrueBankSizeArray[bankIndex] = 0;
@@ -291,6 +310,6 @@ namespace DivergenceEngine
 				TrueBankSizeArray[bankIndex] += currentBytesRead;
 			}
 		}
-		//Logger::Log(std::format(L"Finished loading bank {}", bankIndex));
+		DIVERGENCE_LOG_TRACE(L"Finished loading bank {}", bankIndex);
 	}
 }
\ No newline at end of file
@@ -29,6 +29,7 @@ namespace DivergenceEngine
 		long CurrentBankDataIndex = 0;
 		bool ThreadIsRunning;
 		bool StopLoadingBuffers = false;
+		bool HasSubmittedSinceStart = false; //Playback starts with nothing queued, so running dry only counts as an underrun after this
 		std::array<std::array<uint8_t, MAX_BANK_SIZE>, NUMBER_OF_BANKS> BankArray;
 		std::array<long, NUMBER_OF_BANKS> TrueBankSizeArray;
 		std::array<std::mutex, NUMBER_OF_BANKS> BankMutexArray;
@@ -92,13 +92,13 @@ namespace DivergenceEngine
 		//Create the sound effect
 		SimpleSoundEffect = std::make_unique<DirectX::SoundEffect>(engine, WaveData, waveFormat, startAudio, totalBytesRead);
 
-		Logger::Log(std::format(L"Loaded {}", FilePath));
+		DIVERGENCE_LOG_DEBUG(L"Loaded {}", FilePath);
 	}
 	
 	OGGSimpleSoundEffect::~OGGSimpleSoundEffect()
 	{
 		ov_clear(&VorbisFileObject);
-		Logger::Log(std::format(L"Destroyed {}", FilePath));
+		DIVERGENCE_LOG_DEBUG(L"Destroyed {}", FilePath);
 	}
 
 	void OGGSimpleSoundEffect::Play(float volume)
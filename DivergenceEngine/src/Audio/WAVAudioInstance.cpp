@@ -5,6 +5,8 @@
 #include <fstream>
 #include "StringConverter.h"
 #include "Logger/Logger.h"
+#include "Profiler/Profiler.h"
+#include "Metrics/Metrics.h"
 
 namespace fs = std::filesystem;
 
@@ -101,7 +103,7 @@ namespace DivergenceEngine
 		//Set the volume
 		SoundEffectInstance->SetVolume(initialVolume);
 
-		Logger::Log(std::format(L"Loaded {}", FileInfo.FilePath));
+		DIVERGENCE_LOG_DEBUG(L"Loaded {}", FileInfo.FilePath);
 	}
 
 	WAVAudioInstance::~WAVAudioInstance()
@@ -113,12 +115,13 @@ namespace DivergenceEngine
 		CloseHandle(FileMappingHandle);
 		CloseHandle(FileHandle);
 
-		Logger::Log(std::format(L"Destroyed {}", FileInfo.FilePath));
+		DIVERGENCE_LOG_DEBUG(L"Destroyed {}", FileInfo.FilePath);
 	}
 
 	void WAVAudioInstance::Play(bool isLoop)
 	{
 		IsLoop = isLoop;
+		HasSubmittedSinceStart = false;
 		SoundEffectInstance->Play();
 	}
 
@@ -186,6 +189,16 @@ namespace DivergenceEngine
 	//TODO: Handle "Detecting new audio devices" (https://github.com/microsoft/DirectXTK/wiki/Adding-audio-to-your-project#detecting-new-audio-devices)
 	void WAVAudioInstance::BufferNeeded(DirectX::DynamicSoundEffectInstance* instance)
 	{		
+		Profiler::Zone profileZone("WAVAudioInstance::BufferNeeded");
+		static Counter& buffersSubmitted = MetricsRegistry::GetCounter("Audio.BuffersSubmitted");
+		static Counter& underruns = MetricsRegistry::GetCounter("Audio.Underruns");
+
+		//Every buffer already played out before this one was asked for, so there was a gap in the sound
+		if (HasSubmittedSinceStart && !StopLoadingBuffers && instance->GetState() == DirectX::PLAYING && instance->GetPendingBufferCount() == 0)
+		{
+			underruns.Add();
+		}
+
 		//Get the target buffer size
 		//If the byte rate is 176400 and a max number of buffers is 5, then 2048*5/176400 = 0.05 seconds (pretty good buffer sizing for latency, don't hear crackling either)
 		//Multiplying by PlaybackSpeed so the buffers can keep up without crackle (might cause latency, check later)
@@ -199,6 +212,8 @@ namespace DivergenceEngine
 
 			//Submit buffer
 			instance->SubmitBuffer(&DataChunkFileMappingPointer[DataChunkCurrentIndex], bufferSize);
+			buffersSubmitted.Add();
+			HasSubmittedSinceStart = true;
 
 			//Increment the current index by the buffer submitted
 			DataChunkCurrentIndex += bufferSize;
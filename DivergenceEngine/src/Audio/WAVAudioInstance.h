@@ -26,6 +26,7 @@ namespace DivergenceEngine
 		const int32_t MAX_BUFFERS = 5;
 		uint32_t DataChunkCurrentIndex;
 		bool StopLoadingBuffers = false; //This is necessary so, if the callback calls again after this is set to true, it does not try to load buffers again
+		bool HasSubmittedSinceStart = false; //Playback starts with nothing queued, so running dry only counts as an underrun after this
 
 		//Memory mapped file datafields
 		HANDLE FileHandle;
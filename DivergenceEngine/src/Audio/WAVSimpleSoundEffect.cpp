@@ -23,12 +23,12 @@ namespace DivergenceEngine
 
 		SimpleSoundEffect = std::make_unique<DirectX::SoundEffect>(engine, FilePath.c_str());
 
-		Logger::Log(std::format(L"Loaded {}", FilePath));
+		DIVERGENCE_LOG_DEBUG(L"Loaded {}", FilePath);
 	}
 
 	WAVSimpleSoundEffect::~WAVSimpleSoundEffect()
 	{
-		Logger::Log(std::format(L"Destroyed {}", FilePath));
+		DIVERGENCE_LOG_DEBUG(L"Destroyed {}", FilePath);
 	}
 
 	void WAVSimpleSoundEffect::Play(float volume)
@@ -29,7 +29,7 @@ namespace DX
         {
             _com_error error(hr);
             std::wstring errorMessage = std::format(L"EXCEPTION: {}", error.ErrorMessage());
-            DivergenceEngine::Logger::Log(errorMessage);
+            DivergenceEngine::Logger::Log(DivergenceEngine::LogLevel::Error, errorMessage);
             throw com_exception(hr);
         }
     }
@@ -5,9 +5,12 @@
 //Export headers
 #include <Windows.h>
 #include "Logger/Logger.h"
+#include "Profiler/Profiler.h"
+#include "Metrics/Metrics.h"
 #include "Window/Window.h"
 #include "Application/Application.h"
 #include "Audio/AudioIncludes.h"
 #include "Templates/Templates.h"
+#include "Graphics/SDFFontGenerator.h"
 
 //#include "Application/EntryPoint.h"
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "Graphics/D3D11GPUTimer.h"
+#include "DXComErrorHandler.h"
+
+namespace DivergenceEngine
+{
+	D3D11GPUTimer::D3D11GPUTimer(ID3D11Device* device, ID3D11DeviceContext* deviceContext) :
+		DeviceContextPointer(deviceContext)
+	{
+		D3D11_QUERY_DESC disjointDescription = { D3D11_QUERY_TIMESTAMP_DISJOINT, 0 };
+		D3D11_QUERY_DESC timestampDescription = { D3D11_QUERY_TIMESTAMP, 0 };
+		for (FrameQueries& frame : Frames)
+		{
+			DX::ThrowIfFailed(device->CreateQuery(&disjointDescription, &frame.Disjoint));
+			DX::ThrowIfFailed(device->CreateQuery(&timestampDescription, &frame.BeginTimestamp));
+			DX::ThrowIfFailed(device->CreateQuery(&timestampDescription, &frame.EndTimestamp));
+			for (PassQueries& pass : frame.Passes)
+			{
+				DX::ThrowIfFailed(device->CreateQuery(&timestampDescription, &pass.BeginTimestamp));
+				DX::ThrowIfFailed(device->CreateQuery(&timestampDescription, &pass.EndTimestamp));
+			}
+		}
+
+		//Reserved up front so reading results back never allocates
+		LastFrameTimings.Passes.reserve(MAX_PASSES_PER_FRAME);
+	}
+
+	void D3D11GPUTimer::BeginPass(const char* name, uint32_t index) noexcept
+	{
+		if (!IsFrameOpen)
+		{
+			BeginFrame();
+		}
+		EndPass();
+
+		FrameQueries& frame = Frames[WriteFrameIndex];
+		if (frame.PassCount == MAX_PASSES_PER_FRAME)
+		{
+			return;
+		}
+
+		PassQueries& pass = frame.Passes[frame.PassCount];
+		pass.Name = name;
+		pass.Index = index;
+		DeviceContextPointer->End(pass.BeginTimestamp.Get());
+		IsPassOpen = true;
+	}
+
+	void D3D11GPUTimer::EndPass() noexcept
+	{
+		if (!IsPassOpen)
+		{
+			return;
+		}
+
+		FrameQueries& frame = Frames[WriteFrameIndex];
+		DeviceContextPointer->End(frame.Passes[frame.PassCount].EndTimestamp.Get());
+		frame.PassCount++;
+		IsPassOpen = false;
+	}
+
+	void D3D11GPUTimer::EndFrame() noexcept
+	{
+		if (!IsFrameOpen)
+		{
+			return;
+		}
+		EndPass();
+
+		FrameQueries& frame = Frames[WriteFrameIndex];
+		DeviceContextPointer->End(frame.EndTimestamp.Get());
+		DeviceContextPointer->End(frame.Disjoint.Get());
+		frame.IsPending = true;
+		IsFrameOpen = false;
+		WriteFrameIndex = (WriteFrameIndex + 1) % FRAMES_IN_FLIGHT;
+
+		ReadFinishedFrames();
+	}
+
+	const GPUFrameTimings& D3D11GPUTimer::GetLastFrameTimings() const noexcept
+	{
+		return LastFrameTimings;
+	}
+
+	uint64_t D3D11GPUTimer::GetFramesDropped() const noexcept
+	{
+		return FramesDropped;
+	}
+
+	void D3D11GPUTimer::BeginFrame() noexcept
+	{
+		//The GPU is so far behind that every set of queries is in use. The oldest frame is given up on so its queries can be used again
+		FrameQueries& frame = Frames[WriteFrameIndex];
+		if (frame.IsPending)
+		{
+			frame.IsPending = false;
+			ReadFrameIndex = (ReadFrameIndex + 1) % FRAMES_IN_FLIGHT;
+			FramesDropped++;
+		}
+
+		frame.PassCount = 0;
+		frame.FrameNumber = NextFrameNumber++;
+		DeviceContextPointer->Begin(frame.Disjoint.Get());
+		DeviceContextPointer->End(frame.BeginTimestamp.Get());
+		IsFrameOpen = true;
+	}
+
+	//Reads back every frame the GPU has finished, oldest first. Nothing is flushed, so a frame that is not done is left for later
+	void D3D11GPUTimer::ReadFinishedFrames() noexcept
+	{
+		while (Frames[ReadFrameIndex].IsPending)
+		{
+			FrameQueries& frame = Frames[ReadFrameIndex];
+			D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjointData;
+			if (DeviceContextPointer->GetData(frame.Disjoint.Get(), &disjointData, sizeof(disjointData), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+			{
+				return;
+			}
+
+			frame.IsPending = false;
+			ReadFrameIndex = (ReadFrameIndex + 1) % FRAMES_IN_FLIGHT;
+
+			//The GPU clock changed frequency part way through (power saving, for one), so the timestamps cannot be compared
+			uint64_t frameBegin;
+			uint64_t frameEnd;
+			if (disjointData.Disjoint || !ReadTimestamp(frame.BeginTimestamp.Get(), frameBegin) || !ReadTimestamp(frame.EndTimestamp.Get(), frameEnd))
+			{
+				FramesDropped++;
+				continue;
+			}
+
+			double millisecondsPerTick = 1000.0 / static_cast<double>(disjointData.Frequency);
+			LastFrameTimings.FrameNumber = frame.FrameNumber;
+			LastFrameTimings.FrameMilliseconds = static_cast<double>(frameEnd - frameBegin) * millisecondsPerTick;
+			LastFrameTimings.Passes.clear();
+			for (size_t passIndex = 0; passIndex < frame.PassCount; passIndex++)
+			{
+				const PassQueries& pass = frame.Passes[passIndex];
+				uint64_t passBegin;
+				uint64_t passEnd;
+				double passMilliseconds = 0;
+				if (ReadTimestamp(pass.BeginTimestamp.Get(), passBegin) && ReadTimestamp(pass.EndTimestamp.Get(), passEnd))
+				{
+					passMilliseconds = static_cast<double>(passEnd - passBegin) * millisecondsPerTick;
+				}
+
+				LastFrameTimings.Passes.push_back(GPUPassTiming{ pass.Name, pass.Index, passMilliseconds });
+			}
+		}
+	}
+
+	bool D3D11GPUTimer::ReadTimestamp(ID3D11Query* query, uint64_t& timestamp) noexcept
+	{
+		return DeviceContextPointer->GetData(query, &timestamp, sizeof(timestamp), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+	}
+}
\ No newline at end of file
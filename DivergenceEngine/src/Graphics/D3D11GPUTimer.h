@@ -0,0 +1,68 @@
+#pragma once
+#include "Graphics/GPUTimer.h"
+#include <Windows.h>
+#include <d3d11.h>
+#include <wrl.h>
+#include <array>
+
+namespace DivergenceEngine
+{
+	//Times passes with timestamp queries inside a disjoint query per frame. Each frame has its own set of queries, so a frame's
+	//results are only read once the GPU has finished it, without ever stalling on it
+	class D3D11GPUTimer : public IGPUTimer
+	{
+	private:
+		//Constants
+		static constexpr size_t FRAMES_IN_FLIGHT = 5; //Frames the GPU may be behind by before results start being dropped
+
+		struct PassQueries
+		{
+			const char* Name;
+			uint32_t Index;
+			Microsoft::WRL::ComPtr<ID3D11Query> BeginTimestamp;
+			Microsoft::WRL::ComPtr<ID3D11Query> EndTimestamp;
+		};
+
+		struct FrameQueries
+		{
+			Microsoft::WRL::ComPtr<ID3D11Query> Disjoint;
+			Microsoft::WRL::ComPtr<ID3D11Query> BeginTimestamp;
+			Microsoft::WRL::ComPtr<ID3D11Query> EndTimestamp;
+			std::array<PassQueries, MAX_PASSES_PER_FRAME> Passes;
+			size_t PassCount = 0;
+			uint64_t FrameNumber = 0;
+			bool IsPending = false; //Ended, but not read back yet
+		};
+
+		//Datafields
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext> DeviceContextPointer;
+		std::array<FrameQueries, FRAMES_IN_FLIGHT> Frames;
+		size_t WriteFrameIndex = 0;
+		size_t ReadFrameIndex = 0;
+		bool IsFrameOpen = false;
+		bool IsPassOpen = false;
+		uint64_t NextFrameNumber = 0;
+		uint64_t FramesDropped = 0;
+		GPUFrameTimings LastFrameTimings;
+
+		//Helpers
+		void BeginFrame() noexcept;
+		void ReadFinishedFrames() noexcept;
+		bool ReadTimestamp(ID3D11Query* query, uint64_t& timestamp) noexcept;
+
+	public:
+		//Constructors and Destructors
+		D3D11GPUTimer(ID3D11Device* device, ID3D11DeviceContext* deviceContext);
+
+		//Deleted stuff
+		D3D11GPUTimer(const D3D11GPUTimer&) = delete;
+		D3D11GPUTimer& operator=(const D3D11GPUTimer&) = delete;
+
+		//Overriden functions
+		void BeginPass(const char* name, uint32_t index = 0) noexcept override;
+		void EndPass() noexcept override;
+		void EndFrame() noexcept override;
+		const GPUFrameTimings& GetLastFrameTimings() const noexcept override;
+		uint64_t GetFramesDropped() const noexcept override;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace DivergenceEngine
+{
+	//How long the GPU spent on one part of a frame
+	struct GPUPassTiming
+	{
+		const char* Name;
+		uint32_t Index = 0; //Tells apart passes with the same name, like the layers
+		double Milliseconds = 0;
+	};
+
+	//What the GPU spent on a whole frame, from the first pass to the present
+	struct GPUFrameTimings
+	{
+		uint64_t FrameNumber = 0;
+		double FrameMilliseconds = 0;
+		std::vector<GPUPassTiming> Passes;
+	};
+
+	//Times passes of a frame on the GPU. Results come back a few frames after the frame they are from, since the GPU runs behind
+	//the CPU, so GetLastFrameTimings always describes the newest frame the GPU has finished
+	class IGPUTimer
+	{
+	public:
+		//Passes past this many in one frame are not timed
+		static constexpr size_t MAX_PASSES_PER_FRAME = 64;
+
+		virtual ~IGPUTimer() {};
+
+		//The first pass of a frame starts the frame. Passes cannot be nested, so a pass begun while another is open ends it
+		virtual void BeginPass(const char* name, uint32_t index = 0) noexcept = 0;
+		virtual void EndPass() noexcept = 0;
+		virtual void EndFrame() noexcept = 0;
+
+		virtual const GPUFrameTimings& GetLastFrameTimings() const noexcept = 0;
+		virtual uint64_t GetFramesDropped() const noexcept = 0; //Frames whose results were lost, either overwritten before the GPU finished or timed while the clock was unreliable
+	};
+
+	//Used when the GPU is not timed or there is no GPU at all. It keeps the passes of each frame, with every time as 0
+	class NullGPUTimer : public IGPUTimer
+	{
+	private:
+		//Datafields
+		GPUFrameTimings CurrentFrameTimings;
+		GPUFrameTimings LastFrameTimings;
+
+	public:
+		//Constructors and Destructors
+		NullGPUTimer()
+		{
+			//Reserved up front so passes never allocate in the noexcept calls
+			CurrentFrameTimings.Passes.reserve(MAX_PASSES_PER_FRAME);
+			LastFrameTimings.Passes.reserve(MAX_PASSES_PER_FRAME);
+		}
+
+		//Overriden functions
+		void BeginPass(const char* name, uint32_t index = 0) noexcept override
+		{
+			if (CurrentFrameTimings.Passes.size() < MAX_PASSES_PER_FRAME)
+			{
+				CurrentFrameTimings.Passes.push_back(GPUPassTiming{ name, index });
+			}
+		}
+
+		void EndPass() noexcept override {}
+
+		void EndFrame() noexcept override
+		{
+			std::swap(CurrentFrameTimings, LastFrameTimings);
+			CurrentFrameTimings.Passes.clear();
+			CurrentFrameTimings.FrameNumber = LastFrameTimings.FrameNumber + 1;
+		}
+
+		const GPUFrameTimings& GetLastFrameTimings() const noexcept override { return LastFrameTimings; }
+		uint64_t GetFramesDropped() const noexcept override { return 0; }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+#include <Windows.h>
+#include <vector>
+#include <memory>
+#include <SimpleMath.h>
+#include "Graphics/OutlinedFontAtlas.h"
+
+namespace DivergenceEngine
+{
+	//A string that has already been laid out into glyph quads. It is built once by the Graphics controller and can then be
+	//drawn every frame and hit tested on every mouse event, without the font having to measure or walk the string again
+	struct GlyphRun
+	{
+		struct GlyphQuad
+		{
+			RECT SourceRectangle; //Rectangle of the glyph inside the font's sprite sheet
+			DirectX::SimpleMath::Vector2 Offset; //Top left of the glyph, relative to the top left of the text
+		};
+
+		std::vector<GlyphQuad> Quads;
+		DirectX::SimpleMath::Vector2 Size; //Same as SpriteFont::MeasureString (whitespace included)
+		DirectX::SimpleMath::Rectangle Bounds; //Same as SpriteFont::MeasureDrawBounds (whitespace included), relative to the top left of the text
+		std::shared_ptr<OutlinedFontAtlas> OutlineAtlas; //Set when the run was laid out with an outline. The quads then refer to this atlas instead of the sprite sheet
+
+		//Distance field runs only
+		float Scale = 1.0f; //How much the quads are scaled up from the font's BaseSize
+		float OutlineThreshold = 0.5f; //Distance the outline starts at. 0.5 (the edge of the glyph) means there is no outline
+	};
+}
\ No newline at end of file
@@ -1,10 +1,29 @@
+#define NOMINMAX
 #include "Graphics.h"
+#include "Profiler/Profiler.h"
+#include "Metrics/Metrics.h"
 #include <WICTextureLoader.h>
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cwctype>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <d3dcompiler.h>
+#include <dxgi1_5.h>
 #include "DXComErrorHandler.h"
+#include "Graphics/ShaderSources.h"
+#include "Graphics/D3D11GPUTimer.h"
+#include "StringConverter.h"
 
 namespace wrl = Microsoft::WRL;
 
 #pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "d3dcompiler.lib")
 
 namespace DivergenceEngine
 {
@@ -12,12 +31,1086 @@ namespace DivergenceEngine
 		FrameRate(frameRate), 
 		WindowHandle(windowHandle),
 		BufferWidth(bufferWidth),
-		BufferHeight(bufferHeight)
+		BufferHeight(bufferHeight),
+		BackBufferWidth(bufferWidth),
+		BackBufferHeight(bufferHeight)
 	{
+		CreateDeviceResources();
+		ResetRenderTargetAndViewport(BackBufferWidth, BackBufferHeight);
+	}
+
+	Graphics::~Graphics()
+	{
+		if (FrameLatencyWaitableObject != nullptr)
+		{
+			CloseHandle(FrameLatencyWaitableObject);
+		}
+	}
+
+	//Returns false if the device was lost, in which case nothing was presented and every resource has been made again
+	bool Graphics::Present()
+	{
+		Profiler::Zone profileZone("Graphics::Present");
+
+		//End any active sprite batches
+		EndSpriteBatch();
+
+		//Scale the scene onto the back buffer. The frame is timed on the GPU up to here, since Present only queues the frame
+		BeginGPUPass("Resolve");
+		ResolveScene();
+		EndGPUPass();
+		GPUTimer->EndFrame();
+
+		//Pick the resolution of the next frame from how long this one took. When the GPU is timed, a GPU bound frame counts
+		//too, even though its timings are from a few frames ago
+		double frameMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - FrameStartTime).count();
+		if (IsGPUTimingEnabled)
+		{
+			frameMilliseconds = std::max(frameMilliseconds, GPUTimer->GetLastFrameTimings().FrameMilliseconds);
+		}
+		UpdateDynamicResolution(frameMilliseconds);
+
+		//Without vertical sync, frames are shown as soon as they are ready. With tearing allowed, this also lets variable refresh rate displays follow the frame rate
+		UINT syncInterval = LatencyStatistics.IsVerticalSyncEnabled ? 1u : 0u;
+		UINT presentFlags = (!LatencyStatistics.IsVerticalSyncEnabled && LatencyStatistics.IsTearingSupported) ? DXGI_PRESENT_ALLOW_TEARING : 0u;
+		HRESULT hr = DXGI_ERROR_DEVICE_REMOVED;
+		if (!IsDeviceRemovalSimulated)
+		{
+			static Histogram& presentMicroseconds = MetricsRegistry::GetHistogram("Graphics.PresentMicroseconds");
+			Profiler::Zone swapChainZone("IDXGISwapChain::Present");
+			ScopedHistogramTimer presentTimer(presentMicroseconds);
+			hr = SwapChainPointer->Present(syncInterval, presentFlags);
+		}
+		IsDeviceRemovalSimulated = false;
+
+		//Measure from when the frame started reading input, if it waited for the swap chain
+		if (IsWaitingForFrame)
+		{
+			IsWaitingForFrame = false;
+			FramePresentCount++;
+			LatencyStatistics.LastInputToPresentMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - FrameWaitEndTime).count();
+			TotalInputToPresentMilliseconds += LatencyStatistics.LastInputToPresentMilliseconds;
+			LatencyStatistics.AverageInputToPresentMilliseconds = TotalInputToPresentMilliseconds / static_cast<double>(FramePresentCount);
+		}
+
+		if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET)
+		{
+			//Recovery replaces the textures drawables point at, so a thread recording frames has to do it between recordings
+			if (IsDeviceLostRecoveryDeferred)
+			{
+				IsRecoveryPending = true;
+				return false;
+			}
+
+			HandleDeviceLost();
+			return false;
+		}
+		DX::ThrowIfFailed(hr);
+
+		//The flip model unbinds the back buffer, and the next frame draws to the scene anyway
+		BindScene();
+		UpdateQueuedFrameCount();
+
+		static Counter& framesPresented = MetricsRegistry::GetCounter("Graphics.FramesPresented");
+		framesPresented.Add();
+		return true;
+	}
+
+	void Graphics::ClearFrame(float red, float green, float blue) noexcept
+	{
+		FrameStartTime = std::chrono::steady_clock::now();
+		BindScene();
+
+		const float colour[] = { red, green, blue, 1.0f };
+		BeginGPUPass("Clear");
+		DeviceContextPointer->ClearRenderTargetView(SceneRenderTargetPointer.Get(), colour);
+		EndGPUPass();
+	}
+
+	//Resizes the back buffer to the client area. The scene stays at the internal resolution and is scaled to fit
+	void Graphics::ResetRenderTargetAndViewport(uint16_t clientWidth, uint16_t clientHeight)
+	{
+		std::lock_guard<std::recursive_mutex> contextLock(ContextMutex);
+
+		//A minimized window has no client area, so keep the old buffers until it is restored
+		if (clientWidth == 0 || clientHeight == 0)
+		{
+			return;
+		}
+
+		//Remembered so the back buffer can be made again if the device is lost
+		BackBufferWidth = clientWidth;
+		BackBufferHeight = clientHeight;
+
+		//Unbind the current render target and release references, since the swap chain cannot resize while they exist
+		EndSpriteBatch();
+		DeviceContextPointer->OMSetRenderTargets(0, 0, 0);
+		RenderTargetPointer.Reset();
+		DeviceContextPointer->Flush();
+
+		HRESULT hr = SwapChainPointer->ResizeBuffers(0, clientWidth, clientHeight, DXGI_FORMAT_UNKNOWN, SwapChainFlags);
+		DX::ThrowIfFailed(hr);
+		
+		//Get texture resource from swap chain (back buffer)
+		wrl::ComPtr<ID3D11Texture2D> backBufferPointer;
+		hr = SwapChainPointer->GetBuffer(0, _uuidof(ID3D11Texture2D), &backBufferPointer);
+		DX::ThrowIfFailed(hr);
+
+		//Create render target
+		hr = DevicePointer->CreateRenderTargetView(
+			backBufferPointer.Get(),
+			nullptr,
+			&RenderTargetPointer
+		);
+		DX::ThrowIfFailed(hr);
+
+		UpdateSceneDestinationRectangle();
+		BindScene();
+	}
+
+	void Graphics::ResizeWindow(uint16_t clientWidth, uint16_t clientHeight)
+	{
+		std::lock_guard<std::recursive_mutex> contextLock(ContextMutex);
+
+		DXGI_MODE_DESC displayDescription = {};
+		displayDescription.Width = clientWidth;
+		displayDescription.Height = clientHeight;
+		displayDescription.RefreshRate.Numerator = 0;
+		displayDescription.RefreshRate.Denominator = 0;
+		displayDescription.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		displayDescription.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
+		displayDescription.Scaling = DXGI_MODE_SCALING_STRETCHED;
+		
+		//Resize the swap chain
+		HRESULT hr = SwapChainPointer->ResizeTarget(&displayDescription);
+		DX::ThrowIfFailed(hr);
+	}
+	
+	//Scaling functions--------------------------------------------------------------------------
+	void Graphics::SetScalingMode(ScalingModeClass scalingMode) noexcept
+	{
+		std::lock_guard<std::recursive_mutex> contextLock(ContextMutex);
+		ScalingMode = scalingMode;
+		UpdateSceneDestinationRectangle();
+	}
+
+	ScalingModeClass Graphics::GetScalingMode() const noexcept
+	{
+		return ScalingMode;
+	}
+
+	//Lowers the internal resolution while frames take longer than the budget, and raises it back when there is time to spare
+	void Graphics::EnableDynamicResolution(double frameBudgetMilliseconds, float minimumRenderScale)
+	{
+		if (frameBudgetMilliseconds <= 0 || minimumRenderScale <= 0.0f || minimumRenderScale > 1.0f)
+		{
+			throw std::invalid_argument("Graphics::EnableDynamicResolution() - budget must be positive and the minimum scale between 0 and 1");
+		}
+
+		std::lock_guard<std::recursive_mutex> contextLock(ContextMutex);
+		IsDynamicResolutionEnabled = true;
+		DynamicResolutionBudgetMilliseconds = frameBudgetMilliseconds;
+		MinimumRenderScale = minimumRenderScale;
+	}
+
+	void Graphics::DisableDynamicResolution() noexcept
+	{
+		std::lock_guard<std::recursive_mutex> contextLock(ContextMutex);
+		IsDynamicResolutionEnabled = false;
+		RenderScale = 1.0f;
+	}
+
+	float Graphics::GetRenderScale() const noexcept
+	{
+		return RenderScale;
+	}
+
+	//Maps a point in the client area to the internal resolution, through the same rectangle the scene is drawn to. Points on the
+	//letterbox bars map outside of the buffer
+	DirectX::XMINT2 Graphics::ClientToBuffer(DirectX::XMINT2 clientPosition) const noexcept
+	{
+		const LONG destinationWidth = SceneDestinationRectangle.right - SceneDestinationRectangle.left;
+		const LONG destinationHeight = SceneDestinationRectangle.bottom - SceneDestinationRectangle.top;
+		if (destinationWidth <= 0 || destinationHeight <= 0)
+		{
+			return clientPosition;
+		}
+
+		const double bufferX = static_cast<double>(clientPosition.x - SceneDestinationRectangle.left) * BufferWidth / destinationWidth;
+		const double bufferY = static_cast<double>(clientPosition.y - SceneDestinationRectangle.top) * BufferHeight / destinationHeight;
+		return DirectX::XMINT2(static_cast<int32_t>(std::floor(bufferX)), static_cast<int32_t>(std::floor(bufferY)));
+	}
+
+	//Frame latency functions--------------------------------------------------------------------
+
+	//Blocks until the swap chain can queue another frame. Calling this before reading input keeps the frame the input ends up in
+	//from waiting behind ones already queued, and lets the thread sleep instead of spinning on the clock
+	void Graphics::WaitForNextFrame()
+	{
+		if (IsWaitingForFrame || FrameLatencyWaitableObject == nullptr)
+		{
+			return;
+		}
+
+		std::chrono::steady_clock::time_point waitStartTime = std::chrono::steady_clock::now();
+		WaitForSingleObjectEx(FrameLatencyWaitableObject, 1000, TRUE);
+		FrameWaitEndTime = std::chrono::steady_clock::now();
+		IsWaitingForFrame = true;
+
+		FrameWaitCount++;
+		LatencyStatistics.LastWaitMilliseconds = std::chrono::duration<double, std::milli>(FrameWaitEndTime - waitStartTime).count();
+		TotalWaitMilliseconds += LatencyStatistics.LastWaitMilliseconds;
+		LatencyStatistics.AverageWaitMilliseconds = TotalWaitMilliseconds / static_cast<double>(FrameWaitCount);
+	}
+
+	//How many frames can be queued ahead of the display. 1 gives the least latency, higher values smooth out uneven frames
+	void Graphics::SetMaximumFrameLatency(uint32_t maximumFrameLatency)
+	{
+		if (maximumFrameLatency == 0 || maximumFrameLatency > DXGI_MAX_SWAP_CHAIN_BUFFERS)
+		{
+			throw std::invalid_argument(std::format("Graphics::SetMaximumFrameLatency() - {} is not between 1 and {}", maximumFrameLatency, DXGI_MAX_SWAP_CHAIN_BUFFERS));
+		}
+
+		std::lock_guard<std::recursive_mutex> contextLock(ContextMutex);
+		wrl::ComPtr<IDXGISwapChain2> swapChain2;
+		DX::ThrowIfFailed(SwapChainPointer.As(&swapChain2));
+		DX::ThrowIfFailed(swapChain2->SetMaximumFrameLatency(maximumFrameLatency));
+		LatencyStatistics.MaximumFrameLatency = maximumFrameLatency;
+	}
+
+	//Turning vertical sync off presents frames as soon as they are done, tearing if the display supports it
+	void Graphics::SetVerticalSync(bool isVerticalSyncEnabled) noexcept
+	{
+		LatencyStatistics.IsVerticalSyncEnabled = isVerticalSyncEnabled;
+	}
+
+	const FrameLatencyStatistics& Graphics::GetFrameLatencyStatistics() const noexcept
+	{
+		return LatencyStatistics;
+	}
+
+	void Graphics::ResetFrameLatencyStatistics() noexcept
+	{
+		FrameWaitCount = 0;
+		FramePresentCount = 0;
+		TotalWaitMilliseconds = 0;
+		TotalInputToPresentMilliseconds = 0;
+		LatencyStatistics.LastWaitMilliseconds = 0;
+		LatencyStatistics.AverageWaitMilliseconds = 0;
+		LatencyStatistics.LastInputToPresentMilliseconds = 0;
+		LatencyStatistics.AverageInputToPresentMilliseconds = 0;
+	}
+
+	//Device loss functions----------------------------------------------------------------------
+
+	//Makes the next Present act as if the GPU was removed, so the recovery path can be exercised without a driver crash
+	void Graphics::SimulateDeviceRemoved() noexcept
+	{
+		IsDeviceRemovalSimulated = true;
+	}
+
+	//When deferred, Present only flags a lost device and keeps returning false. The owner then calls RecoverLostDevice at a point
+	//where nothing is recording draws that point at the old textures
+	void Graphics::SetDeviceLostRecoveryDeferred(bool isDeviceLostRecoveryDeferred) noexcept
+	{
+		IsDeviceLostRecoveryDeferred = isDeviceLostRecoveryDeferred;
+	}
+
+	bool Graphics::IsDeviceLostPending() const noexcept
+	{
+		return IsRecoveryPending;
+	}
+
+	void Graphics::RecoverLostDevice()
+	{
+		std::lock_guard<std::recursive_mutex> contextLock(ContextMutex);
+		if (!IsRecoveryPending)
+		{
+			return;
+		}
+
+		HandleDeviceLost();
+		IsRecoveryPending = false;
+	}
+
+	//GPU timing functions-------------------------------------------------------------------------
+	void Graphics::SetGPUTiming(bool isGPUTimingEnabled)
+	{
+		std::unique_lock<std::recursive_mutex> contextLock = LockContext();
+		IsGPUTimingEnabled = isGPUTimingEnabled;
+		CreateGPUTimer();
+	}
+
+	bool Graphics::IsGPUTimingOn() const noexcept
+	{
+		return IsGPUTimingEnabled;
+	}
+
+	//While the GPU is timed, the sprite batch is ended at the edges of every pass, so the sprites are drawn within the pass that
+	//queued them. This costs a few extra draw calls, which is why timing is off by default
+	void Graphics::BeginGPUPass(const char* name, uint32_t index) noexcept
+	{
+		//Recording threads never touch the context, so only the passes of the thread that draws are timed
+		if (RecordingCommandList != nullptr)
+		{
+			return;
+		}
+
+		if (IsGPUTimingEnabled)
+		{
+			EndSpriteBatch();
+		}
+		GPUTimer->BeginPass(name, index);
+	}
+
+	void Graphics::EndGPUPass() noexcept
+	{
+		if (RecordingCommandList != nullptr)
+		{
+			return;
+		}
+
+		if (IsGPUTimingEnabled)
+		{
+			EndSpriteBatch();
+		}
+		GPUTimer->EndPass();
+	}
+
+	const GPUFrameTimings& Graphics::GetGPUFrameTimings() const noexcept
+	{
+		return GPUTimer->GetLastFrameTimings();
+	}
+
+	uint64_t Graphics::GetGPUFramesDropped() const noexcept
+	{
+		return GPUTimer->GetFramesDropped();
+	}
+
+	void Graphics::CreateGPUTimer()
+	{
+		if (IsGPUTimingEnabled)
+		{
+			GPUTimer = std::make_unique<D3D11GPUTimer>(DevicePointer.Get(), DeviceContextPointer.Get());
+		}
+		else
+		{
+			GPUTimer = std::make_unique<NullGPUTimer>();
+		}
+	}
+
+	//Threading functions------------------------------------------------------------------------
+
+	//The immediate context can only be used by one thread at a time. A thread that draws and presents holds this for the whole
+	//frame, and everything else here that touches the context, such as loading textures or baking outlines, takes it as well
+	std::unique_lock<std::recursive_mutex> Graphics::LockContext()
+	{
+		return std::unique_lock<std::recursive_mutex>(ContextMutex);
+	}
+
+	//Layer cache functions----------------------------------------------------------------------
+
+	//Points all drawing at the offscreen texture of the given layer and clears it, until EndLayerCache is called
+	void Graphics::BeginLayerCache(size_t layer)
+	{
+		EndSpriteBatch();
+
+		//Layer caches are made on first use, at the size of the buffer
+		if (LayerCaches.size() <= layer)
+		{
+			LayerCaches.resize(layer + 1);
+		}
+
+		LayerCache& layerCache = LayerCaches[layer];
+		if (!layerCache.RenderTarget)
+		{
+			CD3D11_TEXTURE2D_DESC cacheDescription(DXGI_FORMAT_R8G8B8A8_UNORM, BufferWidth, BufferHeight, 1, 1, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+			wrl::ComPtr<ID3D11Texture2D> cacheResource;
+			DX::ThrowIfFailed(DevicePointer->CreateTexture2D(&cacheDescription, nullptr, &cacheResource));
+			DX::ThrowIfFailed(DevicePointer->CreateRenderTargetView(cacheResource.Get(), nullptr, &layerCache.RenderTarget));
+			DX::ThrowIfFailed(DevicePointer->CreateShaderResourceView(cacheResource.Get(), nullptr, &layerCache.Texture));
+		}
+
+		//The cache is drawn to at the same resolution as the scene, so it lines up when composited
+		const float clearColour[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		DeviceContextPointer->ClearRenderTargetView(layerCache.RenderTarget.Get(), clearColour);
+		DeviceContextPointer->OMSetRenderTargets(1u, layerCache.RenderTarget.GetAddressOf(), nullptr);
+		RECT sceneRectangle = GetSceneRectangle();
+		CD3D11_VIEWPORT cacheViewport(0.0f, 0.0f, static_cast<float>(sceneRectangle.right), static_cast<float>(sceneRectangle.bottom));
+		DeviceContextPointer->RSSetViewports(1u, &cacheViewport);
+
+		IsDrawingToLayerCache = true;
+	}
+
+	void Graphics::EndLayerCache()
+	{
+		if (!IsDrawingToLayerCache)
+		{
+			return;
+		}
+
+		//Submit what was drawn to the cache and point back at the scene
+		EndSpriteBatch();
+		BindScene();
+		IsDrawingToLayerCache = false;
+	}
+
+	//Composites the cached layers onto the scene, from layer 0 up
+	void Graphics::DrawLayerCaches(size_t layerCount)
+	{
+		EndLayerCache();
+		EndSpriteBatch();
+
+		//The caches hold premultiplied colour, so they are blended with the premultiplied state
+		//Only the part of each cache the scene resolution covers was drawn to, and it is stretched back over the whole buffer
+		RECT sceneRectangle = GetSceneRectangle();
+		RECT bufferRectangle = { 0, 0, BufferWidth, BufferHeight };
+		SpriteBatchPointer->Begin(DirectX::SpriteSortMode_Deferred, SpriteBatchStatesPointer->AlphaBlend());
+		for (size_t layer = 0; layer < layerCount && layer < LayerCaches.size(); layer++)
+		{
+			if (LayerCaches[layer].Texture)
+			{
+				SpriteBatchPointer->Draw(LayerCaches[layer].Texture.Get(), bufferRectangle, &sceneRectangle);
+			}
+		}
+		SpriteBatchPointer->End();
+	}
+
+	void Graphics::ReleaseLayerCaches() noexcept
+	{
+		//The render thread may be drawing from the caches
+		std::lock_guard<std::recursive_mutex> contextLock(ContextMutex);
+		LayerCaches.clear();
+	}
+
+	//Blocks until the next vertical blank, for frames that have nothing new to present
+	void Graphics::WaitForVerticalBlank()
+	{
+		wrl::ComPtr<IDXGIOutput> output;
+		if (SUCCEEDED(SwapChainPointer->GetContainingOutput(&output)))
+		{
+			DX::ThrowIfFailed(output->WaitForVBlank());
+		}
+		else
+		{
+			//The window is not on any output (minimized or moving between monitors), so just give up the time slice for a frame
+			Sleep(1000 / FrameRate);
+		}
+	}
+
+	//Command recording functions-----------------------------------------------------------------
+
+	//Until EndCommandRecording, every draw made on the calling thread is recorded into the list instead of drawn
+	void Graphics::BeginCommandRecording(RenderCommandList& commandList) noexcept
+	{
+		RecordingCommandList = &commandList;
+	}
+
+	void Graphics::EndCommandRecording() noexcept
+	{
+		RecordingCommandList = nullptr;
+	}
+
+	//Draws a recorded list. Must be called on the render thread
+	void Graphics::SubmitCommandList(const RenderCommandList& commandList, bool sortByState)
+	{
+		const std::vector<SpriteCommand>& commands = commandList.GetCommands();
+		SubmitOrder.resize(commands.size());
+		std::iota(SubmitOrder.begin(), SubmitOrder.end(), 0u);
+
+		//Grouping sprites by shader and texture lets the batch draw each group in one call. The sort is stable, so sprites that
+		//share a texture and shader keep their order, but sprites with different ones may swap which is on top
+		if (sortByState)
+		{
+			std::stable_sort(SubmitOrder.begin(), SubmitOrder.end(), [&commands](uint32_t left, uint32_t right)
+				{
+					const SpriteCommand& leftCommand = commands[left];
+					const SpriteCommand& rightCommand = commands[right];
+					return std::tie(leftCommand.SpriteShader, leftCommand.TextureAlpha, leftCommand.OutlineThreshold, leftCommand.OutlineColour.x, leftCommand.OutlineColour.y, leftCommand.OutlineColour.z, leftCommand.OutlineColour.w, leftCommand.Texture) <
+						std::tie(rightCommand.SpriteShader, rightCommand.TextureAlpha, rightCommand.OutlineThreshold, rightCommand.OutlineColour.x, rightCommand.OutlineColour.y, rightCommand.OutlineColour.z, rightCommand.OutlineColour.w, rightCommand.Texture);
+				});
+		}
+
+		for (uint32_t commandIndex : SubmitOrder)
+		{
+			ExecuteSpriteCommand(commands[commandIndex]);
+		}
+	}
+
+	//Layer state functions-----------------------------------------------------------------------
+
+	//Sets the sort mode and blending used by every sprite drawn after this, until it is set again
+	void Graphics::SetLayerRenderState(const LayerRenderState& layerRenderState) noexcept
+	{
+		if (layerRenderState == ActiveLayerRenderState)
+		{
+			return;
+		}
+
+		//A batch only has one sort mode and blend state, so the sprites already queued have to be drawn with the old ones
+		EndSpriteBatch();
+		ActiveLayerRenderState = layerRenderState;
+	}
+
+	//Sets the depth of every sprite drawn on the calling thread after this. Only used by BackToFront and FrontToBack layers
+	void Graphics::SetSpriteLayerDepth(float layerDepth) noexcept
+	{
+		CurrentLayerDepth = layerDepth;
+	}
+
+	//Sprite batch functions-----------------------------------------------------------------------
+	void Graphics::DrawFullSprite(ID3D11ShaderResourceView* texture, DirectX::SimpleMath::Vector2 position, TextureAlphaClass textureAlpha)
+	{
+		SpriteCommand spriteCommand;
+		spriteCommand.Texture = texture;
+		spriteCommand.TextureAlpha = textureAlpha;
+		spriteCommand.Colour = DirectX::Colors::White.v;
+		spriteCommand.Position = position;
+		DrawSprite(spriteCommand);
+	}
+
+	void Graphics::DrawSizedSprite(ID3D11ShaderResourceView* texture, DirectX::SimpleMath::Vector2 position, DirectX::SimpleMath::Vector2 size, TextureAlphaClass textureAlpha)
+	{
+		SpriteCommand spriteCommand;
+		spriteCommand.Texture = texture;
+		spriteCommand.TextureAlpha = textureAlpha;
+		spriteCommand.Colour = DirectX::Colors::White.v;
+		spriteCommand.HasDestinationRectangle = true;
+		spriteCommand.DestinationRectangle.left = static_cast<LONG>(position.x);
+		spriteCommand.DestinationRectangle.right = static_cast<LONG>(position.x + size.x);
+		spriteCommand.DestinationRectangle.top = static_cast<LONG>(position.y);
+		spriteCommand.DestinationRectangle.bottom = static_cast<LONG>(position.y + size.y);
+		DrawSprite(spriteCommand);
+	}
+
+	//Font drawing functions-----------------------------------------------------------------------
+	void Graphics::DrawString(DirectX::SpriteFont* spriteFont, std::wstring text, DirectX::SimpleMath::Vector2 positionCoord, DirectX::SimpleMath::Vector2 origin, DirectX::SimpleMath::Color colour, bool dropShadow)
+	{
+		//Baking an outline atlas needs the device context, which a recording thread cannot touch. So while recording,
+		//the string is laid out plainly and the shadow is drawn as a second copy of it, one pixel down and to the right
+		if (RecordingCommandList != nullptr)
+		{
+			GlyphRun plainGlyphRun;
+			BuildGlyphRun(spriteFont, text, plainGlyphRun);
+
+			if (dropShadow)
+			{
+				DirectX::SimpleMath::Color shadowColour = DirectX::SimpleMath::Color(colour);
+				shadowColour.Negate();
+				DrawGlyphRun(spriteFont, plainGlyphRun, positionCoord + DirectX::SimpleMath::Vector2(1, 1), origin, shadowColour);
+			}
+
+			DrawGlyphRun(spriteFont, plainGlyphRun, positionCoord, origin, colour);
+			return;
+		}
+
+		if (dropShadow)
+		{
+			//Lay the string out against a one pixel outline atlas, so the shadow costs no extra sprites
+			GlyphRun shadowedGlyphRun;
+			BuildGlyphRun(spriteFont, text, shadowedGlyphRun, TextOutlineDesc{ .Width = 1 });
+
+			//Take the negation of the font colour and use that as its drop shadow colour
+			DirectX::SimpleMath::Color shadowColour = DirectX::SimpleMath::Color(colour);
+			shadowColour.Negate();
+
+			DrawGlyphRun(spriteFont, shadowedGlyphRun, positionCoord, origin, colour, shadowColour);
+			return;
+		}
+
+		//Drawn straight into the batch, so the tint is premultiplied here the same way ExecuteSpriteCommand does it for plain sprites
+		if (ActiveLayerRenderState.Blend != SpriteBlendClass::NonPremultiplied)
+		{
+			colour = DirectX::SimpleMath::Color(colour.x * colour.w, colour.y * colour.w, colour.z * colour.w, colour.w);
+		}
+
+		BeginSpriteBatch();
+		spriteFont->DrawString(SpriteBatchPointer.get(), text.c_str(), positionCoord, colour, 0, origin, 1.0f, DirectX::SpriteEffects_None, CurrentLayerDepth);
+	}
+
+	void Graphics::DrawGlyphRun(DirectX::SpriteFont* spriteFont, const GlyphRun& glyphRun, DirectX::SimpleMath::Vector2 positionCoord, DirectX::SimpleMath::Vector2 origin, DirectX::SimpleMath::Color colour, DirectX::SimpleMath::Color outlineColour)
+	{
+		//Outlined runs sample the outline atlas with the outline shader, everything else samples the font's sprite sheet
+		SpriteCommand spriteCommand;
+		spriteCommand.Colour = colour;
+		spriteCommand.HasSourceRectangle = true;
+		if (glyphRun.OutlineAtlas)
+		{
+			spriteCommand.SpriteShader = SpriteShaderClass::OutlinedText;
+			spriteCommand.OutlineColour = outlineColour;
+			spriteCommand.Texture = glyphRun.OutlineAtlas->GetTexture();
+		}
+		else
+		{
+			spriteCommand.Texture = spriteFont->GetSpriteSheet();
+		}
+
+		//The quads are already laid out, so each glyph is just a sprite at its precomputed offset
+		DirectX::SimpleMath::Vector2 topLeft = positionCoord - origin;
+		for (const GlyphRun::GlyphQuad& quad : glyphRun.Quads)
+		{
+			spriteCommand.Position = topLeft + quad.Offset;
+			spriteCommand.SourceRectangle = quad.SourceRectangle;
+			DrawSprite(spriteCommand);
+		}
+	}
+
+	void Graphics::DrawGlyphRun(SDFFont* sdfFont, const GlyphRun& glyphRun, DirectX::SimpleMath::Vector2 positionCoord, DirectX::SimpleMath::Vector2 origin, DirectX::SimpleMath::Color colour, DirectX::SimpleMath::Color outlineColour)
+	{
+		//Runs laid out without an outline leave the threshold on the edge, where an outline would only bleed through the anti aliasing
+		if (glyphRun.OutlineThreshold >= 0.5f)
+		{
+			outlineColour = DirectX::SimpleMath::Color(0, 0, 0, 0);
+		}
+
+		//Every glyph is scaled from the one atlas, and the shader keeps the edges sharp
+		SpriteCommand spriteCommand;
+		spriteCommand.Texture = sdfFont->GetTexture();
+		spriteCommand.SpriteShader = SpriteShaderClass::DistanceFieldText;
+		spriteCommand.Colour = colour;
+		spriteCommand.OutlineColour = outlineColour;
+		spriteCommand.OutlineThreshold = glyphRun.OutlineThreshold;
+		spriteCommand.Scale = DirectX::SimpleMath::Vector2(glyphRun.Scale, glyphRun.Scale);
+		spriteCommand.HasSourceRectangle = true;
+
+		DirectX::SimpleMath::Vector2 topLeft = positionCoord - origin;
+		for (const GlyphRun::GlyphQuad& quad : glyphRun.Quads)
+		{
+			spriteCommand.Position = topLeft + quad.Offset;
+			spriteCommand.SourceRectangle = quad.SourceRectangle;
+			DrawSprite(spriteCommand);
+		}
+	}
+
+	//Font layout functions------------------------------------------------------------------------
+
+	//Walks the string the same way SpriteFont::DrawString, MeasureString and MeasureDrawBounds do, but only once
+	void Graphics::BuildGlyphRun(DirectX::SpriteFont* spriteFont, const std::wstring& text, GlyphRun& glyphRun, std::optional<TextOutlineDesc> outlineDescription)
+	{
+		glyphRun.Quads.clear();
+		glyphRun.Quads.reserve(text.size());
+		glyphRun.Size = spriteFont->MeasureString(text.c_str(), false);
+		glyphRun.Scale = 1.0f;
+		glyphRun.OutlineThreshold = 0.5f;
+
+		//Outlined runs take their glyphs from the padded outline atlas instead of the sprite sheet
+		glyphRun.OutlineAtlas = outlineDescription ? GetOutlinedFontAtlas(spriteFont, *outlineDescription) : nullptr;
+		const float outlinePadding = glyphRun.OutlineAtlas ? static_cast<float>(glyphRun.OutlineAtlas->GetPadding()) : 0.0f;
+
+		const float lineSpacing = spriteFont->GetLineSpacing();
+		float x = 0;
+		float y = 0;
+		float boundsLeft = FLT_MAX;
+		float boundsTop = FLT_MAX;
+		float boundsRight = 0;
+		float boundsBottom = 0;
+
+		for (wchar_t character : text)
+		{
+			//Skip carriage returns and move down a line on new lines
+			if (character == L'\r')
+			{
+				continue;
+			}
+
+			if (character == L'\n')
+			{
+				x = 0;
+				y += lineSpacing;
+				continue;
+			}
+
+			const DirectX::SpriteFont::Glyph* glyph = spriteFont->FindGlyph(character);
+			x += glyph->XOffset;
+			if (x < 0)
+			{
+				x = 0;
+			}
+
+			const float glyphWidth = static_cast<float>(glyph->Subrect.right - glyph->Subrect.left);
+			const float glyphHeight = static_cast<float>(glyph->Subrect.bottom - glyph->Subrect.top);
+			const float advance = glyphWidth + glyph->XAdvance;
+			const bool isWhitespace = iswspace(character);
+
+			//Bounds include whitespace, to match what the text used to measure
+			const float glyphLeft = x;
+			const float glyphTop = y + (isWhitespace ? 0.0f : glyph->YOffset);
+			boundsLeft = std::min(boundsLeft, glyphLeft);
+			boundsTop = std::min(boundsTop, glyphTop);
+			boundsRight = std::max(boundsRight, glyphLeft + std::max(advance, glyphWidth));
+			boundsBottom = std::max(boundsBottom, glyphTop + (isWhitespace ? lineSpacing : glyphHeight));
+
+			//Only visible glyphs need a quad
+			if (!isWhitespace || glyphWidth > 1 || glyphHeight > 1)
+			{
+				glyphRun.Quads.push_back(
+					{
+						.SourceRectangle = glyphRun.OutlineAtlas ? glyphRun.OutlineAtlas->GetGlyphRectangle(static_cast<wchar_t>(glyph->Character)) : glyph->Subrect,
+						.Offset = DirectX::SimpleMath::Vector2(x - outlinePadding, y + glyph->YOffset - outlinePadding)
+					});
+			}
+
+			x += advance;
+		}
+
+		//If there were no glyphs at all, the bounds are empty
+		if (boundsLeft == FLT_MAX)
+		{
+			glyphRun.Bounds = DirectX::SimpleMath::Rectangle(0, 0, 0, 0);
+			return;
+		}
+
+		glyphRun.Bounds = DirectX::SimpleMath::Rectangle(
+			static_cast<long>(boundsLeft),
+			static_cast<long>(boundsTop),
+			static_cast<long>(boundsRight) - static_cast<long>(boundsLeft),
+			static_cast<long>(boundsBottom) - static_cast<long>(boundsTop));
+	}
+
+	//Distance field glyphs are padded by the field, so the bounds are taken from the pen and line boxes rather than the quads
+	void Graphics::BuildGlyphRun(SDFFont* sdfFont, const std::wstring& text, float fontSize, GlyphRun& glyphRun, std::optional<float> outlineWidth)
+	{
+		glyphRun.Quads.clear();
+		glyphRun.Quads.reserve(text.size());
+		glyphRun.OutlineAtlas = nullptr;
+		glyphRun.Scale = fontSize / sdfFont->GetBaseSize();
+
+		//The field maps DistanceRange base pixels either side of the edge onto 0 to 1, so an outline can be at most that wide
+		glyphRun.OutlineThreshold = 0.5f;
+		if (outlineWidth)
+		{
+			float outlineInBasePixels = std::min(*outlineWidth / glyphRun.Scale, sdfFont->GetDistanceRange());
+			glyphRun.OutlineThreshold = 0.5f - outlineInBasePixels / (2.0f * sdfFont->GetDistanceRange());
+		}
+
+		const float lineSpacing = sdfFont->GetLineSpacing() * glyphRun.Scale;
+		float x = 0;
+		float y = 0;
+		float width = 0;
+		bool hasGlyphs = false;
+
+		for (wchar_t character : text)
+		{
+			//Skip carriage returns and move down a line on new lines
+			if (character == L'\r')
+			{
+				continue;
+			}
+
+			if (character == L'\n')
+			{
+				x = 0;
+				y += lineSpacing;
+				continue;
+			}
+
+			const SDFFont::Glyph* glyph = sdfFont->FindGlyph(character);
+			hasGlyphs = true;
+
+			//Only visible glyphs need a quad
+			if (!iswspace(character) && glyph->Subrect.right > glyph->Subrect.left)
+			{
+				glyphRun.Quads.push_back(
+					{
+						.SourceRectangle = glyph->Subrect,
+						.Offset = DirectX::SimpleMath::Vector2(x + glyph->XOffset * glyphRun.Scale, y + glyph->YOffset * glyphRun.Scale)
+					});
+			}
+
+			x += glyph->XAdvance * glyphRun.Scale;
+			width = std::max(width, x);
+		}
+
+		glyphRun.Size = DirectX::SimpleMath::Vector2(width, y + lineSpacing);
+		if (!hasGlyphs)
+		{
+			glyphRun.Size = DirectX::SimpleMath::Vector2(0, 0);
+		}
+
+		glyphRun.Bounds = DirectX::SimpleMath::Rectangle(0, 0, static_cast<long>(std::ceil(glyphRun.Size.x)), static_cast<long>(std::ceil(glyphRun.Size.y)));
+	}
+
+	//Texture Loader-------------------------------------------------------------------------------
+	
+	//Textures are shared while anything still holds them, and are kept track of so they can be loaded again if the device is lost
+	void Graphics::LoadTexture(const std::wstring& filePath, std::shared_ptr<Texture>& texture, TextureAlphaClass textureAlpha)
+	{
+		//Counts textures from when they are created until the last thing holding them lets go
+		static Gauge& texturesLoaded = MetricsRegistry::GetGauge("Graphics.TexturesLoaded");
+
+		std::lock_guard<std::recursive_mutex> contextLock(ContextMutex);
+		auto textureKey = std::make_pair(filePath, textureAlpha);
+		texture = TextureMap[textureKey].lock();
+		if (!texture)
+		{
+			//Forget the textures nothing holds any more, so the map does not keep growing
+			std::erase_if(TextureMap, [](const auto& textureEntry) { return textureEntry.second.expired(); });
+
+			texture = std::shared_ptr<Texture>(new Texture(), [](Texture* releasedTexture)
+				{
+					texturesLoaded.Add(-1);
+					delete releasedTexture;
+				});
+			texturesLoaded.Add(1);
+
+			texture->FilePath = filePath;
+			texture->TextureAlpha = textureAlpha;
+			CreateTextureFromFile(*texture);
+			TextureMap[textureKey] = texture;
+		}
+	}
+
+	//Font Loader----------------------------------------------------------------------------------
+	void Graphics::LoadFont(const std::wstring& spriteFontPath, std::weak_ptr<DirectX::SpriteFont>& spriteFont)
+	{
+		std::lock_guard<std::recursive_mutex> contextLock(ContextMutex);
+		if (!FontMap.contains(spriteFontPath))
+		{
+			FontMap[spriteFontPath] = std::make_shared<DirectX::SpriteFont>(DevicePointer.Get(), spriteFontPath.c_str());
+			DIVERGENCE_LOG_DEBUG(L"Font loaded from file: {}", spriteFontPath);
+		}
+
+		spriteFont = FontMap[spriteFontPath];
+	}
+
+	void Graphics::LoadSDFFont(const std::wstring& sdfFontPath, std::weak_ptr<SDFFont>& sdfFont)
+	{
+		//One distance field atlas serves every size of a face, so it is only ever loaded once
+		std::lock_guard<std::recursive_mutex> contextLock(ContextMutex);
+		if (!SDFFontMap.contains(sdfFontPath))
+		{
+			SDFFontMap[sdfFontPath] = std::make_shared<SDFFont>(DevicePointer.Get(), sdfFontPath);
+		}
+
+		sdfFont = SDFFontMap[sdfFontPath];
+	}
+
+	//Helpers--------------------------------------------------------------------------------------
+	thread_local RenderCommandList* Graphics::RecordingCommandList = nullptr;
+	thread_local float Graphics::CurrentLayerDepth = 0.0f;
+
+	void Graphics::DrawSprite(SpriteCommand spriteCommand)
+	{
+		spriteCommand.LayerDepth = CurrentLayerDepth;
+
+		if (RecordingCommandList != nullptr)
+		{
+			RecordingCommandList->Record(spriteCommand);
+			return;
+		}
+
+		ExecuteSpriteCommand(spriteCommand);
+	}
+
+	void Graphics::ExecuteSpriteCommand(const SpriteCommand& spriteCommand)
+	{
+		//Plain sprites in a premultiplied layer need a premultiplied tint, and straight alpha textures are premultiplied as they are sampled.
+		//The text shaders take straight colours and premultiply their own output
+		SpriteShaderClass spriteShader = spriteCommand.SpriteShader;
+		DirectX::SimpleMath::Color colour = spriteCommand.Colour;
+		if (ActiveLayerRenderState.Blend != SpriteBlendClass::NonPremultiplied && spriteShader == SpriteShaderClass::Default)
+		{
+			colour = DirectX::SimpleMath::Color(colour.x * colour.w, colour.y * colour.w, colour.z * colour.w, colour.w);
+			if (spriteCommand.TextureAlpha == TextureAlphaClass::Straight)
+			{
+				spriteShader = SpriteShaderClass::StraightAlphaSprite;
+			}
+		}
+
+		BeginSpriteBatch(spriteShader, spriteCommand.OutlineColour, spriteCommand.OutlineThreshold);
+
+		//In deferred and immediate layers, every change of texture within a batch is another draw call
+		static Counter& spritesDrawn = MetricsRegistry::GetCounter("Graphics.SpritesDrawn");
+		static Counter& textureChanges = MetricsRegistry::GetCounter("Graphics.TextureChanges");
+		spritesDrawn.Add();
+		if (spriteCommand.Texture != LastBatchTexture)
+		{
+			textureChanges.Add();
+			LastBatchTexture = spriteCommand.Texture;
+		}
+
+		const RECT* sourceRectangle = spriteCommand.HasSourceRectangle ? &spriteCommand.SourceRectangle : nullptr;
+		if (spriteCommand.HasDestinationRectangle)
+		{
+			SpriteBatchPointer->Draw(spriteCommand.Texture, spriteCommand.DestinationRectangle, sourceRectangle, colour, 0.0f, DirectX::SimpleMath::Vector2(0, 0), DirectX::SpriteEffects_None, spriteCommand.LayerDepth);
+		}
+		else
+		{
+			SpriteBatchPointer->Draw(spriteCommand.Texture, spriteCommand.Position, sourceRectangle, colour, 0.0f, DirectX::SimpleMath::Vector2(0, 0), spriteCommand.Scale, DirectX::SpriteEffects_None, spriteCommand.LayerDepth);
+		}
+	}
+
+	ID3D11BlendState* Graphics::GetSpriteBlendState() const noexcept
+	{
+		//Layer caches start out transparent, so straight alpha sprites need a blend state that keeps the cache's alpha correct
+		switch (ActiveLayerRenderState.Blend)
+		{
+		case SpriteBlendClass::Premultiplied:
+			return SpriteBatchStatesPointer->AlphaBlend();
+
+		case SpriteBlendClass::Additive:
+			return AdditiveBlendStatePointer.Get();
+
+		case SpriteBlendClass::Opaque:
+			return SpriteBatchStatesPointer->Opaque();
+
+		default:
+			return IsDrawingToLayerCache ? LayerCacheBlendStatePointer.Get() : SpriteBatchStatesPointer->NonPremultiplied();
+		}
+	}
+
+	ID3D11PixelShader* Graphics::GetSpritePixelShader(SpriteShaderClass spriteShader) const noexcept
+	{
+		switch (spriteShader)
+		{
+		case SpriteShaderClass::OutlinedText:
+			return OutlinedTextPixelShaderPointer.Get();
+
+		case SpriteShaderClass::DistanceFieldText:
+			return DistanceFieldTextPixelShaderPointer.Get();
+
+		case SpriteShaderClass::StraightAlphaSprite:
+			return StraightAlphaSpritePixelShaderPointer.Get();
+
+		default:
+			return nullptr;
+		}
+	}
+
+	void Graphics::BeginSpriteBatch(SpriteShaderClass spriteShader, DirectX::SimpleMath::Color outlineColour, float outlineThreshold) noexcept
+	{
+		//A batch only has one pixel shader and set of text parameters, so restart it if any of them change
+		bool isTextShader = spriteShader == SpriteShaderClass::OutlinedText || spriteShader == SpriteShaderClass::DistanceFieldText;
+		if (IsSpriteBatchDrawing && (spriteShader != ActiveSpriteShader || (isTextShader && (outlineColour != ActiveOutlineColour || outlineThreshold != ActiveOutlineThreshold))))
+		{
+			EndSpriteBatch();
+		}
+
+		if (!IsSpriteBatchDrawing)
+		{
+			ActiveSpriteShader = spriteShader;
+			ID3D11BlendState* spriteBlendState = GetSpriteBlendState();
+
+			if (isTextShader)
+			{
+				ActiveOutlineColour = outlineColour;
+				ActiveOutlineThreshold = outlineThreshold;
+				TextShaderParameters textParameters = {};
+				textParameters.OutlineColour = ActiveOutlineColour;
+				textParameters.OutlineThreshold = ActiveOutlineThreshold;
+				textParameters.OutputPremultiplied = ActiveLayerRenderState.Blend == SpriteBlendClass::NonPremultiplied ? 0.0f : 1.0f;
+				DeviceContextPointer->UpdateSubresource(OutlineConstantBufferPointer.Get(), 0, nullptr, &textParameters, 0, 0);
+			}
+
+			if (spriteShader == SpriteShaderClass::Default)
+			{
+				SpriteBatchPointer->Begin(ActiveLayerRenderState.SortMode, spriteBlendState);
+			}
+			else
+			{
+				ID3D11PixelShader* spritePixelShader = GetSpritePixelShader(spriteShader);
+				SpriteBatchPointer->Begin(ActiveLayerRenderState.SortMode, spriteBlendState, nullptr, nullptr, nullptr, [this, spritePixelShader, isTextShader]()
+					{
+						DeviceContextPointer->PSSetShader(spritePixelShader, nullptr, 0);
+						if (isTextShader)
+						{
+							DeviceContextPointer->PSSetConstantBuffers(0, 1, OutlineConstantBufferPointer.GetAddressOf());
+						}
+					});
+			}
+
+			IsSpriteBatchDrawing = true;
+		}
+	}
+
+	void Graphics::EndSpriteBatch() noexcept
+	{
+		if (IsSpriteBatchDrawing)
+		{
+			static Counter& spriteBatches = MetricsRegistry::GetCounter("Graphics.SpriteBatches");
+			Profiler::Zone profileZone("Graphics::EndSpriteBatch");
+			SpriteBatchPointer->End();
+			IsSpriteBatchDrawing = false;
+			LastBatchTexture = nullptr;
+			spriteBatches.Add();
+		}
+	}
+
+	//Decodes the file to RGBA and, unless asked for straight alpha, premultiplies it on the CPU before it is uploaded. Mipmaps are then
+	//averaged from premultiplied texels, which is what stops dark fringes appearing around scaled sprites
+	void Graphics::CreateTextureFromFile(Texture& texture)
+	{
+		//Decode into a staging texture, which the CPU can read and write
+		wrl::ComPtr<ID3D11Resource> stagingResource;
+		DX::ThrowIfFailed(DirectX::CreateWICTextureFromFileEx(DevicePointer.Get(), texture.FilePath.c_str(), 0, D3D11_USAGE_STAGING, 0, D3D11_CPU_ACCESS_READ | D3D11_CPU_ACCESS_WRITE, 0, DirectX::WIC_LOADER_FORCE_RGBA32, &stagingResource, nullptr));
+
+		wrl::ComPtr<ID3D11Texture2D> stagingTexture;
+		DX::ThrowIfFailed(stagingResource.As(&stagingTexture));
+		D3D11_TEXTURE2D_DESC stagingDescription;
+		stagingTexture->GetDesc(&stagingDescription);
+
+		D3D11_MAPPED_SUBRESOURCE mappedTexture;
+		DX::ThrowIfFailed(DeviceContextPointer->Map(stagingTexture.Get(), 0, D3D11_MAP_READ_WRITE, 0, &mappedTexture));
+		if (texture.TextureAlpha == TextureAlphaClass::Premultiplied)
+		{
+			for (UINT row = 0; row < stagingDescription.Height; row++)
+			{
+				uint8_t* texel = static_cast<uint8_t*>(mappedTexture.pData) + static_cast<size_t>(row) * mappedTexture.RowPitch;
+				for (UINT column = 0; column < stagingDescription.Width; column++, texel += 4)
+				{
+					const uint32_t alpha = texel[3];
+					texel[0] = static_cast<uint8_t>((texel[0] * alpha + 127) / 255);
+					texel[1] = static_cast<uint8_t>((texel[1] * alpha + 127) / 255);
+					texel[2] = static_cast<uint8_t>((texel[2] * alpha + 127) / 255);
+				}
+			}
+		}
+
+		//Create the texture that is actually sampled. Generating mipmaps needs it to be a render target
+		texture.Description = CD3D11_TEXTURE2D_DESC(DXGI_FORMAT_R8G8B8A8_UNORM, stagingDescription.Width, stagingDescription.Height, 1, 0,
+			D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET, D3D11_USAGE_DEFAULT, 0, 1, 0, D3D11_RESOURCE_MISC_GENERATE_MIPS);
+		wrl::ComPtr<ID3D11Texture2D> textureResource;
+		HRESULT hr = DevicePointer->CreateTexture2D(&texture.Description, nullptr, &textureResource);
+		if (FAILED(hr))
+		{
+			DeviceContextPointer->Unmap(stagingTexture.Get(), 0);
+			DX::ThrowIfFailed(hr);
+		}
+
+		DeviceContextPointer->UpdateSubresource(textureResource.Get(), 0, nullptr, mappedTexture.pData, mappedTexture.RowPitch, 0);
+		DeviceContextPointer->Unmap(stagingTexture.Get(), 0);
+
+		DX::ThrowIfFailed(DevicePointer->CreateShaderResourceView(textureResource.Get(), nullptr, texture.ShaderResourceView.ReleaseAndGetAddressOf()));
+		DeviceContextPointer->GenerateMips(texture.ShaderResourceView.Get());
+
+		//Report the mip count that was actually made
+		textureResource->GetDesc(&texture.Description);
+	}
+
+	//Creates the device, swap chain, and everything that only depends on them
+	void Graphics::CreateDeviceResources()
+	{
+		//Tearing has to be asked for when the swap chain is made, and only some systems support it
+		BOOL isTearingSupported = FALSE;
+		wrl::ComPtr<IDXGIFactory5> factory5;
+		if (SUCCEEDED(CreateDXGIFactory1(IID_PPV_ARGS(&factory5))))
+		{
+			if (FAILED(factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &isTearingSupported, sizeof(isTearingSupported))))
+			{
+				isTearingSupported = FALSE;
+			}
+		}
+		LatencyStatistics.IsTearingSupported = isTearingSupported == TRUE;
+		SwapChainFlags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+		if (LatencyStatistics.IsTearingSupported)
+		{
+			SwapChainFlags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+		}
+
 		//Create device, swap chain, and device context
 		DXGI_SWAP_CHAIN_DESC swapChainDescription = {};
-		swapChainDescription.BufferDesc.Width = bufferWidth;
-		swapChainDescription.BufferDesc.Height = bufferHeight;
+		swapChainDescription.BufferDesc.Width = BufferWidth;
+		swapChainDescription.BufferDesc.Height = BufferHeight;
 		swapChainDescription.BufferDesc.RefreshRate.Numerator = 0;
 		swapChainDescription.BufferDesc.RefreshRate.Denominator = 0;
 		swapChainDescription.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
@@ -26,11 +1119,11 @@ namespace DivergenceEngine
 		swapChainDescription.SampleDesc.Count = 1;
 		swapChainDescription.SampleDesc.Quality = 0;
 		swapChainDescription.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-		swapChainDescription.BufferCount = 2;
-		swapChainDescription.OutputWindow = windowHandle;
+		swapChainDescription.BufferCount = SWAP_CHAIN_BUFFER_COUNT;
+		swapChainDescription.OutputWindow = WindowHandle;
 		swapChainDescription.Windowed = TRUE;
 		swapChainDescription.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
-		swapChainDescription.Flags = 0;
+		swapChainDescription.Flags = SwapChainFlags;
 
 		//Check if debug mode
 		UINT swapCreateFlags = 0u;
@@ -54,195 +1147,279 @@ namespace DivergenceEngine
 		);
 		DX::ThrowIfFailed(hr);
 
-		//Get texture resource from swap chain (back buffer)
-		wrl::ComPtr<ID3D11Texture2D> backBufferPointer;
-		hr = SwapChainPointer->GetBuffer(0, _uuidof(ID3D11Texture2D), &backBufferPointer);
-		DX::ThrowIfFailed(hr);
-		
-		//Create render target
-		hr = DevicePointer->CreateRenderTargetView(
-			backBufferPointer.Get(),
-			nullptr,
-			&RenderTargetPointer
-		);
-		DX::ThrowIfFailed(hr);
+		//Only queue one frame ahead of the display unless asked otherwise, and keep hold of the object that says when another can be queued
+		wrl::ComPtr<IDXGISwapChain2> swapChain2;
+		DX::ThrowIfFailed(SwapChainPointer.As(&swapChain2));
+		if (LatencyStatistics.MaximumFrameLatency == 0)
+		{
+			LatencyStatistics.MaximumFrameLatency = 1;
+		}
+		DX::ThrowIfFailed(swapChain2->SetMaximumFrameLatency(LatencyStatistics.MaximumFrameLatency));
+		FrameLatencyWaitableObject = swapChain2->GetFrameLatencyWaitableObject();
+		IsWaitingForFrame = false;
 
-		//Configure viewport
-		D3D11_VIEWPORT viewPort;
-		viewPort.Width = static_cast<float>(bufferWidth);
-		viewPort.Height = static_cast<float>(bufferHeight);
-		viewPort.MinDepth = 0.0f;
-		viewPort.MaxDepth = 1.0f;
-		viewPort.TopLeftX = 0.0f;
-		viewPort.TopLeftY = 0.0f;
-		DeviceContextPointer->RSSetViewports(1u, &viewPort);
-
-		//Create the SpriteBatch
+		//Create the SpriteBatch. Sprites are always placed in buffer coordinates, so the scene can be drawn at a lower resolution
+		//just by shrinking the viewport
 		SpriteBatchPointer = std::make_unique<DirectX::SpriteBatch>(DeviceContextPointer.Get());
+		SpriteBatchPointer->SetViewport(CD3D11_VIEWPORT(0.0f, 0.0f, static_cast<float>(BufferWidth), static_cast<float>(BufferHeight)));
+
+		//Create the scene, at the internal resolution
+		CD3D11_TEXTURE2D_DESC sceneDescription(DXGI_FORMAT_R8G8B8A8_UNORM, BufferWidth, BufferHeight, 1, 1, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+		wrl::ComPtr<ID3D11Texture2D> sceneResource;
+		DX::ThrowIfFailed(DevicePointer->CreateTexture2D(&sceneDescription, nullptr, &sceneResource));
+		DX::ThrowIfFailed(DevicePointer->CreateRenderTargetView(sceneResource.Get(), nullptr, &SceneRenderTargetPointer));
+		DX::ThrowIfFailed(DevicePointer->CreateShaderResourceView(sceneResource.Get(), nullptr, &SceneTexturePointer));
 
 		//Create the common states
 		SpriteBatchStatesPointer = std::make_unique<DirectX::CommonStates>(DevicePointer.Get());
-	}
 
-	void Graphics::Present()
-	{
-		//Bind render target views
-		DeviceContextPointer->OMSetRenderTargets(1u, RenderTargetPointer.GetAddressOf(), nullptr);
-		
-		//End any active sprite batches
-		EndSpriteBatch();
+		//Compile the shaders and constant buffer used for single pass outlined text and distance field text
+		CompilePixelShader(ShaderSources::OutlineBakePixelShader, "OutlineBakePixelShader", OutlineBakePixelShaderPointer);
+		CompilePixelShader(ShaderSources::OutlinedTextPixelShader, "OutlinedTextPixelShader", OutlinedTextPixelShaderPointer);
+		CompilePixelShader(ShaderSources::DistanceFieldTextPixelShader, "DistanceFieldTextPixelShader", DistanceFieldTextPixelShaderPointer);
+		CompilePixelShader(ShaderSources::StraightAlphaSpritePixelShader, "StraightAlphaSpritePixelShader", StraightAlphaSpritePixelShaderPointer);
 
-		HRESULT hr = SwapChainPointer->Present(1u, 0u);
+		CD3D11_BUFFER_DESC outlineBufferDescription(sizeof(TextShaderParameters), D3D11_BIND_CONSTANT_BUFFER);
+		hr = DevicePointer->CreateBuffer(&outlineBufferDescription, nullptr, &OutlineConstantBufferPointer);
 		DX::ThrowIfFailed(hr);
 
-		//TODO: Handle device removed and device reset someday...
-	}
+		//Layer caches start out transparent, so drawing straight alpha into them has to accumulate alpha properly (the result is premultiplied)
+		D3D11_BLEND_DESC layerCacheBlendDescription = {};
+		layerCacheBlendDescription.RenderTarget[0].BlendEnable = TRUE;
+		layerCacheBlendDescription.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
+		layerCacheBlendDescription.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+		layerCacheBlendDescription.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+		layerCacheBlendDescription.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+		layerCacheBlendDescription.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA;
+		layerCacheBlendDescription.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+		layerCacheBlendDescription.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+		hr = DevicePointer->CreateBlendState(&layerCacheBlendDescription, &LayerCacheBlendStatePointer);
+		DX::ThrowIfFailed(hr);
 
-	void Graphics::ClearFrame(float red, float green, float blue) noexcept
-	{
-		const float colour[] = { red, green, blue, 1.0f };
-		DeviceContextPointer->ClearRenderTargetView(RenderTargetPointer.Get(), colour);
+		//Additive sprites are premultiplied and leave the destination alpha alone, so a layer cache composited afterwards still
+		//adds their colour instead of covering what is below
+		D3D11_BLEND_DESC additiveBlendDescription = layerCacheBlendDescription;
+		additiveBlendDescription.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
+		additiveBlendDescription.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
+		additiveBlendDescription.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ZERO;
+		additiveBlendDescription.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ONE;
+		hr = DevicePointer->CreateBlendState(&additiveBlendDescription, &AdditiveBlendStatePointer);
+		DX::ThrowIfFailed(hr);
+
+		//The queries belong to the device, so the timer is made again with it
+		CreateGPUTimer();
 	}
 
-	void Graphics::ResetRenderTargetAndViewport(uint16_t clientWidth, uint16_t clientHeight)
+	//Throws away every resource of the lost device and makes them again on a new one. Anything loaded from a file is loaded again
+	//in place, so drawables keep their fonts and textures and pages do not need to be made again
+	void Graphics::HandleDeviceLost()
 	{
-		//Unbind the current render target and release references
-		DeviceContextPointer->OMSetRenderTargets(0, 0, 0);
+		HRESULT removedReason = DevicePointer->GetDeviceRemovedReason();
+		DIVERGENCE_LOG_WARNING(L"Graphics device lost (reason 0x{:08X}), recreating device resources", static_cast<uint32_t>(removedReason));
+		DeviceLostCount++;
+
+		//Release everything that belongs to the old device. The batch was already ended by Present
+		IsSpriteBatchDrawing = false;
+		IsDrawingToLayerCache = false;
+		ActiveSpriteShader = SpriteShaderClass::Default;
+		LayerCaches.clear();
+		SpriteBatchPointer.reset();
+		SpriteBatchStatesPointer.reset();
+		OutlineBakePixelShaderPointer.Reset();
+		OutlinedTextPixelShaderPointer.Reset();
+		DistanceFieldTextPixelShaderPointer.Reset();
+		StraightAlphaSpritePixelShaderPointer.Reset();
+		OutlineConstantBufferPointer.Reset();
+		LayerCacheBlendStatePointer.Reset();
+		AdditiveBlendStatePointer.Reset();
+		GPUTimer.reset();
 		RenderTargetPointer.Reset();
+		SceneRenderTargetPointer.Reset();
+		SceneTexturePointer.Reset();
+		CloseHandle(FrameLatencyWaitableObject);
+		FrameLatencyWaitableObject = nullptr;
+		DeviceContextPointer->ClearState();
+		DeviceContextPointer->Flush();
+		SwapChainPointer.Reset();
+		DeviceContextPointer.Reset();
+		DevicePointer.Reset();
 
-		//Flush all remaining commands on device context
-		//DeviceContextPointer->Flush();
-		
-		//Get texture resource from swap chain (back buffer)
-		wrl::ComPtr<ID3D11Texture2D> backBufferPointer;
-		HRESULT hr = SwapChainPointer->GetBuffer(0, _uuidof(ID3D11Texture2D), &backBufferPointer);
-		DX::ThrowIfFailed(hr);
+		CreateDeviceResources();
+		ResetRenderTargetAndViewport(BackBufferWidth, BackBufferHeight);
 
-		//Create render target
-		hr = DevicePointer->CreateRenderTargetView(
-			backBufferPointer.Get(),
-			nullptr,
-			&RenderTargetPointer
-		);
-		DX::ThrowIfFailed(hr);
+		//Fonts are assigned in place, so every weak pointer handed out still points at them
+		for (auto& [spriteFontPath, spriteFont] : FontMap)
+		{
+			*spriteFont = DirectX::SpriteFont(DevicePointer.Get(), spriteFontPath.c_str());
+		}
+
+		for (auto& [sdfFontPath, sdfFont] : SDFFontMap)
+		{
+			sdfFont->Load(DevicePointer.Get());
+		}
+
+		//Textures nothing holds any more are forgotten instead of loaded again
+		for (auto textureIterator = TextureMap.begin(); textureIterator != TextureMap.end();)
+		{
+			std::shared_ptr<Texture> texture = textureIterator->second.lock();
+			if (!texture)
+			{
+				textureIterator = TextureMap.erase(textureIterator);
+				continue;
+			}
 
-		//Configure viewport
-		D3D11_VIEWPORT viewPort;
-		viewPort.Width = static_cast<float>(clientWidth);
-		viewPort.Height = static_cast<float>(clientHeight);
-		viewPort.MinDepth = 0.0f;
-		viewPort.MaxDepth = 1.0f;
-		viewPort.TopLeftX = 0.0f;
-		viewPort.TopLeftY = 0.0f;
-		DeviceContextPointer->RSSetViewports(1u, &viewPort);
+			CreateTextureFromFile(*texture);
+			++textureIterator;
+		}
+
+		//The fonts kept their addresses, so the atlases can be baked again from them
+		for (auto& [atlasKey, outlinedFontAtlas] : OutlinedFontAtlasMap)
+		{
+			outlinedFontAtlas->Bake(DevicePointer.Get(), DeviceContextPointer.Get(), OutlineBakePixelShaderPointer.Get(), SpriteBatchStatesPointer->PointClamp());
+		}
+
+		DIVERGENCE_LOG_INFO(L"Graphics device recreated with {} fonts, {} distance field fonts, and {} textures", FontMap.size(), SDFFontMap.size(), TextureMap.size());
 	}
 
-	void Graphics::ResizeWindow(uint16_t clientWidth, uint16_t clientHeight)
+	//The part of the scene texture this frame is drawn to
+	RECT Graphics::GetSceneRectangle() const noexcept
 	{
-		DXGI_MODE_DESC displayDescription = {};
-		displayDescription.Width = clientWidth;
-		displayDescription.Height = clientHeight;
-		displayDescription.RefreshRate.Numerator = 0;
-		displayDescription.RefreshRate.Denominator = 0;
-		displayDescription.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-		displayDescription.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
-		displayDescription.Scaling = DXGI_MODE_SCALING_STRETCHED;
-		
-		//Resize the swap chain
-		HRESULT hr = SwapChainPointer->ResizeTarget(&displayDescription);
-		DX::ThrowIfFailed(hr);
+		return RECT{ 0, 0, std::lround(BufferWidth * RenderScale), std::lround(BufferHeight * RenderScale) };
 	}
-	
-	//Sprite batch functions-----------------------------------------------------------------------
-	void Graphics::DrawFullSprite(ID3D11ShaderResourceView* texture, DirectX::SimpleMath::Vector2 position)
-	{
-		BeginSpriteBatch();
 
-		SpriteBatchPointer->Draw(texture, position);
+	void Graphics::BindScene() noexcept
+	{
+		RECT sceneRectangle = GetSceneRectangle();
+		CD3D11_VIEWPORT sceneViewport(0.0f, 0.0f, static_cast<float>(sceneRectangle.right), static_cast<float>(sceneRectangle.bottom));
+		DeviceContextPointer->OMSetRenderTargets(1u, SceneRenderTargetPointer.GetAddressOf(), nullptr);
+		DeviceContextPointer->RSSetViewports(1u, &sceneViewport);
 	}
 
-	void Graphics::DrawSizedSprite(ID3D11ShaderResourceView* texture, DirectX::SimpleMath::Vector2 position, DirectX::SimpleMath::Vector2 size)
+	//Draws the scene onto the back buffer, within the rectangle picked by the scaling mode
+	void Graphics::ResolveScene()
 	{
-		BeginSpriteBatch();
-		
-		RECT positionRectangle;
-		positionRectangle.left = static_cast<LONG>(position.x);
-		positionRectangle.right = static_cast<LONG>(position.x + size.x);
-		positionRectangle.top = static_cast<LONG>(position.y);
-		positionRectangle.bottom = static_cast<LONG>(position.y + size.y);
-		SpriteBatchPointer->Draw(texture, positionRectangle, nullptr, DirectX::Colors::White);
+		DeviceContextPointer->OMSetRenderTargets(1u, RenderTargetPointer.GetAddressOf(), nullptr);
+		const float barColour[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		DeviceContextPointer->ClearRenderTargetView(RenderTargetPointer.Get(), barColour);
+
+		CD3D11_VIEWPORT backBufferViewport(0.0f, 0.0f, static_cast<float>(BackBufferWidth), static_cast<float>(BackBufferHeight));
+		DeviceContextPointer->RSSetViewports(1u, &backBufferViewport);
+		SpriteBatchPointer->SetViewport(backBufferViewport);
+
+		//Whole multiples of a full resolution scene are sampled texel for texel, so they stay sharp
+		RECT sceneRectangle = GetSceneRectangle();
+		const bool isPixelExact = ScalingMode == ScalingModeClass::Integer && RenderScale == 1.0f;
+		ID3D11SamplerState* sceneSampler = isPixelExact ? SpriteBatchStatesPointer->PointClamp() : SpriteBatchStatesPointer->LinearClamp();
+		SpriteBatchPointer->Begin(DirectX::SpriteSortMode_Immediate, SpriteBatchStatesPointer->Opaque(), sceneSampler);
+		SpriteBatchPointer->Draw(SceneTexturePointer.Get(), SceneDestinationRectangle, &sceneRectangle);
+		SpriteBatchPointer->End();
+
+		//The scene is drawn to again next frame, so it cannot stay bound as a texture
+		ID3D11ShaderResourceView* nullTexture = nullptr;
+		DeviceContextPointer->PSSetShaderResources(0, 1, &nullTexture);
+		SpriteBatchPointer->SetViewport(CD3D11_VIEWPORT(0.0f, 0.0f, static_cast<float>(BufferWidth), static_cast<float>(BufferHeight)));
 	}
 
-	//Font drawing functions-----------------------------------------------------------------------
-	void Graphics::DrawString(DirectX::SpriteFont* spriteFont, std::wstring text, DirectX::SimpleMath::Vector2 positionCoord, DirectX::SimpleMath::Vector2 origin, DirectX::SimpleMath::Color colour, bool dropShadow)
+	void Graphics::UpdateSceneDestinationRectangle() noexcept
 	{
-		BeginSpriteBatch();
+		const double widthRatio = static_cast<double>(BackBufferWidth) / BufferWidth;
+		const double heightRatio = static_cast<double>(BackBufferHeight) / BufferHeight;
 
-		if (dropShadow)
+		double scale = std::min(widthRatio, heightRatio);
+		switch (ScalingMode)
 		{
-			//Take the negation of the font colour and use that as its drop shadow colour
-			DirectX::SimpleMath::Color shadowColour = DirectX::SimpleMath::Color(colour);
-			shadowColour.Negate();
+		case ScalingModeClass::Stretch:
+			SceneDestinationRectangle = RECT{ 0, 0, BackBufferWidth, BackBufferHeight };
+			return;
 
-			spriteFont->DrawString(SpriteBatchPointer.get(), text.c_str(), positionCoord + DirectX::SimpleMath::Vector2(1, 1), shadowColour, 0, origin);
-			spriteFont->DrawString(SpriteBatchPointer.get(), text.c_str(), positionCoord + DirectX::SimpleMath::Vector2(-1, 1), shadowColour, 0, origin);
-			spriteFont->DrawString(SpriteBatchPointer.get(), text.c_str(), positionCoord + DirectX::SimpleMath::Vector2(-1, -1), shadowColour, 0, origin);
-			spriteFont->DrawString(SpriteBatchPointer.get(), text.c_str(), positionCoord + DirectX::SimpleMath::Vector2(1, -1), shadowColour, 0, origin);
+		case ScalingModeClass::Integer:
+			scale = scale >= 1.0 ? std::floor(scale) : scale;
+			break;
+
+		default:
+			break;
 		}
 
-		spriteFont->DrawString(SpriteBatchPointer.get(), text.c_str(), positionCoord, colour, 0, origin);
+		//Centre the scaled scene, leaving bars on the sides that do not fit
+		const LONG destinationWidth = std::lround(BufferWidth * scale);
+		const LONG destinationHeight = std::lround(BufferHeight * scale);
+		SceneDestinationRectangle.left = (BackBufferWidth - destinationWidth) / 2;
+		SceneDestinationRectangle.top = (BackBufferHeight - destinationHeight) / 2;
+		SceneDestinationRectangle.right = SceneDestinationRectangle.left + destinationWidth;
+		SceneDestinationRectangle.bottom = SceneDestinationRectangle.top + destinationHeight;
 	}
 
-	//Texture Loader-------------------------------------------------------------------------------
-	
-	//Designed for loading textures from files, when you need to know the size of the texture
-	void Graphics::LoadTexture(const std::wstring& filePath, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& texture, CD3D11_TEXTURE2D_DESC& textureDescription)
+	//Steps the render scale down quickly when a frame goes over budget, and back up slowly when there is plenty of headroom
+	void Graphics::UpdateDynamicResolution(double frameMilliseconds) noexcept
 	{
-		//Load the texture and its resource info from the file
-		wrl::ComPtr<ID3D11Resource> resource;
-		DX::ThrowIfFailed(DirectX::CreateWICTextureFromFile(DevicePointer.Get(), DeviceContextPointer.Get(), filePath.c_str(), &resource, &texture));
-
-		//Get the texture description from the resource info
-		wrl::ComPtr<ID3D11Texture2D> texture2D;
-		DX::ThrowIfFailed(resource.As(&texture2D));
-		texture2D->GetDesc(&textureDescription);
-	}
+		if (!IsDynamicResolutionEnabled)
+		{
+			return;
+		}
 
-	//For loading textures from files, when you won't need the default size of the texture and it will be defined by the programmer
-	void Graphics::LoadTexture(const std::wstring& filePath, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& texture)
-	{
-		DX::ThrowIfFailed(DirectX::CreateWICTextureFromFile(DevicePointer.Get(), filePath.c_str(), nullptr, &texture));
+		if (frameMilliseconds > DynamicResolutionBudgetMilliseconds)
+		{
+			RenderScale = std::max(MinimumRenderScale, RenderScale - 0.05f);
+		}
+		else if (frameMilliseconds < DynamicResolutionBudgetMilliseconds * 0.75)
+		{
+			RenderScale = std::min(1.0f, RenderScale + 0.01f);
+		}
 	}
 
-	//Font Loader----------------------------------------------------------------------------------
-	void Graphics::LoadFont(const std::wstring& spriteFontPath, std::weak_ptr<DirectX::SpriteFont>& spriteFont)
+	//Works out how many presented frames are still waiting to be shown. The statistics are not always available (for example while
+	//the window is composed by the desktop), in which case the last count is kept
+	void Graphics::UpdateQueuedFrameCount()
 	{
-		if (!FontMap.contains(spriteFontPath))
+		DXGI_FRAME_STATISTICS frameStatistics;
+		UINT lastPresentCount;
+		if (SUCCEEDED(SwapChainPointer->GetFrameStatistics(&frameStatistics)) && SUCCEEDED(SwapChainPointer->GetLastPresentCount(&lastPresentCount)))
 		{
-			FontMap[spriteFontPath] = std::make_shared<DirectX::SpriteFont>(DevicePointer.Get(), spriteFontPath.c_str());
-			DivergenceEngine::Logger::Log(std::format(L"Font loaded from file: {}", spriteFontPath));
+			LatencyStatistics.QueuedFrames = lastPresentCount - frameStatistics.PresentCount;
 		}
-
-		spriteFont = FontMap[spriteFontPath];
 	}
 
-	//Helpers--------------------------------------------------------------------------------------
-	void Graphics::BeginSpriteBatch() noexcept
+	void Graphics::CompilePixelShader(const char* shaderSource, const char* shaderName, Microsoft::WRL::ComPtr<ID3D11PixelShader>& pixelShader)
 	{
-		if (!IsSpriteBatchDrawing)
+		UINT compileFlags = D3DCOMPILE_ENABLE_STRICTNESS;
+#ifndef NDEBUG
+		compileFlags |= D3DCOMPILE_DEBUG;
+#else
+		compileFlags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+
+		wrl::ComPtr<ID3DBlob> shaderBlob;
+		wrl::ComPtr<ID3DBlob> errorBlob;
+		HRESULT hr = D3DCompile(shaderSource, strlen(shaderSource), shaderName, nullptr, nullptr, "main", "ps_4_0", compileFlags, 0, &shaderBlob, &errorBlob);
+		if (FAILED(hr))
 		{
-			SpriteBatchPointer->Begin(DirectX::SpriteSortMode_Deferred, SpriteBatchStatesPointer->NonPremultiplied());
-			IsSpriteBatchDrawing = true;
+			std::string errorMessage = errorBlob ? static_cast<const char*>(errorBlob->GetBufferPointer()) : "Unknown error";
+			DIVERGENCE_LOG_ERROR(L"Failed to compile shader {}", DivergenceEngine::StringConverter::ConvertNarrowStringToWideString(shaderName));
+			throw std::runtime_error(std::format("Graphics::CompilePixelShader() - {} failed to compile: {}", shaderName, errorMessage));
 		}
+
+		hr = DevicePointer->CreatePixelShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, &pixelShader);
+		DX::ThrowIfFailed(hr);
 	}
 
-	void Graphics::EndSpriteBatch() noexcept
+	std::shared_ptr<OutlinedFontAtlas> Graphics::GetOutlinedFontAtlas(const DirectX::SpriteFont* spriteFont, const TextOutlineDesc& outlineDescription)
 	{
-		if (IsSpriteBatchDrawing)
+		//Atlases are shared by every piece of text with the same font and outline
+		std::lock_guard<std::recursive_mutex> contextLock(ContextMutex);
+		auto atlasKey = std::make_tuple(spriteFont, outlineDescription.Width, outlineDescription.Offset.x, outlineDescription.Offset.y);
+		auto atlasIterator = OutlinedFontAtlasMap.find(atlasKey);
+		if (atlasIterator != OutlinedFontAtlasMap.end())
 		{
-			SpriteBatchPointer->End();
-			IsSpriteBatchDrawing = false;
+			return atlasIterator->second;
 		}
+
+		//Baking renders to the context, so any batch in progress has to be submitted first
+		EndSpriteBatch();
+		std::shared_ptr<OutlinedFontAtlas> outlinedFontAtlas = std::make_shared<OutlinedFontAtlas>(DevicePointer.Get(), DeviceContextPointer.Get(), OutlineBakePixelShaderPointer.Get(), SpriteBatchStatesPointer->PointClamp(), spriteFont, outlineDescription);
+		OutlinedFontAtlasMap[atlasKey] = outlinedFontAtlas;
+
+		DIVERGENCE_LOG_DEBUG(L"Outline atlas baked with width {}", outlineDescription.Width);
+		return outlinedFontAtlas;
 	}
 
 	//Getters--------------------------------------------------------------------------------------
@@ -250,4 +1427,9 @@ namespace DivergenceEngine
 	{
 		return DirectX::XMINT2(BufferWidth, BufferHeight);
 	}
+
+	uint32_t Graphics::GetDeviceLostCount() const noexcept
+	{
+		return DeviceLostCount;
+	}
 }
\ No newline at end of file
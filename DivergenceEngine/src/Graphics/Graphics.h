@@ -1,6 +1,8 @@
 #pragma once
 #include <Windows.h>
 #include <d3d11.h>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <wrl.h>
 #include <SimpleMath.h>
@@ -9,6 +11,18 @@
 #include <CommonStates.h>
 #include <SpriteFont.h>
 #include <unordered_map>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "Graphics/GlyphRun.h"
+#include "Graphics/OutlinedFontAtlas.h"
+#include "Graphics/SDFFont.h"
+#include "Graphics/RenderCommandList.h"
+#include "Graphics/GPUTimer.h"
 
 /*
 Video playback links:
@@ -21,9 +35,68 @@ https://learn.microsoft.com/en-us/windows/win32/medfound/direct3d-11-video-apis
 
 namespace DivergenceEngine
 {
+	//How sprites are blended onto what has already been drawn
+	enum class SpriteBlendClass
+	{
+		NonPremultiplied, //Straight alpha. Only meant for textures loaded as TextureAlphaClass::Straight
+		Premultiplied, //Mixes straight and premultiplied textures, and scales without dark fringes
+		Additive, //Premultiplied, adding onto what is below
+		Opaque
+	};
+
+	//The sprite batch state a layer is drawn with
+	struct LayerRenderState
+	{
+		//Texture collapses a layer into the fewest draw calls, but sprites with different textures may swap which is on top.
+		//BackToFront and FrontToBack order by the depth given to SetSpriteLayerDepth, and Immediate draws every sprite on its own
+		DirectX::SpriteSortMode SortMode = DirectX::SpriteSortMode_Deferred;
+		SpriteBlendClass Blend = SpriteBlendClass::Premultiplied;
+
+		bool operator==(const LayerRenderState& other) const noexcept = default;
+	};
+
+	//A texture loaded from a file. Graphics keeps track of every one still in use, so they can be loaded again if the device is lost
+	struct Texture
+	{
+		std::wstring FilePath;
+		TextureAlphaClass TextureAlpha = TextureAlphaClass::Premultiplied;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> ShaderResourceView;
+		CD3D11_TEXTURE2D_DESC Description = {};
+	};
+
+	//How the internal resolution is fitted to the window
+	enum class ScalingModeClass
+	{
+		Stretch, //Fills the window, even if the aspect ratio differs
+		Letterbox, //The largest size with the same aspect ratio, with black bars filling the rest
+		Integer //The largest whole multiple of the internal resolution that fits, so pixel art stays sharp. Letterboxes when the window is smaller
+	};
+
+	//How long frames wait to be shown. Figures are in milliseconds
+	struct FrameLatencyStatistics
+	{
+		uint32_t MaximumFrameLatency = 0;
+		bool IsTearingSupported = false;
+		bool IsVerticalSyncEnabled = true;
+		uint32_t QueuedFrames = 0; //Frames presented that the display has not shown yet
+		double LastWaitMilliseconds = 0; //Time blocked on the swap chain before the last frame started
+		double AverageWaitMilliseconds = 0;
+		double LastInputToPresentMilliseconds = 0; //From the end of the wait, when input is read, to the frame being handed to the swap chain
+		double AverageInputToPresentMilliseconds = 0;
+	};
+
 	class Graphics
 	{
 	private:
+		//Layout of the constant buffer shared by the text pixel shaders
+		struct TextShaderParameters
+		{
+			DirectX::XMFLOAT4 OutlineColour;
+			float OutlineThreshold;
+			float OutputPremultiplied;
+			float Padding[2];
+		};
+
 		//Datafields
 		uint16_t BufferWidth = 800;
 		uint16_t BufferHeight = 450;
@@ -36,43 +109,186 @@ namespace DivergenceEngine
 		std::unique_ptr<DirectX::SpriteBatch> SpriteBatchPointer;
 		std::unique_ptr<DirectX::CommonStates> SpriteBatchStatesPointer;
 		std::unordered_map <std::wstring, std::shared_ptr<DirectX::SpriteFont>> FontMap;
+		std::map<std::pair<std::wstring, TextureAlphaClass>, std::weak_ptr<Texture>> TextureMap;
 		bool IsSpriteBatchDrawing = false;
+		ID3D11ShaderResourceView* LastBatchTexture = nullptr; //Only used to count texture changes
+
+		//Frame latency
+		static constexpr UINT SWAP_CHAIN_BUFFER_COUNT = 3;
+		UINT SwapChainFlags = 0;
+		HANDLE FrameLatencyWaitableObject = nullptr;
+		bool IsWaitingForFrame = false; //Each wait must be paired with a Present, or the next wait blocks for a whole frame
+		std::chrono::steady_clock::time_point FrameWaitEndTime;
+		uint64_t FrameWaitCount = 0;
+		uint64_t FramePresentCount = 0;
+		double TotalWaitMilliseconds = 0;
+		double TotalInputToPresentMilliseconds = 0;
+		FrameLatencyStatistics LatencyStatistics;
+		void UpdateQueuedFrameCount();
+
+		//Outlined and distance field text
+		Microsoft::WRL::ComPtr<ID3D11PixelShader> OutlineBakePixelShaderPointer;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader> OutlinedTextPixelShaderPointer;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader> DistanceFieldTextPixelShaderPointer;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader> StraightAlphaSpritePixelShaderPointer;
+		Microsoft::WRL::ComPtr<ID3D11Buffer> OutlineConstantBufferPointer;
+		std::map<std::tuple<const DirectX::SpriteFont*, uint32_t, int32_t, int32_t>, std::shared_ptr<OutlinedFontAtlas>> OutlinedFontAtlasMap;
+		SpriteShaderClass ActiveSpriteShader = SpriteShaderClass::Default;
+		DirectX::SimpleMath::Color ActiveOutlineColour;
+		float ActiveOutlineThreshold = 0.5f;
+		std::unordered_map<std::wstring, std::shared_ptr<SDFFont>> SDFFontMap;
+
+		//Layer caches (retained rendering)
+		struct LayerCache
+		{
+			Microsoft::WRL::ComPtr<ID3D11RenderTargetView> RenderTarget;
+			Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> Texture;
+		};
+		std::vector<LayerCache> LayerCaches;
+		Microsoft::WRL::ComPtr<ID3D11BlendState> LayerCacheBlendStatePointer;
+		Microsoft::WRL::ComPtr<ID3D11BlendState> AdditiveBlendStatePointer;
+		bool IsDrawingToLayerCache = false;
+
+		//Command recording. Each thread records into its own list, if it has one
+		static thread_local RenderCommandList* RecordingCommandList;
+		std::vector<uint32_t> SubmitOrder;
+
+		//Layer state
+		LayerRenderState ActiveLayerRenderState;
+		static thread_local float CurrentLayerDepth;
+
+		//Scene scaling. Everything is drawn at the internal resolution into the scene texture, which is then scaled onto the back buffer
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> SceneRenderTargetPointer;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> SceneTexturePointer;
+		uint16_t BackBufferWidth;
+		uint16_t BackBufferHeight;
+		ScalingModeClass ScalingMode = ScalingModeClass::Stretch;
+		RECT SceneDestinationRectangle = {};
+		float RenderScale = 1.0f;
+		bool IsDynamicResolutionEnabled = false;
+		double DynamicResolutionBudgetMilliseconds = 0;
+		float MinimumRenderScale = 0.5f;
+		std::chrono::steady_clock::time_point FrameStartTime;
+		RECT GetSceneRectangle() const noexcept;
+		void BindScene() noexcept;
+		void ResolveScene();
+		void UpdateSceneDestinationRectangle() noexcept;
+		void UpdateDynamicResolution(double frameMilliseconds) noexcept;
+
+		//Device loss
+		bool IsDeviceRemovalSimulated = false;
+		uint32_t DeviceLostCount = 0;
+		bool IsDeviceLostRecoveryDeferred = false;
+		std::atomic<bool> IsRecoveryPending = false;
+		void CreateDeviceResources();
+		void HandleDeviceLost();
+
+		//Threading
+		std::recursive_mutex ContextMutex;
+
+		//GPU timing. A null timer is used while it is off, so the passes are always marked the same way
+		std::unique_ptr<IGPUTimer> GPUTimer;
+		bool IsGPUTimingEnabled = false;
+		void CreateGPUTimer();
 
 		//Helpers
-		void BeginSpriteBatch() noexcept;
+		void DrawSprite(SpriteCommand spriteCommand);
+		ID3D11BlendState* GetSpriteBlendState() const noexcept;
+		ID3D11PixelShader* GetSpritePixelShader(SpriteShaderClass spriteShader) const noexcept;
+		void CreateTextureFromFile(Texture& texture);
+		void ExecuteSpriteCommand(const SpriteCommand& spriteCommand);
+		void BeginSpriteBatch(SpriteShaderClass spriteShader = SpriteShaderClass::Default, DirectX::SimpleMath::Color outlineColour = DirectX::SimpleMath::Color(), float outlineThreshold = 0.5f) noexcept;
 		void EndSpriteBatch() noexcept;
+		void CompilePixelShader(const char* shaderSource, const char* shaderName, Microsoft::WRL::ComPtr<ID3D11PixelShader>& pixelShader);
+		std::shared_ptr<OutlinedFontAtlas> GetOutlinedFontAtlas(const DirectX::SpriteFont* spriteFont, const TextOutlineDesc& outlineDescription);
 		
 	public:
 		//Constructors and destructors
 		Graphics(uint32_t frameRate, HWND windowHandle, uint16_t bufferWidth, uint16_t bufferHeight);
+		~Graphics();
 
 		//Deleted stuff
 		Graphics(const Graphics&) = delete;
 		Graphics& operator=(const Graphics&) = delete;
 
 		//Public functions
-		void Present();
+		bool Present();
 		void ClearFrame(float red, float green, float blue) noexcept;
 
 		//Maintenance functions
 		void ResetRenderTargetAndViewport(uint16_t clientWidth, uint16_t clientHeight);
 		void ResizeWindow(uint16_t clientWidth, uint16_t clientHeight);
 
+		//Scaling functions
+		void SetScalingMode(ScalingModeClass scalingMode) noexcept;
+		ScalingModeClass GetScalingMode() const noexcept;
+		void EnableDynamicResolution(double frameBudgetMilliseconds, float minimumRenderScale = 0.5f);
+		void DisableDynamicResolution() noexcept;
+		float GetRenderScale() const noexcept;
+		DirectX::XMINT2 ClientToBuffer(DirectX::XMINT2 clientPosition) const noexcept;
+
+		//Frame latency functions
+		void WaitForNextFrame();
+		void SetMaximumFrameLatency(uint32_t maximumFrameLatency);
+		void SetVerticalSync(bool isVerticalSyncEnabled) noexcept;
+		const FrameLatencyStatistics& GetFrameLatencyStatistics() const noexcept;
+		void ResetFrameLatencyStatistics() noexcept;
+
+		//Device loss functions
+		void SimulateDeviceRemoved() noexcept;
+		void SetDeviceLostRecoveryDeferred(bool isDeviceLostRecoveryDeferred) noexcept;
+		bool IsDeviceLostPending() const noexcept;
+		void RecoverLostDevice();
+
+		//Threading functions
+		std::unique_lock<std::recursive_mutex> LockContext();
+
+		//GPU timing functions
+		void SetGPUTiming(bool isGPUTimingEnabled);
+		bool IsGPUTimingOn() const noexcept;
+		void BeginGPUPass(const char* name, uint32_t index = 0) noexcept;
+		void EndGPUPass() noexcept;
+		const GPUFrameTimings& GetGPUFrameTimings() const noexcept;
+		uint64_t GetGPUFramesDropped() const noexcept;
+
+		//Layer cache functions
+		void BeginLayerCache(size_t layer);
+		void EndLayerCache();
+		void DrawLayerCaches(size_t layerCount);
+		void ReleaseLayerCaches() noexcept;
+		void WaitForVerticalBlank();
+
+		//Command recording functions
+		void BeginCommandRecording(RenderCommandList& commandList) noexcept;
+		void EndCommandRecording() noexcept;
+		void SubmitCommandList(const RenderCommandList& commandList, bool sortByState);
+
+		//Layer state functions
+		void SetLayerRenderState(const LayerRenderState& layerRenderState) noexcept;
+		void SetSpriteLayerDepth(float layerDepth) noexcept;
+
 		//Sprite batch functions
-		void DrawFullSprite(ID3D11ShaderResourceView* texture, DirectX::SimpleMath::Vector2 position);
-		void DrawSizedSprite(ID3D11ShaderResourceView* texture, DirectX::SimpleMath::Vector2 position, DirectX::SimpleMath::Vector2 size);
+		void DrawFullSprite(ID3D11ShaderResourceView* texture, DirectX::SimpleMath::Vector2 position, TextureAlphaClass textureAlpha = TextureAlphaClass::Premultiplied);
+		void DrawSizedSprite(ID3D11ShaderResourceView* texture, DirectX::SimpleMath::Vector2 position, DirectX::SimpleMath::Vector2 size, TextureAlphaClass textureAlpha = TextureAlphaClass::Premultiplied);
 
 		//Font drawing functions
 		void DrawString(DirectX::SpriteFont* spriteFont, std::wstring text, DirectX::SimpleMath::Vector2 positionCoord, DirectX::SimpleMath::Vector2 origin = DirectX::SimpleMath::Vector2(0,0), DirectX::SimpleMath::Color colour = DirectX::Colors::White.v, bool dropShadow = false);
+		void DrawGlyphRun(DirectX::SpriteFont* spriteFont, const GlyphRun& glyphRun, DirectX::SimpleMath::Vector2 positionCoord, DirectX::SimpleMath::Vector2 origin = DirectX::SimpleMath::Vector2(0, 0), DirectX::SimpleMath::Color colour = DirectX::Colors::White.v, DirectX::SimpleMath::Color outlineColour = DirectX::Colors::Black.v);
+		void DrawGlyphRun(SDFFont* sdfFont, const GlyphRun& glyphRun, DirectX::SimpleMath::Vector2 positionCoord, DirectX::SimpleMath::Vector2 origin = DirectX::SimpleMath::Vector2(0, 0), DirectX::SimpleMath::Color colour = DirectX::Colors::White.v, DirectX::SimpleMath::Color outlineColour = DirectX::Colors::Black.v);
+
+		//Font layout functions
+		void BuildGlyphRun(DirectX::SpriteFont* spriteFont, const std::wstring& text, GlyphRun& glyphRun, std::optional<TextOutlineDesc> outlineDescription = std::nullopt);
+		void BuildGlyphRun(SDFFont* sdfFont, const std::wstring& text, float fontSize, GlyphRun& glyphRun, std::optional<float> outlineWidth = std::nullopt);
 
 		//Texture loaders
-		void LoadTexture(const std::wstring& filePath, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& texture, CD3D11_TEXTURE2D_DESC&  textureDescription);
-		void LoadTexture(const std::wstring& filePath, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& texture);
+		void LoadTexture(const std::wstring& filePath, std::shared_ptr<Texture>& texture, TextureAlphaClass textureAlpha = TextureAlphaClass::Premultiplied);
 
 		//Font loaders
 		void LoadFont(const std::wstring& spriteFontPath, std::weak_ptr<DirectX::SpriteFont>& spriteFont);
+		void LoadSDFFont(const std::wstring& sdfFontPath, std::weak_ptr<SDFFont>& sdfFont);
 
 		//Getters
 		DirectX::XMINT2 GetBufferSize() const noexcept;
+		uint32_t GetDeviceLostCount() const noexcept;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,172 @@
+#define NOMINMAX
+#include "Graphics/OutlinedFontAtlas.h"
+#include "DXComErrorHandler.h"
+#include <SpriteBatch.h>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+namespace wrl = Microsoft::WRL;
+
+namespace DivergenceEngine
+{
+	OutlinedFontAtlas::OutlinedFontAtlas(ID3D11Device* device, ID3D11DeviceContext* deviceContext, ID3D11PixelShader* bakePixelShader, ID3D11SamplerState* pointSampler, const DirectX::SpriteFont* spriteFont, TextOutlineDesc outlineDescription) :
+		SourceFont(spriteFont),
+		OutlineDescription(outlineDescription)
+	{
+		//The padding has to fit the outline on every side, plus however far it is shifted
+		Padding = OutlineDescription.Width + static_cast<uint32_t>(std::max(std::abs(OutlineDescription.Offset.x), std::abs(OutlineDescription.Offset.y)));
+
+		Bake(device, deviceContext, bakePixelShader, pointSampler);
+	}
+
+	void OutlinedFontAtlas::Bake(ID3D11Device* device, ID3D11DeviceContext* deviceContext, ID3D11PixelShader* bakePixelShader, ID3D11SamplerState* pointSampler)
+	{
+		//Pack the padded glyphs into rows, leaving one empty texel between cells so linear filtering never bleeds between glyphs
+		std::vector<DirectX::SpriteFont::Glyph> glyphs = SourceFont->GetGlyphs();
+		GlyphRectangles.clear();
+		GlyphRectangles.reserve(glyphs.size());
+
+		uint32_t cursorX = 0;
+		uint32_t cursorY = 0;
+		uint32_t rowHeight = 0;
+		for (const DirectX::SpriteFont::Glyph& glyph : glyphs)
+		{
+			uint32_t cellWidth = static_cast<uint32_t>(glyph.Subrect.right - glyph.Subrect.left) + 2 * Padding;
+			uint32_t cellHeight = static_cast<uint32_t>(glyph.Subrect.bottom - glyph.Subrect.top) + 2 * Padding;
+
+			if (cursorX + cellWidth + 1 > ATLAS_WIDTH)
+			{
+				cursorX = 0;
+				cursorY += rowHeight + 1;
+				rowHeight = 0;
+			}
+
+			RECT cellRectangle;
+			cellRectangle.left = static_cast<LONG>(cursorX);
+			cellRectangle.top = static_cast<LONG>(cursorY);
+			cellRectangle.right = static_cast<LONG>(cursorX + cellWidth);
+			cellRectangle.bottom = static_cast<LONG>(cursorY + cellHeight);
+			GlyphRectangles[static_cast<wchar_t>(glyph.Character)] = cellRectangle;
+
+			cursorX += cellWidth + 1;
+			rowHeight = std::max(rowHeight, cellHeight);
+		}
+
+		uint32_t atlasHeight = std::max(cursorY + rowHeight, 1u);
+		if (atlasHeight > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION)
+		{
+			throw std::runtime_error("OutlinedFontAtlas::Bake() - font has too many glyphs to fit in an outline atlas");
+		}
+
+		//Create the two channel atlas, which is rendered to and then sampled from
+		CD3D11_TEXTURE2D_DESC atlasDescription(DXGI_FORMAT_R8G8_UNORM, ATLAS_WIDTH, atlasHeight, 1, 1, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+		wrl::ComPtr<ID3D11Texture2D> atlasResource;
+		DX::ThrowIfFailed(device->CreateTexture2D(&atlasDescription, nullptr, &atlasResource));
+
+		wrl::ComPtr<ID3D11RenderTargetView> atlasRenderTarget;
+		DX::ThrowIfFailed(device->CreateRenderTargetView(atlasResource.Get(), nullptr, &atlasRenderTarget));
+
+		AtlasTexture.Reset();
+		DX::ThrowIfFailed(device->CreateShaderResourceView(atlasResource.Get(), nullptr, &AtlasTexture));
+
+		//Coverage is accumulated with max blending, one channel at a time
+		D3D11_BLEND_DESC blendDescription = {};
+		blendDescription.RenderTarget[0].BlendEnable = TRUE;
+		blendDescription.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
+		blendDescription.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
+		blendDescription.RenderTarget[0].BlendOp = D3D11_BLEND_OP_MAX;
+		blendDescription.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+		blendDescription.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ONE;
+		blendDescription.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_MAX;
+
+		wrl::ComPtr<ID3D11BlendState> glyphBlendState;
+		blendDescription.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_RED;
+		DX::ThrowIfFailed(device->CreateBlendState(&blendDescription, &glyphBlendState));
+
+		wrl::ComPtr<ID3D11BlendState> outlineBlendState;
+		blendDescription.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_GREEN;
+		DX::ThrowIfFailed(device->CreateBlendState(&blendDescription, &outlineBlendState));
+
+		//Save the render target and viewport of the caller, so they can be put back afterwards
+		wrl::ComPtr<ID3D11RenderTargetView> previousRenderTarget;
+		wrl::ComPtr<ID3D11DepthStencilView> previousDepthStencil;
+		deviceContext->OMGetRenderTargets(1, &previousRenderTarget, &previousDepthStencil);
+		UINT previousViewportCount = 1;
+		D3D11_VIEWPORT previousViewport = {};
+		deviceContext->RSGetViewports(&previousViewportCount, &previousViewport);
+
+		//Point the context at the atlas
+		const float clearColour[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		deviceContext->ClearRenderTargetView(atlasRenderTarget.Get(), clearColour);
+		deviceContext->OMSetRenderTargets(1u, atlasRenderTarget.GetAddressOf(), nullptr);
+		CD3D11_VIEWPORT atlasViewport(0.0f, 0.0f, static_cast<float>(ATLAS_WIDTH), static_cast<float>(atlasHeight));
+		deviceContext->RSSetViewports(1u, &atlasViewport);
+
+		DirectX::SpriteBatch bakeBatch(deviceContext);
+		ID3D11ShaderResourceView* spriteSheet = SourceFont->GetSpriteSheet();
+		auto setBakeShader = [&]()
+			{
+				deviceContext->PSSetShader(bakePixelShader, nullptr, 0);
+			};
+		auto drawGlyphs = [&](DirectX::XMINT2 shift)
+			{
+				for (const DirectX::SpriteFont::Glyph& glyph : glyphs)
+				{
+					const RECT& cellRectangle = GlyphRectangles[static_cast<wchar_t>(glyph.Character)];
+					DirectX::XMFLOAT2 destination(
+						static_cast<float>(cellRectangle.left + static_cast<LONG>(Padding) + shift.x),
+						static_cast<float>(cellRectangle.top + static_cast<LONG>(Padding) + shift.y));
+					bakeBatch.Draw(spriteSheet, destination, &glyph.Subrect, DirectX::Colors::White);
+				}
+			};
+
+		//Red channel: the glyphs themselves
+		bakeBatch.Begin(DirectX::SpriteSortMode_Deferred, glyphBlendState.Get(), pointSampler, nullptr, nullptr, setBakeShader);
+		drawGlyphs(DirectX::XMINT2(0, 0));
+		bakeBatch.End();
+
+		//Green channel: the glyphs stamped at every offset within the outline radius
+		const int32_t radius = static_cast<int32_t>(OutlineDescription.Width);
+		bakeBatch.Begin(DirectX::SpriteSortMode_Deferred, outlineBlendState.Get(), pointSampler, nullptr, nullptr, setBakeShader);
+		for (int32_t offsetY = -radius; offsetY <= radius; offsetY++)
+		{
+			for (int32_t offsetX = -radius; offsetX <= radius; offsetX++)
+			{
+				if (offsetX * offsetX + offsetY * offsetY <= radius * radius + radius)
+				{
+					drawGlyphs(DirectX::XMINT2(offsetX + OutlineDescription.Offset.x, offsetY + OutlineDescription.Offset.y));
+				}
+			}
+		}
+		bakeBatch.End();
+
+		//Put back the caller's render target and viewport
+		deviceContext->OMSetRenderTargets(1u, previousRenderTarget.GetAddressOf(), previousDepthStencil.Get());
+		if (previousViewportCount > 0)
+		{
+			deviceContext->RSSetViewports(previousViewportCount, &previousViewport);
+		}
+	}
+
+	ID3D11ShaderResourceView* OutlinedFontAtlas::GetTexture() const noexcept
+	{
+		return AtlasTexture.Get();
+	}
+
+	const RECT& OutlinedFontAtlas::GetGlyphRectangle(wchar_t character) const
+	{
+		return GlyphRectangles.at(character);
+	}
+
+	uint32_t OutlinedFontAtlas::GetPadding() const noexcept
+	{
+		return Padding;
+	}
+
+	const TextOutlineDesc& OutlinedFontAtlas::GetOutlineDescription() const noexcept
+	{
+		return OutlineDescription;
+	}
+}
\ No newline at end of file
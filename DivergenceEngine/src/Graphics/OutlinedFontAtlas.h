@@ -0,0 +1,54 @@
+#pragma once
+#include <Windows.h>
+#include <d3d11.h>
+#include <wrl.h>
+#include <SpriteFont.h>
+#include <unordered_map>
+
+namespace DivergenceEngine
+{
+	//Describes the outline that gets baked around every glyph of a font. Giving it an offset turns it into a drop shadow
+	struct TextOutlineDesc
+	{
+		uint32_t Width = 1; //Radius of the outline in pixels
+		DirectX::XMINT2 Offset = DirectX::XMINT2(0, 0); //How far the outline is shifted from the glyph
+
+		bool operator==(const TextOutlineDesc& other) const noexcept
+		{
+			return Width == other.Width && Offset.x == other.Offset.x && Offset.y == other.Offset.y;
+		}
+	};
+
+	//A copy of a font's sprite sheet, where every glyph is padded and has two coverage channels: red is the glyph itself
+	//and green is the glyph dilated by the outline. This lets outlined and shadowed text be drawn with one sprite per glyph
+	class OutlinedFontAtlas
+	{
+	private:
+		//Constants
+		static constexpr uint32_t ATLAS_WIDTH = 2048;
+
+		//Datafields
+		const DirectX::SpriteFont* SourceFont;
+		TextOutlineDesc OutlineDescription;
+		uint32_t Padding;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> AtlasTexture;
+		std::unordered_map<wchar_t, RECT> GlyphRectangles;
+
+	public:
+		//Constructors and Destructors
+		OutlinedFontAtlas(ID3D11Device* device, ID3D11DeviceContext* deviceContext, ID3D11PixelShader* bakePixelShader, ID3D11SamplerState* pointSampler, const DirectX::SpriteFont* spriteFont, TextOutlineDesc outlineDescription);
+
+		//Deleted stuff
+		OutlinedFontAtlas(const OutlinedFontAtlas&) = delete;
+		OutlinedFontAtlas& operator=(const OutlinedFontAtlas&) = delete;
+
+		//Renders the atlas on the GPU. Must not be called while a sprite batch is mid draw on the same context
+		void Bake(ID3D11Device* device, ID3D11DeviceContext* deviceContext, ID3D11PixelShader* bakePixelShader, ID3D11SamplerState* pointSampler);
+
+		//Getters
+		ID3D11ShaderResourceView* GetTexture() const noexcept;
+		const RECT& GetGlyphRectangle(wchar_t character) const;
+		uint32_t GetPadding() const noexcept;
+		const TextOutlineDesc& GetOutlineDescription() const noexcept;
+	};
+}
\ No newline at end of file
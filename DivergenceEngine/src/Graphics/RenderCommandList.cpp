@@ -0,0 +1,30 @@
+#include "Graphics/RenderCommandList.h"
+
+namespace DivergenceEngine
+{
+	void RenderCommandList::Record(const SpriteCommand& spriteCommand)
+	{
+		Commands.push_back(spriteCommand);
+	}
+
+	void RenderCommandList::Append(const RenderCommandList& otherCommandList)
+	{
+		Commands.insert(Commands.end(), otherCommandList.Commands.begin(), otherCommandList.Commands.end());
+	}
+
+	//Keeps the memory, so a list reused every frame stops allocating once it has grown
+	void RenderCommandList::Clear() noexcept
+	{
+		Commands.clear();
+	}
+
+	const std::vector<SpriteCommand>& RenderCommandList::GetCommands() const noexcept
+	{
+		return Commands;
+	}
+
+	size_t RenderCommandList::GetSize() const noexcept
+	{
+		return Commands.size();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+#include <Windows.h>
+#include <d3d11.h>
+#include <SimpleMath.h>
+#include <cstdint>
+#include <vector>
+
+namespace DivergenceEngine
+{
+	//Pixel shaders a sprite can be drawn with
+	enum class SpriteShaderClass
+	{
+		Default,
+		OutlinedText,
+		DistanceFieldText,
+		StraightAlphaSprite //Premultiplies a straight alpha texture as it is sampled
+	};
+
+	//How the colour of a texture is stored
+	enum class TextureAlphaClass
+	{
+		Straight,
+		Premultiplied //Colour is already multiplied by alpha. Every texture and font the engine loads is stored this way by default
+	};
+
+	//Everything needed to draw one sprite later, without touching the device context
+	struct SpriteCommand
+	{
+		ID3D11ShaderResourceView* Texture = nullptr;
+		TextureAlphaClass TextureAlpha = TextureAlphaClass::Premultiplied;
+		SpriteShaderClass SpriteShader = SpriteShaderClass::Default;
+		DirectX::SimpleMath::Color Colour;
+		DirectX::SimpleMath::Color OutlineColour; //Only used by the text shaders
+		float OutlineThreshold = 0.5f; //Only used by the distance field shader
+
+		bool HasDestinationRectangle = false; //Draws into DestinationRectangle when set, otherwise at Position with Scale
+		RECT DestinationRectangle = {};
+		DirectX::SimpleMath::Vector2 Position;
+		DirectX::SimpleMath::Vector2 Scale = DirectX::SimpleMath::Vector2(1, 1);
+		float LayerDepth = 0.0f; //Only matters in layers sorted back to front or front to back
+
+		bool HasSourceRectangle = false;
+		RECT SourceRectangle = {};
+	};
+
+	//A list of sprites recorded by drawables. Lists can be recorded on any thread, since recording never touches the
+	//device context, and are then submitted to the Graphics controller on the render thread
+	class RenderCommandList
+	{
+	private:
+		//Datafields
+		std::vector<SpriteCommand> Commands;
+
+	public:
+		//Public functions
+		void Record(const SpriteCommand& spriteCommand);
+		void Append(const RenderCommandList& otherCommandList);
+		void Clear() noexcept;
+
+		//Getters
+		const std::vector<SpriteCommand>& GetCommands() const noexcept;
+		size_t GetSize() const noexcept;
+	};
+}
\ No newline at end of file
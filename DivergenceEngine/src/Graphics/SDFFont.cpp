@@ -0,0 +1,149 @@
+#include "Graphics/SDFFont.h"
+#include "DXComErrorHandler.h"
+#include "StringConverter.h"
+#include "Logger/Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+namespace DivergenceEngine
+{
+	namespace
+	{
+		template<typename T>
+		T ReadValue(std::ifstream& fileStream)
+		{
+			T value;
+			fileStream.read(reinterpret_cast<char*>(&value), sizeof(T));
+			if (!fileStream)
+			{
+				throw std::runtime_error("SDFFont::Load() - file ended unexpectedly");
+			}
+			return value;
+		}
+	}
+
+	SDFFont::SDFFont(ID3D11Device* device, const std::wstring& sdfFontPath) :
+		FilePath(sdfFontPath)
+	{
+		Load(device);
+	}
+
+	void SDFFont::Load(ID3D11Device* device)
+	{
+		const std::wstring& sdfFontPath = FilePath;
+		std::ifstream fileStream(sdfFontPath, std::ios::binary);
+		if (!fileStream)
+		{
+			throw std::invalid_argument(StringConverter::ConvertWideStringToANSI(std::format(L"SDFFont::Load() - '{}' cannot be opened", sdfFontPath)));
+		}
+
+		//Validate the header
+		char magic[sizeof(FILE_MAGIC)];
+		fileStream.read(magic, sizeof(magic));
+		if (!fileStream || std::memcmp(magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0)
+		{
+			throw std::invalid_argument(StringConverter::ConvertWideStringToANSI(std::format(L"SDFFont::Load() - '{}' is not an sdffont file", sdfFontPath)));
+		}
+
+		if (ReadValue<uint32_t>(fileStream) != FILE_VERSION)
+		{
+			throw std::invalid_argument(StringConverter::ConvertWideStringToANSI(std::format(L"SDFFont::Load() - '{}' has an unsupported version", sdfFontPath)));
+		}
+
+		BaseSize = ReadValue<float>(fileStream);
+		DistanceRange = ReadValue<float>(fileStream);
+		LineSpacing = ReadValue<float>(fileStream);
+		DefaultCharacter = ReadValue<uint32_t>(fileStream);
+		uint32_t glyphCount = ReadValue<uint32_t>(fileStream);
+		uint32_t atlasWidth = ReadValue<uint32_t>(fileStream);
+		uint32_t atlasHeight = ReadValue<uint32_t>(fileStream);
+
+		//Read the glyph table
+		Glyphs.clear();
+		Glyphs.reserve(glyphCount);
+		for (uint32_t index = 0; index < glyphCount; index++)
+		{
+			Glyph glyph;
+			glyph.Character = ReadValue<uint32_t>(fileStream);
+			glyph.Subrect.left = ReadValue<int32_t>(fileStream);
+			glyph.Subrect.top = ReadValue<int32_t>(fileStream);
+			glyph.Subrect.right = ReadValue<int32_t>(fileStream);
+			glyph.Subrect.bottom = ReadValue<int32_t>(fileStream);
+			glyph.XOffset = ReadValue<float>(fileStream);
+			glyph.YOffset = ReadValue<float>(fileStream);
+			glyph.XAdvance = ReadValue<float>(fileStream);
+			Glyphs.push_back(glyph);
+		}
+
+		//The glyphs are looked up with a binary search, so make sure they are in order
+		std::sort(Glyphs.begin(), Glyphs.end(), [](const Glyph& left, const Glyph& right) { return left.Character < right.Character; });
+
+		//Read the distance field straight into a single channel texture
+		std::vector<uint8_t> atlasData(static_cast<size_t>(atlasWidth) * atlasHeight);
+		fileStream.read(reinterpret_cast<char*>(atlasData.data()), atlasData.size());
+		if (!fileStream)
+		{
+			throw std::invalid_argument(StringConverter::ConvertWideStringToANSI(std::format(L"SDFFont::Load() - '{}' atlas is truncated", sdfFontPath)));
+		}
+
+		CD3D11_TEXTURE2D_DESC atlasDescription(DXGI_FORMAT_R8_UNORM, atlasWidth, atlasHeight, 1, 1, D3D11_BIND_SHADER_RESOURCE, D3D11_USAGE_IMMUTABLE);
+		D3D11_SUBRESOURCE_DATA atlasSubresource = {};
+		atlasSubresource.pSysMem = atlasData.data();
+		atlasSubresource.SysMemPitch = atlasWidth;
+
+		Microsoft::WRL::ComPtr<ID3D11Texture2D> atlasResource;
+		DX::ThrowIfFailed(device->CreateTexture2D(&atlasDescription, &atlasSubresource, &atlasResource));
+		DX::ThrowIfFailed(device->CreateShaderResourceView(atlasResource.Get(), nullptr, AtlasTexture.ReleaseAndGetAddressOf()));
+
+		DIVERGENCE_LOG_DEBUG(L"SDF font loaded from file: {}", FilePath);
+	}
+
+	const SDFFont::Glyph* SDFFont::FindGlyph(wchar_t character) const
+	{
+		auto findCharacter = [this](uint32_t character) -> const Glyph*
+			{
+				auto glyphIterator = std::lower_bound(Glyphs.begin(), Glyphs.end(), character, [](const Glyph& glyph, uint32_t value) { return glyph.Character < value; });
+				if (glyphIterator != Glyphs.end() && glyphIterator->Character == character)
+				{
+					return &(*glyphIterator);
+				}
+				return nullptr;
+			};
+
+		//Fall back to the default character when the font does not have the one requested
+		const Glyph* glyph = findCharacter(static_cast<uint32_t>(character));
+		if (glyph == nullptr)
+		{
+			glyph = findCharacter(DefaultCharacter);
+		}
+
+		if (glyph == nullptr)
+		{
+			throw std::out_of_range("SDFFont::FindGlyph() - character not in font and the font has no default character");
+		}
+		return glyph;
+	}
+
+	float SDFFont::GetBaseSize() const noexcept
+	{
+		return BaseSize;
+	}
+
+	float SDFFont::GetDistanceRange() const noexcept
+	{
+		return DistanceRange;
+	}
+
+	float SDFFont::GetLineSpacing() const noexcept
+	{
+		return LineSpacing;
+	}
+
+	ID3D11ShaderResourceView* SDFFont::GetTexture() const noexcept
+	{
+		return AtlasTexture.Get();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+#include <Windows.h>
+#include <d3d11.h>
+#include <wrl.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+.sdffont file layout (little endian, tightly packed):
+
+Header
+	char[8]		Magic ("DESDFONT")
+	uint32_t	Version
+	float		BaseSize (pixel height the metrics and distances were generated at)
+	float		DistanceRange (how many pixels, at BaseSize, the distance field spreads out from the edge of a glyph)
+	float		LineSpacing
+	uint32_t	DefaultCharacter
+	uint32_t	GlyphCount
+	uint32_t	AtlasWidth
+	uint32_t	AtlasHeight
+
+GlyphCount x Glyph (sorted by Character)
+	uint32_t	Character
+	int32_t[4]	Subrect (left, top, right, bottom) of the padded glyph in the atlas
+	float		XOffset (from the pen position to the left of the subrect)
+	float		YOffset (from the top of the line to the top of the subrect)
+	float		XAdvance (how far the pen moves after this glyph)
+
+AtlasWidth x AtlasHeight x uint8_t
+	Distance field, where 128 is the edge of the glyph, higher is inside and lower is outside
+*/
+
+namespace DivergenceEngine
+{
+	//A font whose atlas stores signed distances instead of coverage, so one atlas can be drawn crisply at any size
+	class SDFFont
+	{
+	public:
+		struct Glyph
+		{
+			uint32_t Character;
+			RECT Subrect;
+			float XOffset;
+			float YOffset;
+			float XAdvance;
+		};
+
+		//Constants
+		static constexpr char FILE_MAGIC[8] = { 'D', 'E', 'S', 'D', 'F', 'O', 'N', 'T' };
+		static constexpr uint32_t FILE_VERSION = 1;
+
+	private:
+		//Datafields
+		std::wstring FilePath;
+		float BaseSize;
+		float DistanceRange;
+		float LineSpacing;
+		uint32_t DefaultCharacter;
+		std::vector<Glyph> Glyphs;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> AtlasTexture;
+
+	public:
+		//Constructors and Destructors
+		SDFFont(ID3D11Device* device, const std::wstring& sdfFontPath);
+
+		//Deleted stuff
+		SDFFont(const SDFFont&) = delete;
+		SDFFont& operator=(const SDFFont&) = delete;
+
+		//Reads the file again and makes the atlas on the given device, for when the old device was lost
+		void Load(ID3D11Device* device);
+
+		//Getters
+		const Glyph* FindGlyph(wchar_t character) const;
+		float GetBaseSize() const noexcept;
+		float GetDistanceRange() const noexcept;
+		float GetLineSpacing() const noexcept;
+		ID3D11ShaderResourceView* GetTexture() const noexcept;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,398 @@
+#define NOMINMAX
+#include "Graphics/SDFFontGenerator.h"
+#include "Graphics/SDFFont.h"
+#include "Logger/Logger.h"
+#include "StringConverter.h"
+#include <d3d11.h>
+#include <algorithm>
+#include <cmath>
+#include <cwchar>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+#pragma comment(lib, "gdi32.lib")
+
+namespace DivergenceEngine
+{
+	namespace
+	{
+		//A glyph whose distance field has been computed, waiting to be packed into the atlas
+		struct GeneratedGlyph
+		{
+			SDFFont::Glyph Metrics = {};
+			uint32_t Width = 0;
+			uint32_t Height = 0;
+			std::vector<uint8_t> Distances;
+		};
+
+		//Offset from a cell to the nearest seed cell found so far
+		struct SeedOffset
+		{
+			int32_t X;
+			int32_t Y;
+
+			int64_t DistanceSquared() const noexcept
+			{
+				return static_cast<int64_t>(X) * X + static_cast<int64_t>(Y) * Y;
+			}
+		};
+
+		//Owns the GDI objects used to rasterize the glyphs, so they are released even if generation throws
+		class ScopedFontContext
+		{
+		private:
+			HDC DeviceContext = nullptr;
+			HFONT Font = nullptr;
+			HGDIOBJ PreviousFont = nullptr;
+
+		public:
+			ScopedFontContext(const SDFFontGeneratorDesc& generatorDescription)
+			{
+				DeviceContext = CreateCompatibleDC(nullptr);
+				Font = CreateFontW(-static_cast<int>(std::lround(generatorDescription.BaseSize * generatorDescription.Upscale)), 0, 0, 0, generatorDescription.Weight,
+					FALSE, FALSE, FALSE, DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS, ANTIALIASED_QUALITY, DEFAULT_PITCH | FF_DONTCARE, generatorDescription.FaceName.c_str());
+				if (DeviceContext == nullptr || Font == nullptr)
+				{
+					Release();
+					throw std::runtime_error("SDFFontGenerator::Generate() - failed to create the GDI font");
+				}
+				PreviousFont = SelectObject(DeviceContext, Font);
+			}
+
+			~ScopedFontContext()
+			{
+				Release();
+			}
+
+			ScopedFontContext(const ScopedFontContext&) = delete;
+			ScopedFontContext& operator=(const ScopedFontContext&) = delete;
+
+			void Release() noexcept
+			{
+				if (PreviousFont != nullptr)
+				{
+					SelectObject(DeviceContext, PreviousFont);
+					PreviousFont = nullptr;
+				}
+				if (Font != nullptr)
+				{
+					DeleteObject(Font);
+					Font = nullptr;
+				}
+				if (DeviceContext != nullptr)
+				{
+					DeleteDC(DeviceContext);
+					DeviceContext = nullptr;
+				}
+			}
+
+			HDC Get() const noexcept
+			{
+				return DeviceContext;
+			}
+		};
+
+		template<typename T>
+		void WriteValue(std::ofstream& fileStream, const T& value)
+		{
+			fileStream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		//8SSEDT: two raster scans that carry each cell's offset to its nearest seed across the grid. Returns every cell's squared distance to its nearest seed
+		std::vector<int64_t> ComputeSquaredDistances(const std::vector<bool>& isSeed, int32_t width, int32_t height)
+		{
+			constexpr int32_t FAR_AWAY = 1 << 14;
+			std::vector<SeedOffset> offsets(isSeed.size());
+			for (size_t index = 0; index < isSeed.size(); index++)
+			{
+				offsets[index] = isSeed[index] ? SeedOffset{ 0, 0 } : SeedOffset{ FAR_AWAY, FAR_AWAY };
+			}
+
+			auto compare = [&](int32_t x, int32_t y, int32_t offsetX, int32_t offsetY)
+				{
+					int32_t neighbourX = x + offsetX;
+					int32_t neighbourY = y + offsetY;
+					if (neighbourX < 0 || neighbourY < 0 || neighbourX >= width || neighbourY >= height)
+					{
+						return;
+					}
+
+					//The neighbour's seed, seen from this cell
+					SeedOffset candidate = offsets[static_cast<size_t>(neighbourY) * width + neighbourX];
+					candidate.X += offsetX;
+					candidate.Y += offsetY;
+
+					SeedOffset& current = offsets[static_cast<size_t>(y) * width + x];
+					if (candidate.DistanceSquared() < current.DistanceSquared())
+					{
+						current = candidate;
+					}
+				};
+
+			//Top to bottom
+			for (int32_t y = 0; y < height; y++)
+			{
+				for (int32_t x = 0; x < width; x++)
+				{
+					compare(x, y, -1, 0);
+					compare(x, y, 0, -1);
+					compare(x, y, -1, -1);
+					compare(x, y, 1, -1);
+				}
+				for (int32_t x = width - 1; x >= 0; x--)
+				{
+					compare(x, y, 1, 0);
+				}
+			}
+
+			//Bottom to top
+			for (int32_t y = height - 1; y >= 0; y--)
+			{
+				for (int32_t x = width - 1; x >= 0; x--)
+				{
+					compare(x, y, 1, 0);
+					compare(x, y, 0, 1);
+					compare(x, y, -1, 1);
+					compare(x, y, 1, 1);
+				}
+				for (int32_t x = 0; x < width; x++)
+				{
+					compare(x, y, -1, 0);
+				}
+			}
+
+			std::vector<int64_t> squaredDistances(offsets.size());
+			for (size_t index = 0; index < offsets.size(); index++)
+			{
+				squaredDistances[index] = offsets[index].DistanceSquared();
+			}
+			return squaredDistances;
+		}
+
+		GeneratedGlyph GenerateGlyph(HDC deviceContext, wchar_t character, const TEXTMETRICW& textMetrics, const SDFFontGeneratorDesc& generatorDescription)
+		{
+			const MAT2 identity = { { 0, 1 }, { 0, 0 }, { 0, 0 }, { 0, 1 } };
+			const int32_t upscale = static_cast<int32_t>(generatorDescription.Upscale);
+			const int32_t padding = static_cast<int32_t>(std::ceil(generatorDescription.DistanceRange));
+			const int32_t highResolutionPadding = padding * upscale;
+
+			GeneratedGlyph generatedGlyph;
+			generatedGlyph.Metrics.Character = static_cast<uint32_t>(character);
+
+			GLYPHMETRICS glyphMetrics = {};
+			DWORD bufferSize = GetGlyphOutlineW(deviceContext, character, GGO_GRAY8_BITMAP, &glyphMetrics, 0, nullptr, &identity);
+			if (bufferSize == GDI_ERROR)
+			{
+				throw std::runtime_error(std::format("SDFFontGenerator::Generate() - failed to rasterize character {}", static_cast<uint32_t>(character)));
+			}
+			generatedGlyph.Metrics.XAdvance = static_cast<float>(glyphMetrics.gmCellIncX) / upscale;
+
+			//Blank glyphs (like spaces) only move the pen
+			if (bufferSize == 0)
+			{
+				return generatedGlyph;
+			}
+
+			std::vector<uint8_t> coverage(bufferSize);
+			if (GetGlyphOutlineW(deviceContext, character, GGO_GRAY8_BITMAP, &glyphMetrics, bufferSize, coverage.data(), &identity) == GDI_ERROR)
+			{
+				throw std::runtime_error(std::format("SDFFontGenerator::Generate() - failed to rasterize character {}", static_cast<uint32_t>(character)));
+			}
+
+			//GGO_GRAY8_BITMAP rows are DWORD aligned and hold 65 levels of coverage (0 to 64)
+			const int32_t blackBoxWidth = static_cast<int32_t>(glyphMetrics.gmBlackBoxX);
+			const int32_t blackBoxHeight = static_cast<int32_t>(glyphMetrics.gmBlackBoxY);
+			const int32_t coveragePitch = (blackBoxWidth + 3) & ~3;
+
+			//Every atlas texel covers upscale x upscale pixels of the rasterized glyph, and the glyph is padded on every side for the field to spread into
+			generatedGlyph.Width = static_cast<uint32_t>((blackBoxWidth + upscale - 1) / upscale + 2 * padding);
+			generatedGlyph.Height = static_cast<uint32_t>((blackBoxHeight + upscale - 1) / upscale + 2 * padding);
+			const int32_t gridWidth = static_cast<int32_t>(generatedGlyph.Width) * upscale;
+			const int32_t gridHeight = static_cast<int32_t>(generatedGlyph.Height) * upscale;
+
+			std::vector<bool> isInside(static_cast<size_t>(gridWidth) * gridHeight, false);
+			std::vector<bool> isOutside(isInside.size(), true);
+			for (int32_t y = 0; y < blackBoxHeight; y++)
+			{
+				for (int32_t x = 0; x < blackBoxWidth; x++)
+				{
+					if (coverage[static_cast<size_t>(y) * coveragePitch + x] >= 32)
+					{
+						size_t gridIndex = static_cast<size_t>(y + highResolutionPadding) * gridWidth + x + highResolutionPadding;
+						isInside[gridIndex] = true;
+						isOutside[gridIndex] = false;
+					}
+				}
+			}
+
+			std::vector<int64_t> distancesToInside = ComputeSquaredDistances(isInside, gridWidth, gridHeight);
+			std::vector<int64_t> distancesToOutside = ComputeSquaredDistances(isOutside, gridWidth, gridHeight);
+
+			//Sample the signed distance at the centre of every atlas texel, and map DistanceRange either side of the edge onto 0 to 1
+			generatedGlyph.Distances.resize(static_cast<size_t>(generatedGlyph.Width) * generatedGlyph.Height);
+			const float distanceScale = 1.0f / (upscale * 2.0f * generatorDescription.DistanceRange);
+			for (uint32_t texelY = 0; texelY < generatedGlyph.Height; texelY++)
+			{
+				for (uint32_t texelX = 0; texelX < generatedGlyph.Width; texelX++)
+				{
+					size_t gridIndex = static_cast<size_t>(texelY * upscale + upscale / 2) * gridWidth + texelX * upscale + upscale / 2;
+
+					//Distances are between pixel centres, and the edge lies half a pixel between the last inside and first outside pixel
+					float signedDistance = isInside[gridIndex] ?
+						std::sqrt(static_cast<float>(distancesToOutside[gridIndex])) - 0.5f :
+						0.5f - std::sqrt(static_cast<float>(distancesToInside[gridIndex]));
+
+					float normalizedDistance = std::clamp(0.5f + signedDistance * distanceScale, 0.0f, 1.0f);
+					generatedGlyph.Distances[static_cast<size_t>(texelY) * generatedGlyph.Width + texelX] = static_cast<uint8_t>(std::lround(normalizedDistance * 255.0f));
+				}
+			}
+
+			//Offsets are to the padded rectangle, in BaseSize pixels
+			generatedGlyph.Metrics.XOffset = static_cast<float>(glyphMetrics.gmptGlyphOrigin.x) / upscale - padding;
+			generatedGlyph.Metrics.YOffset = static_cast<float>(textMetrics.tmAscent - glyphMetrics.gmptGlyphOrigin.y) / upscale - padding;
+			return generatedGlyph;
+		}
+	}
+
+	void SDFFontGenerator::Generate(const SDFFontGeneratorDesc& generatorDescription, const std::wstring& outputPath)
+	{
+		if (generatorDescription.BaseSize <= 0 || generatorDescription.DistanceRange <= 0 || generatorDescription.Upscale == 0)
+		{
+			throw std::invalid_argument("SDFFontGenerator::Generate() - BaseSize, DistanceRange and Upscale must all be positive");
+		}
+
+		ScopedFontContext fontContext(generatorDescription);
+
+		//GDI quietly substitutes another font when the face is not installed, which is never what is wanted here
+		wchar_t selectedFaceName[LF_FACESIZE] = {};
+		GetTextFaceW(fontContext.Get(), LF_FACESIZE, selectedFaceName);
+		if (_wcsicmp(selectedFaceName, generatorDescription.FaceName.c_str()) != 0)
+		{
+			throw std::invalid_argument(StringConverter::ConvertWideStringToANSI(std::format(L"SDFFontGenerator::Generate() - font '{}' is not installed", generatorDescription.FaceName)));
+		}
+
+		TEXTMETRICW textMetrics = {};
+		GetTextMetricsW(fontContext.Get(), &textMetrics);
+
+		//Generate every character in the ranges that the font actually has
+		std::vector<GeneratedGlyph> generatedGlyphs;
+		for (const auto& [firstCharacter, lastCharacter] : generatorDescription.CharacterRanges)
+		{
+			for (uint32_t character = firstCharacter; character <= lastCharacter; character++)
+			{
+				wchar_t wideCharacter = static_cast<wchar_t>(character);
+				WORD glyphIndex = 0;
+				if (GetGlyphIndicesW(fontContext.Get(), &wideCharacter, 1, &glyphIndex, GGI_MARK_NONEXISTING_GLYPHS) == GDI_ERROR || glyphIndex == 0xFFFF)
+				{
+					continue;
+				}
+
+				generatedGlyphs.push_back(GenerateGlyph(fontContext.Get(), wideCharacter, textMetrics, generatorDescription));
+			}
+		}
+
+		//Overlapping ranges would otherwise produce the same character twice
+		std::sort(generatedGlyphs.begin(), generatedGlyphs.end(), [](const GeneratedGlyph& left, const GeneratedGlyph& right) { return left.Metrics.Character < right.Metrics.Character; });
+		generatedGlyphs.erase(std::unique(generatedGlyphs.begin(), generatedGlyphs.end(), [](const GeneratedGlyph& left, const GeneratedGlyph& right) { return left.Metrics.Character == right.Metrics.Character; }), generatedGlyphs.end());
+
+		const uint32_t defaultCharacter = static_cast<uint32_t>(generatorDescription.DefaultCharacter);
+		if (std::none_of(generatedGlyphs.begin(), generatedGlyphs.end(), [defaultCharacter](const GeneratedGlyph& generatedGlyph) { return generatedGlyph.Metrics.Character == defaultCharacter; }))
+		{
+			throw std::invalid_argument("SDFFontGenerator::Generate() - the default character is not in the character ranges or the font");
+		}
+
+		//Shelf pack the tallest glyphs first, leaving one empty texel between them so filtering never bleeds between glyphs
+		std::vector<GeneratedGlyph*> packingOrder;
+		packingOrder.reserve(generatedGlyphs.size());
+		for (GeneratedGlyph& generatedGlyph : generatedGlyphs)
+		{
+			if (generatedGlyph.Width > 0)
+			{
+				packingOrder.push_back(&generatedGlyph);
+			}
+		}
+		std::stable_sort(packingOrder.begin(), packingOrder.end(), [](const GeneratedGlyph* left, const GeneratedGlyph* right) { return left->Height > right->Height; });
+
+		uint32_t cursorX = 0;
+		uint32_t cursorY = 0;
+		uint32_t rowHeight = 0;
+		for (GeneratedGlyph* generatedGlyph : packingOrder)
+		{
+			if (generatedGlyph->Width > ATLAS_WIDTH)
+			{
+				throw std::runtime_error("SDFFontGenerator::Generate() - a glyph is wider than the atlas. Lower the BaseSize");
+			}
+
+			if (cursorX + generatedGlyph->Width > ATLAS_WIDTH)
+			{
+				cursorX = 0;
+				cursorY += rowHeight + 1;
+				rowHeight = 0;
+			}
+
+			generatedGlyph->Metrics.Subrect.left = static_cast<LONG>(cursorX);
+			generatedGlyph->Metrics.Subrect.top = static_cast<LONG>(cursorY);
+			generatedGlyph->Metrics.Subrect.right = static_cast<LONG>(cursorX + generatedGlyph->Width);
+			generatedGlyph->Metrics.Subrect.bottom = static_cast<LONG>(cursorY + generatedGlyph->Height);
+
+			cursorX += generatedGlyph->Width + 1;
+			rowHeight = std::max(rowHeight, generatedGlyph->Height);
+		}
+
+		uint32_t atlasHeight = std::max(cursorY + rowHeight, 1u);
+		if (atlasHeight > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION)
+		{
+			throw std::runtime_error("SDFFontGenerator::Generate() - too many glyphs to fit in one atlas. Lower the BaseSize or use fewer characters");
+		}
+
+		std::vector<uint8_t> atlas(static_cast<size_t>(ATLAS_WIDTH) * atlasHeight, 0);
+		for (const GeneratedGlyph* generatedGlyph : packingOrder)
+		{
+			for (uint32_t row = 0; row < generatedGlyph->Height; row++)
+			{
+				std::copy_n(
+					generatedGlyph->Distances.begin() + static_cast<size_t>(row) * generatedGlyph->Width,
+					generatedGlyph->Width,
+					atlas.begin() + static_cast<size_t>(generatedGlyph->Metrics.Subrect.top + row) * ATLAS_WIDTH + generatedGlyph->Metrics.Subrect.left);
+			}
+		}
+
+		//Write the file out in the layout SDFFont reads
+		std::ofstream fileStream(outputPath, std::ios::binary);
+		if (!fileStream)
+		{
+			throw std::invalid_argument(StringConverter::ConvertWideStringToANSI(std::format(L"SDFFontGenerator::Generate() - '{}' cannot be written to", outputPath)));
+		}
+
+		fileStream.write(SDFFont::FILE_MAGIC, sizeof(SDFFont::FILE_MAGIC));
+		WriteValue(fileStream, SDFFont::FILE_VERSION);
+		WriteValue(fileStream, generatorDescription.BaseSize);
+		WriteValue(fileStream, generatorDescription.DistanceRange);
+		WriteValue(fileStream, static_cast<float>(textMetrics.tmHeight + textMetrics.tmExternalLeading) / generatorDescription.Upscale);
+		WriteValue(fileStream, defaultCharacter);
+		WriteValue(fileStream, static_cast<uint32_t>(generatedGlyphs.size()));
+		WriteValue(fileStream, ATLAS_WIDTH);
+		WriteValue(fileStream, atlasHeight);
+
+		for (const GeneratedGlyph& generatedGlyph : generatedGlyphs)
+		{
+			WriteValue(fileStream, generatedGlyph.Metrics.Character);
+			WriteValue(fileStream, static_cast<int32_t>(generatedGlyph.Metrics.Subrect.left));
+			WriteValue(fileStream, static_cast<int32_t>(generatedGlyph.Metrics.Subrect.top));
+			WriteValue(fileStream, static_cast<int32_t>(generatedGlyph.Metrics.Subrect.right));
+			WriteValue(fileStream, static_cast<int32_t>(generatedGlyph.Metrics.Subrect.bottom));
+			WriteValue(fileStream, generatedGlyph.Metrics.XOffset);
+			WriteValue(fileStream, generatedGlyph.Metrics.YOffset);
+			WriteValue(fileStream, generatedGlyph.Metrics.XAdvance);
+		}
+
+		fileStream.write(reinterpret_cast<const char*>(atlas.data()), atlas.size());
+		if (!fileStream)
+		{
+			throw std::runtime_error(StringConverter::ConvertWideStringToANSI(std::format(L"SDFFontGenerator::Generate() - failed while writing '{}'", outputPath)));
+		}
+
+		DIVERGENCE_LOG_INFO(L"SDF font generated with {} glyphs: {}", generatedGlyphs.size(), outputPath);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+#include <Windows.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace DivergenceEngine
+{
+	//Describes the .sdffont that gets generated from an installed font
+	struct SDFFontGeneratorDesc
+	{
+		std::wstring FaceName; //Name of the installed font, for example "M PLUS 1"
+		int Weight = FW_NORMAL;
+		float BaseSize = 48.0f; //Pixel height of an em in the atlas. Text looks crisp well above and below this
+		float DistanceRange = 6.0f; //How many pixels, at BaseSize, the field spreads out from the edge of a glyph. Also caps the outline width
+		uint32_t Upscale = 8; //Glyphs are rasterized this many times larger than BaseSize, so the distances are measured precisely
+		std::vector<std::pair<wchar_t, wchar_t>> CharacterRanges = { { L' ', L'~' } }; //Inclusive ranges of characters to put in the atlas
+		wchar_t DefaultCharacter = L'?';
+	};
+
+	//Builds .sdffont files (see SDFFont.h for the layout) out of fonts installed on the machine. This is meant to be run
+	//once, ahead of time, like MakeSpriteFont is for .spritefont files
+	class SDFFontGenerator
+	{
+	private:
+		//Constants
+		static constexpr uint32_t ATLAS_WIDTH = 1024;
+
+	public:
+		//Deleted stuff
+		SDFFontGenerator() = delete;
+
+		//Public functions
+		static void Generate(const SDFFontGeneratorDesc& generatorDescription, const std::wstring& outputPath);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+//HLSL source for the custom SpriteBatch pixel shaders. They are compiled once at runtime by the Graphics controller.
+//SpriteBatch's vertex shader outputs COLOR0 and TEXCOORD0 (in that order), so every pixel shader here takes those as its input.
+
+namespace DivergenceEngine::ShaderSources
+{
+	//Writes the coverage (alpha) of the sampled glyph into every channel. The blend state chooses which channel it lands in
+	inline constexpr const char* OutlineBakePixelShader = R"(
+Texture2D<float4> SpriteSheet : register(t0);
+SamplerState SpriteSampler : register(s0);
+
+float4 main(float4 colour : COLOR0, float2 texCoord : TEXCOORD0) : SV_Target0
+{
+	float coverage = SpriteSheet.Sample(SpriteSampler, texCoord).a;
+	return float4(coverage, coverage, coverage, coverage);
+}
+)";
+
+	//Draws a glyph and its outline in one pass. Red is the glyph coverage, green is the outline coverage.
+	//The fill colour comes from the sprite's colour and the outline colour from the constant buffer, both as straight alpha.
+	//The text shaders output premultiplied colour unless the layer blends with straight alpha
+	inline constexpr const char* OutlinedTextPixelShader = R"(
+Texture2D<float2> OutlineAtlas : register(t0);
+SamplerState SpriteSampler : register(s0);
+
+cbuffer TextParameters : register(b0)
+{
+	float4 OutlineColour;
+	float OutlineThreshold;
+	float OutputPremultiplied;
+};
+
+float4 main(float4 colour : COLOR0, float2 texCoord : TEXCOORD0) : SV_Target0
+{
+	float2 coverage = OutlineAtlas.Sample(SpriteSampler, texCoord);
+
+	//Composite the fill over the outline
+	float fillAlpha = coverage.r * colour.a;
+	float outlineAlpha = coverage.g * OutlineColour.a * (1.0f - fillAlpha);
+	float alpha = fillAlpha + outlineAlpha;
+	float3 rgb = (colour.rgb * fillAlpha + OutlineColour.rgb * outlineAlpha) / max(alpha, 0.0001f);
+
+	return float4(rgb * lerp(1.0f, alpha, OutputPremultiplied), alpha);
+}
+)";
+
+	//Draws a glyph from a signed distance field atlas, where 0.5 is the edge of the glyph. The edge is smoothed over one screen
+	//pixel whatever the scale, and an outline is drawn between OutlineThreshold and the edge when the outline colour is visible
+	inline constexpr const char* DistanceFieldTextPixelShader = R"(
+Texture2D<float> DistanceAtlas : register(t0);
+SamplerState SpriteSampler : register(s0);
+
+cbuffer TextParameters : register(b0)
+{
+	float4 OutlineColour;
+	float OutlineThreshold;
+	float OutputPremultiplied;
+};
+
+float4 main(float4 colour : COLOR0, float2 texCoord : TEXCOORD0) : SV_Target0
+{
+	float distance = DistanceAtlas.Sample(SpriteSampler, texCoord);
+	float smoothing = max(fwidth(distance) * 0.5f, 0.0001f);
+
+	//Composite the fill over the outline
+	float fillAlpha = smoothstep(0.5f - smoothing, 0.5f + smoothing, distance) * colour.a;
+	float outlineAlpha = smoothstep(OutlineThreshold - smoothing, OutlineThreshold + smoothing, distance) * OutlineColour.a * (1.0f - fillAlpha);
+	float alpha = fillAlpha + outlineAlpha;
+	float3 rgb = (colour.rgb * fillAlpha + OutlineColour.rgb * outlineAlpha) / max(alpha, 0.0001f);
+
+	return float4(rgb * lerp(1.0f, alpha, OutputPremultiplied), alpha);
+}
+)";
+
+	//Draws a straight alpha texture into a premultiplied blend. The sprite colour is expected to be premultiplied already
+	inline constexpr const char* StraightAlphaSpritePixelShader = R"(
+Texture2D<float4> SpriteTexture : register(t0);
+SamplerState SpriteSampler : register(s0);
+
+float4 main(float4 colour : COLOR0, float2 texCoord : TEXCOORD0) : SV_Target0
+{
+	float4 texel = SpriteTexture.Sample(SpriteSampler, texCoord);
+	return float4(texel.rgb * texel.a, texel.a) * colour;
+}
+)";
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "Logger/LogSinks.h"
+#include "StringConverter.h"
+#include <Windows.h>
+#include <cstdio>
+#include <format>
+#include <stdexcept>
+
+namespace DivergenceEngine
+{
+	//DebuggerLogSink------------------------------------------------------------------------------
+	void DebuggerLogSink::Write(const LogRecord& record, const std::wstring& formattedLine)
+	{
+		OutputDebugString(formattedLine.c_str());
+	}
+
+	//ConsoleLogSink-------------------------------------------------------------------------------
+	void ConsoleLogSink::Write(const LogRecord& record, const std::wstring& formattedLine)
+	{
+		std::string utf8Line = StringConverter::ConvertWideStringToUTF8(formattedLine);
+		std::fwrite(utf8Line.data(), 1, utf8Line.size(), stdout);
+	}
+
+	void ConsoleLogSink::Flush()
+	{
+		std::fflush(stdout);
+	}
+
+	//FileLogSink----------------------------------------------------------------------------------
+	FileLogSink::FileLogSink(const std::filesystem::path& filePath):
+		LogFile(filePath, std::ios::out | std::ios::trunc | std::ios::binary)
+	{
+		if (!LogFile.is_open())
+		{
+			throw std::runtime_error(std::format("FileLogSink::FileLogSink() - Could not open {}", filePath.string()));
+		}
+	}
+
+	void FileLogSink::Write(const LogRecord& record, const std::wstring& formattedLine)
+	{
+		LogFile << StringConverter::ConvertWideStringToUTF8(formattedLine);
+	}
+
+	void FileLogSink::Flush()
+	{
+		LogFile.flush();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+namespace DivergenceEngine
+{
+	enum class LogLevel : uint8_t
+	{
+		Trace,
+		Debug,
+		Info,
+		Warning,
+		Error,
+		Off //Only used as a minimum level, to turn logging off
+	};
+
+	//A log as it was queued. The file and function names point at the static strings made by std::source_location, so nothing
+	//about where the log came from is copied or converted until it is written
+	struct LogRecord
+	{
+		//Constants
+		static constexpr size_t DEFERRED_ARGUMENT_SLOTS = 8;
+		static constexpr size_t DEFERRED_ARGUMENT_SLOT_SIZE = 8;
+
+		LogLevel Level = LogLevel::Info;
+		bool IsRaw = false; //Raw logs are written as they are, without a prefix
+		uint64_t Sequence = 0; //Order the log was queued in, across every thread
+		uint32_t Line = 0;
+		uint32_t Column = 0;
+		uint32_t ThreadID = 0;
+		const char* FileName = nullptr;
+		const char* FunctionName = nullptr;
+		std::chrono::system_clock::time_point Time; //When it was queued, written out in UTC
+		std::wstring Message;
+
+		//Set when the message is only made on the logging thread. The format string is a literal and the arguments are plain values
+		//copied into the record, so nothing is formatted or allocated by the thread that logs
+		std::wstring_view DeferredFormat;
+		void (*FormatDeferredMessage)(const LogRecord& record, std::wstring& message) = nullptr;
+		std::array<std::byte, DEFERRED_ARGUMENT_SLOTS * DEFERRED_ARGUMENT_SLOT_SIZE> DeferredArguments;
+	};
+
+	//Somewhere formatted logs are written. Sinks are only ever called from the logging thread
+	class ILogSink
+	{
+	public:
+		virtual ~ILogSink() {};
+
+		/// <summary>
+		/// Writes one log.
+		/// </summary>
+		/// <param name="record">The log, for sinks that want its fields</param>
+		/// <param name="formattedLine">The log formatted as a line of text, ending in a newline</param>
+		virtual void Write(const LogRecord& record, const std::wstring& formattedLine) = 0;
+
+		/// <summary>
+		/// Makes sure everything written so far has reached its destination.
+		/// </summary>
+		virtual void Flush() {};
+	};
+
+	//Writes to the debugger's output window
+	class DebuggerLogSink : public ILogSink
+	{
+	public:
+		void Write(const LogRecord& record, const std::wstring& formattedLine) override;
+	};
+
+	//Writes to the standard output as UTF-8
+	class ConsoleLogSink : public ILogSink
+	{
+	public:
+		void Write(const LogRecord& record, const std::wstring& formattedLine) override;
+		void Flush() override;
+	};
+
+	//Writes to a file as UTF-8, replacing whatever the file had
+	class FileLogSink : public ILogSink
+	{
+	private:
+		//Datafields
+		std::ofstream LogFile;
+
+	public:
+		//Constructors and Destructors
+		FileLogSink(const std::filesystem::path& filePath);
+
+		//Overriden functions
+		void Write(const LogRecord& record, const std::wstring& formattedLine) override;
+		void Flush() override;
+	};
+}
\ No newline at end of file
@@ -1,32 +1,316 @@
 #include "Logger.h"
 #include <Windows.h>
+#include <algorithm>
+#include <chrono>
 #include <format>
-#include <filesystem>
+#include <string_view>
+#include <unordered_map>
 #include <StringConverter.h>
 
 //https://en.cppreference.com/w/cpp/utility/source_location
 
-namespace fs = std::filesystem;
-
 namespace DivergenceEngine
 {
+	//Logging functions----------------------------------------------------------------------------
 	void Logger::Log(std::wstring message, std::source_location location)
 	{
-		std::wstring output = std::format(L"DIVERGENCE ENGINE: File: {} ({}:{}) '{}': {}\n", 
-			DivergenceEngine::StringConverter::ConvertNarrowStringToWideString(fs::path(location.file_name()).filename().string()),
-			location.line(), 
-			location.column(), 
-			DivergenceEngine::StringConverter::ConvertNarrowStringToWideString(location.function_name()),
-			message);
+		Log(LogLevel::Info, std::move(message), location);
+	}
+
+	void Logger::Log(LogLevel level, std::wstring message, std::source_location location)
+	{
+		if (!IsLevelEnabled(level))
+		{
+			return;
+		}
 
-		OutputDebugString(output.c_str());
+		LogRecord record = MakeRecord(level, location);
+		record.Message = std::move(message);
+		Enqueue(std::move(record));
 	}
 
 	void Logger::RawLog(std::wstring message)
 	{
-		message += '\n';
-		OutputDebugString(message.c_str());
+		LogRecord record;
+		record.IsRaw = true;
+		record.Message = std::move(message);
+		Enqueue(std::move(record));
+	}
+
+	//Level functions------------------------------------------------------------------------------
+	void Logger::SetMinimumLevel(LogLevel level) noexcept
+	{
+		MinimumLevel.store(level, std::memory_order_relaxed);
+	}
+
+	LogLevel Logger::GetMinimumLevel() noexcept
+	{
+		return MinimumLevel.load(std::memory_order_relaxed);
+	}
+
+	//Sink functions-------------------------------------------------------------------------------
+	void Logger::AddSink(std::shared_ptr<ILogSink> sink)
+	{
+		std::lock_guard<std::mutex> sinksLock(SinksMutex);
+		Sinks.push_back(std::move(sink));
+	}
+
+	void Logger::ClearSinks()
+	{
+		std::lock_guard<std::mutex> sinksLock(SinksMutex);
+		Sinks.clear();
 	}
 
-	
-}
\ No newline at end of file
+	void Logger::Flush()
+	{
+		if (!IsRunning)
+		{
+			return;
+		}
+
+		uint64_t recordsToWrite = RecordsQueued.load(std::memory_order_acquire);
+		uint64_t recordsWritten = RecordsWritten.load(std::memory_order_acquire);
+		while (recordsWritten < recordsToWrite)
+		{
+			RecordsWritten.wait(recordsWritten, std::memory_order_acquire);
+			recordsWritten = RecordsWritten.load(std::memory_order_acquire);
+		}
+
+		std::lock_guard<std::mutex> sinksLock(SinksMutex);
+		for (std::shared_ptr<ILogSink>& sink : Sinks)
+		{
+			sink->Flush();
+		}
+	}
+
+	//Everything queued before this is still written. Anything logged after it is dropped
+	void Logger::Shutdown()
+	{
+		if (IsShutDown.exchange(true))
+		{
+			return;
+		}
+
+		if (IsRunning.exchange(false))
+		{
+			WakeCounter.fetch_add(1, std::memory_order_release);
+			WakeCounter.notify_one();
+			LoggingThread.join();
+		}
+	}
+
+	//Getters--------------------------------------------------------------------------------------
+	uint64_t Logger::GetRecordsDropped() noexcept
+	{
+		return RecordsDropped.load(std::memory_order_relaxed);
+	}
+
+	//Helpers--------------------------------------------------------------------------------------
+	LogRecord Logger::MakeRecord(LogLevel level, std::source_location location)
+	{
+		LogRecord record;
+		record.Level = level;
+		record.Line = location.line();
+		record.Column = location.column();
+		record.FileName = location.file_name();
+		record.FunctionName = location.function_name();
+		return record;
+	}
+
+	Logger::RecordRing& Logger::GetThreadRing()
+	{
+		//Registered the first time the thread logs. The logger keeps its own reference, so logs from a thread that has exited
+		//are still written
+		thread_local std::shared_ptr<RecordRing> threadRing = []()
+			{
+				std::shared_ptr<RecordRing> newThreadRing = std::make_shared<RecordRing>();
+				std::lock_guard<std::mutex> ringsLock(RingsMutex);
+				Rings.push_back(newThreadRing);
+				return newThreadRing;
+			}();
+		return *threadRing;
+	}
+
+	void Logger::Enqueue(LogRecord&& record)
+	{
+		if (IsShutDown)
+		{
+			RecordsDropped++;
+			return;
+		}
+		std::call_once(StartFlag, Start);
+
+		thread_local uint32_t threadID = GetCurrentThreadId();
+		record.ThreadID = threadID;
+		record.Time = std::chrono::system_clock::now();
+		record.Sequence = RecordsQueued.fetch_add(1, std::memory_order_acq_rel);
+
+		//When the ring is full, the log is dropped instead of waiting on the background thread. It still counts as written,
+		//so a flush does not wait for it
+		RecordRing& ring = GetThreadRing();
+		uint64_t head = ring.Head.load(std::memory_order_relaxed);
+		if (head - ring.Tail.load(std::memory_order_acquire) == RING_CAPACITY)
+		{
+			RecordsDropped++;
+			RecordsWritten.fetch_add(1, std::memory_order_acq_rel);
+			RecordsWritten.notify_all();
+			return;
+		}
+
+		bool isError = !record.IsRaw && record.Level >= LogLevel::Error;
+		ring.Records[head % RING_CAPACITY] = std::move(record);
+		ring.Head.store(head + 1, std::memory_order_release);
+		WakeCounter.fetch_add(1, std::memory_order_release);
+		WakeCounter.notify_one();
+
+		//Errors are often the last thing logged before an exception or a crash, so they are waited on until they are written
+		if (isError)
+		{
+			Flush();
+		}
+	}
+
+	void Logger::Start()
+	{
+		//Logs go to the debugger, like they always have, unless sinks were set up before the first log
+		{
+			std::lock_guard<std::mutex> sinksLock(SinksMutex);
+			if (Sinks.empty())
+			{
+				Sinks.push_back(std::make_shared<DebuggerLogSink>());
+			}
+		}
+
+		IsRunning = true;
+		LoggingThread = std::thread(&Logger::LoggingThreadFunction);
+	}
+
+	void Logger::LoggingThreadFunction()
+	{
+		SetThreadDescription(GetCurrentThread(), L"Logger");
+		while (true)
+		{
+			//Read the counter before writing, so a log queued while writing wakes the wait straight away
+			uint32_t wakeCount = WakeCounter.load(std::memory_order_acquire);
+			WriteQueuedRecords();
+
+			if (!IsRunning)
+			{
+				WriteQueuedRecords();
+				std::lock_guard<std::mutex> sinksLock(SinksMutex);
+				for (std::shared_ptr<ILogSink>& sink : Sinks)
+				{
+					sink->Flush();
+				}
+				return;
+			}
+
+			WakeCounter.wait(wakeCount, std::memory_order_acquire);
+		}
+	}
+
+	size_t Logger::WriteQueuedRecords()
+	{
+		std::vector<LogRecord> records;
+		{
+			std::lock_guard<std::mutex> ringsLock(RingsMutex);
+			for (size_t index = 0; index < Rings.size();)
+			{
+				//Rings only held by the logger belong to threads that have exited, so nothing more can come. This has to be checked
+				//before draining, or a log made just before its thread exited would be erased along with the ring
+				bool isOrphaned = Rings[index].use_count() == 1;
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				RecordRing& ring = *Rings[index];
+				uint64_t tail = ring.Tail.load(std::memory_order_relaxed);
+				uint64_t head = ring.Head.load(std::memory_order_acquire);
+				for (; tail < head; tail++)
+				{
+					records.push_back(std::move(ring.Records[tail % RING_CAPACITY]));
+				}
+				ring.Tail.store(tail, std::memory_order_release);
+
+				if (isOrphaned)
+				{
+					Rings.erase(Rings.begin() + index);
+				}
+				else
+				{
+					index++;
+				}
+			}
+		}
+
+		if (records.empty())
+		{
+			return 0;
+		}
+
+		//Each ring is in order, but the rings have to be merged back into the order the logs were made in
+		std::sort(records.begin(), records.end(), [](const LogRecord& first, const LogRecord& second)
+			{
+				return first.Sequence < second.Sequence;
+			});
+
+		{
+			std::lock_guard<std::mutex> sinksLock(SinksMutex);
+			for (LogRecord& record : records)
+			{
+				if (record.FormatDeferredMessage)
+				{
+					record.FormatDeferredMessage(record, record.Message);
+				}
+				std::wstring formattedLine = FormatRecord(record);
+				for (std::shared_ptr<ILogSink>& sink : Sinks)
+				{
+					sink->Write(record, formattedLine);
+				}
+			}
+		}
+
+		RecordsWritten.fetch_add(records.size(), std::memory_order_acq_rel);
+		RecordsWritten.notify_all();
+		return records.size();
+	}
+
+	std::wstring Logger::FormatRecord(const LogRecord& record)
+	{
+		if (record.IsRaw)
+		{
+			return record.Message + L'\n';
+		}
+
+		//Names from source_location are static strings, so each is only cut down and converted the first time it is seen.
+		//Only the background thread formats, so the cache needs no lock
+		static std::unordered_map<const char*, std::wstring> wideNames;
+		auto getWideName = [](const char* name, bool isFileName) -> const std::wstring&
+			{
+				auto [wideName, isNew] = wideNames.try_emplace(name);
+				if (isNew)
+				{
+					std::string_view nameView(name);
+					if (isFileName)
+					{
+						size_t lastSeparator = nameView.find_last_of("\\/");
+						if (lastSeparator != std::string_view::npos)
+						{
+							nameView.remove_prefix(lastSeparator + 1);
+						}
+					}
+					wideName->second = StringConverter::ConvertNarrowStringToWideString(std::string(nameView));
+				}
+				return wideName->second;
+			};
+
+		static constexpr const wchar_t* LEVEL_NAMES[] = { L"TRACE", L"DEBUG", L"INFO", L"WARNING", L"ERROR", L"OFF" };
+		return std::format(L"DIVERGENCE ENGINE {:%H:%M:%S} [{}] (Thread {}): File: {} ({}:{}) '{}': {}\n",
+			std::chrono::floor<std::chrono::milliseconds>(record.Time),
+			LEVEL_NAMES[static_cast<size_t>(record.Level)],
+			record.ThreadID,
+			getWideName(record.FileName, true),
+			record.Line,
+			record.Column,
+			getWideName(record.FunctionName, false),
+			record.Message);
+	}
+}
@@ -1,13 +1,171 @@
 #pragma once
-#include <string>
+#include "Logger/LogSinks.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <mutex>
 #include <source_location>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace DivergenceEngine
 {
+	//Logs are handed to a background thread, which formats them and writes them to every sink. The thread that logs only moves
+	//the message into a ring of its own, so logging never waits on the debugger, the console or a file. Formatted logs whose
+	//arguments are all numbers are not even formatted until they reach the background thread
 	class Logger
 	{
+	private:
+		//Constants
+		static constexpr size_t RING_CAPACITY = 1024;
+
+		//Written to by one thread and read by the logging thread only, so neither side needs a lock
+		struct RecordRing
+		{
+			std::array<LogRecord, RING_CAPACITY> Records;
+			std::atomic<uint64_t> Head = 0; //Next record the logging thread writes
+			std::atomic<uint64_t> Tail = 0; //Next record the background thread reads
+		};
+
+		//Datafields
+		inline static std::atomic<LogLevel> MinimumLevel = LogLevel::Info;
+		inline static std::mutex RingsMutex; //Only taken when a thread logs for the first time, and by the background thread
+		inline static std::vector<std::shared_ptr<RecordRing>> Rings;
+		inline static std::mutex SinksMutex;
+		inline static std::vector<std::shared_ptr<ILogSink>> Sinks;
+		inline static std::atomic<uint64_t> RecordsQueued = 0;
+		inline static std::atomic<uint64_t> RecordsWritten = 0;
+		inline static std::atomic<uint64_t> RecordsDropped = 0;
+		inline static std::atomic<uint32_t> WakeCounter = 0; //Bumped after every queued log, to wake the background thread
+		inline static std::atomic<bool> IsRunning = false;
+		inline static std::atomic<bool> IsShutDown = false;
+		inline static std::once_flag StartFlag;
+		inline static std::thread LoggingThread;
+
+		//Declared last, so it is destroyed first and the background thread is stopped before anything it uses
+		struct ShutdownGuard
+		{
+			~ShutdownGuard() { Logger::Shutdown(); }
+		};
+		inline static ShutdownGuard Guard;
+
+		//Helpers
+		static LogRecord MakeRecord(LogLevel level, std::source_location location);
+		static RecordRing& GetThreadRing();
+		static void Enqueue(LogRecord&& record);
+		static void Start();
+		static void LoggingThreadFunction();
+		static size_t WriteQueuedRecords();
+		static std::wstring FormatRecord(const LogRecord& record);
+
+		//Each argument gets a slot of its own in the record, and is copied back out of it as the same type to be formatted
+		template<typename... Args>
+		static constexpr bool CanDeferArguments = sizeof...(Args) <= LogRecord::DEFERRED_ARGUMENT_SLOTS &&
+			((std::is_arithmetic_v<std::remove_cvref_t<Args>> && sizeof(std::remove_cvref_t<Args>) <= LogRecord::DEFERRED_ARGUMENT_SLOT_SIZE) && ...);
+
+		template<size_t... Indices, typename... Args>
+		static void StoreDeferredArguments(LogRecord& record, std::index_sequence<Indices...>, const Args&... args)
+		{
+			(std::memcpy(record.DeferredArguments.data() + Indices * LogRecord::DEFERRED_ARGUMENT_SLOT_SIZE, &args, sizeof(Args)), ...);
+		}
+
+		template<typename... Args, size_t... Indices>
+		static void FormatStoredArguments(const LogRecord& record, std::wstring& message, std::index_sequence<Indices...>)
+		{
+			std::tuple<Args...> arguments;
+			(std::memcpy(&std::get<Indices>(arguments), record.DeferredArguments.data() + Indices * LogRecord::DEFERRED_ARGUMENT_SLOT_SIZE, sizeof(Args)), ...);
+			message = std::vformat(record.DeferredFormat, std::make_wformat_args(std::get<Indices>(arguments)...));
+		}
+
+		template<typename... Args>
+		static void FormatDeferredMessage(const LogRecord& record, std::wstring& message)
+		{
+			FormatStoredArguments<Args...>(record, message, std::index_sequence_for<Args...>{});
+		}
+
 	public:
+		//Logging functions
 		static void Log(std::wstring message, std::source_location location = std::source_location::current());
+		static void Log(LogLevel level, std::wstring message, std::source_location location = std::source_location::current()); //Errors are written before it returns
 		static void RawLog(std::wstring message);
+
+		//Only formats the message if the level is enabled. Use it through the DIVERGENCE_LOG macros, which also skip working out
+		//the arguments. When every argument is a number, they are copied into the log and the background thread formats it.
+		//Anything else, like a string, could change or be gone by then, so those messages are formatted here
+		template<typename... Args>
+		static void LogFormatted(LogLevel level, std::source_location location, std::wformat_string<Args...> format, Args&&... args)
+		{
+			if (!IsLevelEnabled(level))
+			{
+				return;
+			}
+
+			if constexpr (CanDeferArguments<Args...>)
+			{
+				LogRecord record = MakeRecord(level, location);
+				record.DeferredFormat = format.get();
+				record.FormatDeferredMessage = &FormatDeferredMessage<std::remove_cvref_t<Args>...>;
+				StoreDeferredArguments(record, std::index_sequence_for<Args...>{}, args...);
+				Enqueue(std::move(record));
+			}
+			else
+			{
+				Log(level, std::format(format, std::forward<Args>(args)...), location);
+			}
+		}
+
+		//Level functions
+		static void SetMinimumLevel(LogLevel level) noexcept;
+		static LogLevel GetMinimumLevel() noexcept;
+		static bool IsLevelEnabled(LogLevel level) noexcept { return level >= MinimumLevel.load(std::memory_order_relaxed); }
+
+		//Sink functions. Logs go to the debugger until the sinks are changed
+		static void AddSink(std::shared_ptr<ILogSink> sink);
+		static void ClearSinks();
+
+		//Blocks until everything logged so far has been written, then flushes the sinks
+		static void Flush();
+		static void Shutdown();
+
+		//Getters
+		static uint64_t GetRecordsDropped() noexcept; //Logs thrown away because a thread's ring was full
 	};
-}
\ No newline at end of file
+}
+
+
+//Logs below this level are compiled out, arguments and all. Define it before including the engine to keep more or fewer
+//(0 is Trace and 5 is Off). By default, debug builds keep everything and release builds keep Info and above
+#ifndef DIVERGENCE_LOG_COMPILED_LEVEL
+#ifdef NDEBUG
+#define DIVERGENCE_LOG_COMPILED_LEVEL 2
+#else
+#define DIVERGENCE_LOG_COMPILED_LEVEL 0
+#endif
+#endif
+
+//Logs a std::format style message at a level. Nothing after the level is evaluated unless the level is compiled in and enabled.
+//The source_location is made here, at the call site, and only its static strings are kept until the log is written
+#define DIVERGENCE_LOG(level, ...) \
+	do \
+	{ \
+		if constexpr (static_cast<int>(level) >= DIVERGENCE_LOG_COMPILED_LEVEL) \
+		{ \
+			if (::DivergenceEngine::Logger::IsLevelEnabled(level)) \
+			{ \
+				::DivergenceEngine::Logger::LogFormatted(level, std::source_location::current(), __VA_ARGS__); \
+			} \
+		} \
+	} while (false)
+
+#define DIVERGENCE_LOG_TRACE(...) DIVERGENCE_LOG(::DivergenceEngine::LogLevel::Trace, __VA_ARGS__)
+#define DIVERGENCE_LOG_DEBUG(...) DIVERGENCE_LOG(::DivergenceEngine::LogLevel::Debug, __VA_ARGS__)
+#define DIVERGENCE_LOG_INFO(...) DIVERGENCE_LOG(::DivergenceEngine::LogLevel::Info, __VA_ARGS__)
+#define DIVERGENCE_LOG_WARNING(...) DIVERGENCE_LOG(::DivergenceEngine::LogLevel::Warning, __VA_ARGS__)
+#define DIVERGENCE_LOG_ERROR(...) DIVERGENCE_LOG(::DivergenceEngine::LogLevel::Error, __VA_ARGS__)
\ No newline at end of file
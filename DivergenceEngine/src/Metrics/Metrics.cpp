@@ -0,0 +1,266 @@
+#include "Metrics.h"
+#include <Windows.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+namespace DivergenceEngine
+{
+	//Shards---------------------------------------------------------------------------------------
+	size_t MetricShards::GetThreadShardIndex() noexcept
+	{
+		//Threads are dealt shards in turn as they first touch a metric
+		static std::atomic<size_t> nextShardIndex = 0;
+		thread_local size_t shardIndex = nextShardIndex.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+		return shardIndex;
+	}
+
+	//Counter--------------------------------------------------------------------------------------
+	uint64_t Counter::GetValue() const noexcept
+	{
+		uint64_t value = 0;
+		for (const Shard& shard : Shards)
+		{
+			value += shard.Value.load(std::memory_order_relaxed);
+		}
+		return value;
+	}
+
+	void Counter::Reset() noexcept
+	{
+		for (Shard& shard : Shards)
+		{
+			shard.Value.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	//HistogramSnapshot----------------------------------------------------------------------------
+	double HistogramSnapshot::GetAverage() const noexcept
+	{
+		return Count == 0 ? 0.0 : static_cast<double>(Sum) / static_cast<double>(Count);
+	}
+
+	uint64_t HistogramSnapshot::GetPercentile(double percentile) const noexcept
+	{
+		if (Count == 0)
+		{
+			return 0;
+		}
+
+		//Nearest rank, with the percentile from 0 to 1
+		uint64_t rank = (std::max)(static_cast<uint64_t>(std::ceil(percentile * static_cast<double>(Count))), uint64_t(1));
+		uint64_t countSoFar = 0;
+		for (size_t bucket = 0; bucket < BucketCounts.size(); bucket++)
+		{
+			countSoFar += BucketCounts[bucket];
+			if (countSoFar >= rank)
+			{
+				uint64_t bucketUpperEdge = bucket == 0 ? 0 : (uint64_t(1) << bucket) - 1;
+				return (std::min)(bucketUpperEdge, Maximum);
+			}
+		}
+		return Maximum;
+	}
+
+	//Histogram------------------------------------------------------------------------------------
+	void Histogram::Record(uint64_t value) noexcept
+	{
+		Shard& shard = Shards[MetricShards::GetThreadShardIndex()];
+		size_t bucket = (std::min)(static_cast<size_t>(std::bit_width(value)), BUCKET_COUNT - 1);
+		shard.Buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+		shard.Count.fetch_add(1, std::memory_order_relaxed);
+		shard.Sum.fetch_add(value, std::memory_order_relaxed);
+
+		uint64_t maximum = shard.Maximum.load(std::memory_order_relaxed);
+		while (value > maximum && !shard.Maximum.compare_exchange_weak(maximum, value, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	//The shards are read one at a time while other threads keep recording, so the totals may be off by the values recorded
+	//during the read. That is fine for watching trends
+	HistogramSnapshot Histogram::GetSnapshot() const
+	{
+		HistogramSnapshot snapshot;
+		snapshot.BucketCounts.assign(BUCKET_COUNT, 0);
+		for (const Shard& shard : Shards)
+		{
+			for (size_t bucket = 0; bucket < BUCKET_COUNT; bucket++)
+			{
+				snapshot.BucketCounts[bucket] += shard.Buckets[bucket].load(std::memory_order_relaxed);
+			}
+			snapshot.Count += shard.Count.load(std::memory_order_relaxed);
+			snapshot.Sum += shard.Sum.load(std::memory_order_relaxed);
+			snapshot.Maximum = (std::max)(snapshot.Maximum, shard.Maximum.load(std::memory_order_relaxed));
+		}
+		return snapshot;
+	}
+
+	void Histogram::Reset() noexcept
+	{
+		for (Shard& shard : Shards)
+		{
+			for (std::atomic<uint64_t>& bucket : shard.Buckets)
+			{
+				bucket.store(0, std::memory_order_relaxed);
+			}
+			shard.Count.store(0, std::memory_order_relaxed);
+			shard.Sum.store(0, std::memory_order_relaxed);
+			shard.Maximum.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	//Registration functions-----------------------------------------------------------------------
+	Counter& MetricsRegistry::GetCounter(std::string_view name)
+	{
+		std::lock_guard<std::mutex> registryLock(RegistryMutex);
+		auto metric = Counters.find(name);
+		if (metric == Counters.end())
+		{
+			metric = Counters.emplace(std::string(name), std::make_unique<Counter>()).first;
+		}
+		return *metric->second;
+	}
+
+	Gauge& MetricsRegistry::GetGauge(std::string_view name)
+	{
+		std::lock_guard<std::mutex> registryLock(RegistryMutex);
+		auto metric = Gauges.find(name);
+		if (metric == Gauges.end())
+		{
+			metric = Gauges.emplace(std::string(name), std::make_unique<Gauge>()).first;
+		}
+		return *metric->second;
+	}
+
+	Histogram& MetricsRegistry::GetHistogram(std::string_view name)
+	{
+		std::lock_guard<std::mutex> registryLock(RegistryMutex);
+		auto metric = Histograms.find(name);
+		if (metric == Histograms.end())
+		{
+			metric = Histograms.emplace(std::string(name), std::make_unique<Histogram>()).first;
+		}
+		return *metric->second;
+	}
+
+	//Snapshot functions---------------------------------------------------------------------------
+	std::string MetricsRegistry::FormatSnapshot()
+	{
+		std::lock_guard<std::mutex> registryLock(RegistryMutex);
+
+		//Metric names are picked by the engine and pages, so they are expected to not need escaping
+		std::string snapshotLine = std::format("{{\"time\":{},\"counters\":{{", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+		const char* separator = "";
+		for (const auto& [name, counter] : Counters)
+		{
+			snapshotLine += std::format("{}\"{}\":{}", separator, name, counter->GetValue());
+			separator = ",";
+		}
+
+		snapshotLine += "},\"gauges\":{";
+		separator = "";
+		for (const auto& [name, gauge] : Gauges)
+		{
+			snapshotLine += std::format("{}\"{}\":{}", separator, name, gauge->GetValue());
+			separator = ",";
+		}
+
+		snapshotLine += "},\"histograms\":{";
+		separator = "";
+		for (const auto& [name, histogram] : Histograms)
+		{
+			HistogramSnapshot snapshot = histogram->GetSnapshot();
+			snapshotLine += std::format("{}\"{}\":{{\"count\":{},\"average\":{:.2f},\"p50\":{},\"p99\":{},\"max\":{}}}",
+				separator,
+				name,
+				snapshot.Count,
+				snapshot.GetAverage(),
+				snapshot.GetPercentile(0.5),
+				snapshot.GetPercentile(0.99),
+				snapshot.Maximum);
+			separator = ",";
+		}
+
+		snapshotLine += "}}\n";
+		return snapshotLine;
+	}
+
+	void MetricsRegistry::AppendSnapshot(const std::filesystem::path& filePath)
+	{
+		std::ofstream metricsFile(filePath, std::ios::out | std::ios::app);
+		if (!metricsFile.is_open())
+		{
+			throw std::runtime_error(std::format("MetricsRegistry::AppendSnapshot() - Could not open {}", filePath.string()));
+		}
+		metricsFile << FormatSnapshot();
+	}
+
+	//Periodic dump functions----------------------------------------------------------------------
+	void MetricsRegistry::StartPeriodicDump(const std::filesystem::path& filePath, std::chrono::milliseconds interval)
+	{
+		if (interval.count() <= 0)
+		{
+			throw std::invalid_argument("MetricsRegistry::StartPeriodicDump() - The interval must be more than 0");
+		}
+
+		StopPeriodicDump();
+		{
+			std::lock_guard<std::mutex> dumpLock(DumpMutex);
+			IsDumping = true;
+		}
+		DumpThread = std::thread(&MetricsRegistry::DumpThreadFunction, filePath, interval);
+	}
+
+	void MetricsRegistry::StopPeriodicDump()
+	{
+		{
+			std::lock_guard<std::mutex> dumpLock(DumpMutex);
+			IsDumping = false;
+		}
+		DumpCondition.notify_all();
+
+		if (DumpThread.joinable())
+		{
+			DumpThread.join();
+		}
+	}
+
+	void MetricsRegistry::ResetAll()
+	{
+		std::lock_guard<std::mutex> registryLock(RegistryMutex);
+		for (auto& [name, counter] : Counters)
+		{
+			counter->Reset();
+		}
+
+		for (auto& [name, histogram] : Histograms)
+		{
+			histogram->Reset();
+		}
+	}
+
+	//Helpers--------------------------------------------------------------------------------------
+	void MetricsRegistry::DumpThreadFunction(std::filesystem::path filePath, std::chrono::milliseconds interval)
+	{
+		SetThreadDescription(GetCurrentThread(), L"Metrics dump");
+
+		std::unique_lock<std::mutex> dumpLock(DumpMutex);
+		while (!DumpCondition.wait_for(dumpLock, interval, []() { return !IsDumping; }))
+		{
+			//A file that cannot be opened right now (locked by another program, for one) is tried again next interval
+			dumpLock.unlock();
+			try
+			{
+				AppendSnapshot(filePath);
+			}
+			catch (const std::exception&)
+			{
+			}
+			dumpLock.lock();
+		}
+	}
+}
\ No newline at end of file
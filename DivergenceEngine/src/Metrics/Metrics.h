@@ -0,0 +1,168 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace DivergenceEngine
+{
+	//Counters and histograms are split into shards, each on its own cache line. Every thread adds into the shard it was given,
+	//so threads counting the same metric do not fight over one cache line. Reading a metric adds the shards up
+	namespace MetricShards
+	{
+		inline constexpr size_t SHARD_COUNT = 16;
+		size_t GetThreadShardIndex() noexcept;
+	}
+
+	//A total that only goes up, like sprites drawn or buffers submitted
+	class Counter
+	{
+	private:
+		struct alignas(64) Shard
+		{
+			std::atomic<uint64_t> Value = 0;
+		};
+
+		//Datafields
+		std::array<Shard, MetricShards::SHARD_COUNT> Shards;
+
+	public:
+		void Add(uint64_t amount = 1) noexcept
+		{
+			Shards[MetricShards::GetThreadShardIndex()].Value.fetch_add(amount, std::memory_order_relaxed);
+		}
+
+		uint64_t GetValue() const noexcept;
+		void Reset() noexcept;
+	};
+
+	//A value that is set rather than added to, like the number of textures loaded
+	class Gauge
+	{
+	private:
+		//Datafields
+		std::atomic<double> Value = 0;
+
+	public:
+		void Set(double value) noexcept { Value.store(value, std::memory_order_relaxed); }
+		void Add(double delta) noexcept { Value.fetch_add(delta, std::memory_order_relaxed); }
+		double GetValue() const noexcept { return Value.load(std::memory_order_relaxed); }
+	};
+
+	//What a histogram held when it was read
+	struct HistogramSnapshot
+	{
+		uint64_t Count = 0;
+		uint64_t Sum = 0;
+		uint64_t Maximum = 0;
+		std::vector<uint64_t> BucketCounts; //Bucket 0 holds 0, and bucket i holds values from 2^(i-1) up to 2^i - 1
+
+		double GetAverage() const noexcept;
+
+		//The upper edge of the bucket the percentile falls in, so it is never under the real value by more than double
+		uint64_t GetPercentile(double percentile) const noexcept;
+	};
+
+	//Counts how often values of each size were recorded, in power of two buckets, like refill times in microseconds
+	class Histogram
+	{
+	public:
+		//Constants
+		static constexpr size_t BUCKET_COUNT = 40;
+
+	private:
+		struct alignas(64) Shard
+		{
+			std::array<std::atomic<uint64_t>, BUCKET_COUNT> Buckets{};
+			std::atomic<uint64_t> Count = 0;
+			std::atomic<uint64_t> Sum = 0;
+			std::atomic<uint64_t> Maximum = 0;
+		};
+
+		//Datafields
+		std::array<Shard, MetricShards::SHARD_COUNT> Shards;
+
+	public:
+		void Record(uint64_t value) noexcept;
+		HistogramSnapshot GetSnapshot() const;
+		void Reset() noexcept;
+	};
+
+	//Records how long the scope it is declared in took into a histogram, in microseconds
+	class ScopedHistogramTimer
+	{
+	private:
+		Histogram& TargetHistogram;
+		std::chrono::steady_clock::time_point StartTime;
+
+	public:
+		explicit ScopedHistogramTimer(Histogram& histogram) noexcept :
+			TargetHistogram(histogram),
+			StartTime(std::chrono::steady_clock::now())
+		{
+		}
+
+		~ScopedHistogramTimer()
+		{
+			TargetHistogram.Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - StartTime).count()));
+		}
+
+		//Deleted stuff
+		ScopedHistogramTimer(const ScopedHistogramTimer&) = delete;
+		ScopedHistogramTimer& operator=(const ScopedHistogramTimer&) = delete;
+	};
+
+	//Every metric in the engine, by name. Metrics are made the first time they are asked for and live until the process ends, so
+	//subsystems look theirs up once and keep the reference (a static local works well)
+	class MetricsRegistry
+	{
+	private:
+		//Datafields
+		inline static std::mutex RegistryMutex;
+		inline static std::map<std::string, std::unique_ptr<Counter>, std::less<>> Counters;
+		inline static std::map<std::string, std::unique_ptr<Gauge>, std::less<>> Gauges;
+		inline static std::map<std::string, std::unique_ptr<Histogram>, std::less<>> Histograms;
+
+		//Periodic dumps
+		inline static std::mutex DumpMutex;
+		inline static std::condition_variable DumpCondition;
+		inline static bool IsDumping = false;
+		inline static std::thread DumpThread;
+
+		//Declared last, so it is destroyed first and the dump thread is stopped before anything it uses
+		struct ShutdownGuard
+		{
+			~ShutdownGuard() { MetricsRegistry::StopPeriodicDump(); }
+		};
+		inline static ShutdownGuard Guard;
+
+		//Helpers
+		static void DumpThreadFunction(std::filesystem::path filePath, std::chrono::milliseconds interval);
+
+	public:
+		//Registration functions
+		static Counter& GetCounter(std::string_view name);
+		static Gauge& GetGauge(std::string_view name);
+		static Histogram& GetHistogram(std::string_view name);
+
+		//Writes every metric as one line of JSON, so dumps appended to the same file can be read back one line at a time
+		static std::string FormatSnapshot();
+		static void AppendSnapshot(const std::filesystem::path& filePath);
+
+		//Appends a snapshot to the file on a background thread every interval, until stopped
+		static void StartPeriodicDump(const std::filesystem::path& filePath, std::chrono::milliseconds interval);
+		static void StopPeriodicDump();
+
+		//Puts every counter and histogram back to 0. Gauges keep their value, since they are set, not added to
+		static void ResetAll();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,231 @@
+#include "Profiler.h"
+#include <Windows.h>
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+namespace DivergenceEngine
+{
+	//Zone-----------------------------------------------------------------------------------------
+	Profiler::Zone::Zone(const char* name) noexcept :
+		Name(name),
+		IsRecording(Profiler::IsEnabled())
+	{
+		//The clock is not even read while the profiler is disabled
+		if (IsRecording)
+		{
+			StartTime = std::chrono::steady_clock::now();
+		}
+	}
+
+	Profiler::Zone::~Zone()
+	{
+		if (IsRecording)
+		{
+			Profiler::Record(Name, StartTime, std::chrono::steady_clock::now());
+		}
+	}
+
+	//Setters--------------------------------------------------------------------------------------
+	void Profiler::SetEnabled(bool isEnabled) noexcept
+	{
+		Enabled.store(isEnabled, std::memory_order_relaxed);
+	}
+
+	void Profiler::Reset()
+	{
+		std::lock_guard<std::mutex> profilerLock(ProfilerMutex);
+		for (std::shared_ptr<ThreadEvents>& threadEvents : ThreadEventLists)
+		{
+			std::lock_guard<std::mutex> threadLock(threadEvents->Mutex);
+			threadEvents->Events.clear();
+		}
+
+		Histories.clear();
+		HistoryIndices.clear();
+		FramesRecorded = 0;
+	}
+
+	//Getters--------------------------------------------------------------------------------------
+	bool Profiler::IsEnabled() noexcept
+	{
+		return Enabled.load(std::memory_order_relaxed);
+	}
+
+	std::vector<ProfileZoneStatistics> Profiler::GetZoneStatistics()
+	{
+		std::lock_guard<std::mutex> profilerLock(ProfilerMutex);
+		std::vector<ProfileZoneStatistics> listOfStatistics;
+		size_t frameCount = static_cast<size_t>((std::min)(FramesRecorded, static_cast<uint64_t>(FRAME_HISTORY_SIZE)));
+		if (frameCount == 0)
+		{
+			return listOfStatistics;
+		}
+
+		std::vector<double> sortedMilliseconds(frameCount);
+		for (const ZoneHistory& history : Histories)
+		{
+			std::copy(history.FrameMilliseconds.begin(), history.FrameMilliseconds.begin() + frameCount, sortedMilliseconds.begin());
+			std::sort(sortedMilliseconds.begin(), sortedMilliseconds.end());
+
+			ProfileZoneStatistics statistics;
+			statistics.Name = history.Name;
+			statistics.CallsLastFrame = history.CallsLastFrame;
+			statistics.LastMilliseconds = history.FrameMilliseconds[(FramesRecorded - 1) % FRAME_HISTORY_SIZE];
+			statistics.MinimumMilliseconds = sortedMilliseconds.front();
+			statistics.MaximumMilliseconds = sortedMilliseconds.back();
+			for (double milliseconds : sortedMilliseconds)
+			{
+				statistics.AverageMilliseconds += milliseconds;
+			}
+			statistics.AverageMilliseconds /= static_cast<double>(frameCount);
+
+			//The nearest rank percentile, so with fewer than 100 frames it is the slowest frame
+			size_t p99Rank = static_cast<size_t>(std::ceil(0.99 * static_cast<double>(frameCount)));
+			statistics.P99Milliseconds = sortedMilliseconds[p99Rank - 1];
+			listOfStatistics.push_back(statistics);
+		}
+
+		std::sort(listOfStatistics.begin(), listOfStatistics.end(), [](const ProfileZoneStatistics& first, const ProfileZoneStatistics& second)
+			{
+				return first.AverageMilliseconds > second.AverageMilliseconds;
+			});
+		return listOfStatistics;
+	}
+
+	//Public functions-----------------------------------------------------------------------------
+	void Profiler::EndFrame()
+	{
+		if (!IsEnabled())
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> profilerLock(ProfilerMutex);
+
+		//Zones that were never hit this frame still take up a frame, as 0
+		size_t frameSlot = static_cast<size_t>(FramesRecorded % FRAME_HISTORY_SIZE);
+		for (ZoneHistory& history : Histories)
+		{
+			history.FrameMilliseconds[frameSlot] = 0;
+			history.CallsLastFrame = 0;
+		}
+
+		std::vector<ZoneEvent> frameEvents;
+		for (size_t index = 0; index < ThreadEventLists.size();)
+		{
+			//Lists only held by the profiler belong to threads that have exited. This is checked before the events are taken, so
+			//a zone that ended just before its thread exited is still counted
+			bool isOrphaned = ThreadEventLists[index].use_count() == 1;
+			{
+				std::lock_guard<std::mutex> threadLock(ThreadEventLists[index]->Mutex);
+				frameEvents.insert(frameEvents.end(), ThreadEventLists[index]->Events.begin(), ThreadEventLists[index]->Events.end());
+				ThreadEventLists[index]->Events.clear();
+			}
+
+			if (isOrphaned)
+			{
+				ThreadEventLists.erase(ThreadEventLists.begin() + index);
+			}
+			else
+			{
+				index++;
+			}
+		}
+
+		for (const ZoneEvent& zoneEvent : frameEvents)
+		{
+			ZoneHistory& history = Histories[GetHistoryIndex(zoneEvent.Name)];
+			history.FrameMilliseconds[frameSlot] += static_cast<double>(zoneEvent.DurationNanoseconds) / 1000000.0;
+			history.CallsLastFrame++;
+		}
+
+		if (IsCapturingTrace)
+		{
+			size_t eventsToKeep = (std::min)(frameEvents.size(), MAX_TRACE_EVENTS - TraceEvents.size());
+			TraceEvents.insert(TraceEvents.end(), frameEvents.begin(), frameEvents.begin() + eventsToKeep);
+		}
+
+		FramesRecorded++;
+	}
+
+	void Profiler::BeginTraceCapture()
+	{
+		std::lock_guard<std::mutex> profilerLock(ProfilerMutex);
+		TraceEvents.clear();
+		IsCapturingTrace = true;
+	}
+
+	void Profiler::EndTraceCapture(const std::filesystem::path& filePath)
+	{
+		std::vector<ZoneEvent> traceEvents;
+		{
+			std::lock_guard<std::mutex> profilerLock(ProfilerMutex);
+			IsCapturingTrace = false;
+			traceEvents.swap(TraceEvents);
+		}
+
+		std::ofstream traceFile(filePath, std::ios::out | std::ios::trunc);
+		if (!traceFile.is_open())
+		{
+			throw std::runtime_error(std::format("Profiler::EndTraceCapture() - Could not open {}", filePath.string()));
+		}
+
+		//Complete ("X") events, timed in microseconds. Zone names are literals from the engine, so they need no escaping
+		traceFile << "{\"traceEvents\":[";
+		for (size_t index = 0; index < traceEvents.size(); index++)
+		{
+			const ZoneEvent& zoneEvent = traceEvents[index];
+			traceFile << std::format("{}\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+				index == 0 ? "" : ",",
+				zoneEvent.Name,
+				zoneEvent.ThreadID,
+				static_cast<double>(zoneEvent.StartNanoseconds) / 1000.0,
+				static_cast<double>(zoneEvent.DurationNanoseconds) / 1000.0);
+		}
+		traceFile << "\n],\"displayTimeUnit\":\"ms\"}";
+	}
+
+	//Helpers--------------------------------------------------------------------------------------
+	Profiler::ThreadEvents& Profiler::GetThreadEvents()
+	{
+		//Registered the first time the thread finishes a zone. The profiler keeps its own reference, so events from a thread
+		//that has exited are still collected at the end of the frame
+		thread_local std::shared_ptr<ThreadEvents> threadEvents = []()
+			{
+				std::shared_ptr<ThreadEvents> newThreadEvents = std::make_shared<ThreadEvents>();
+				std::lock_guard<std::mutex> profilerLock(ProfilerMutex);
+				ThreadEventLists.push_back(newThreadEvents);
+				return newThreadEvents;
+			}();
+		return *threadEvents;
+	}
+
+	void Profiler::Record(const char* name, std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime)
+	{
+		thread_local uint32_t threadID = GetCurrentThreadId();
+		ZoneEvent zoneEvent{
+			name,
+			std::chrono::duration_cast<std::chrono::nanoseconds>(startTime - StartTime).count(),
+			std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count(),
+			threadID };
+
+		ThreadEvents& threadEvents = GetThreadEvents();
+		std::lock_guard<std::mutex> threadLock(threadEvents.Mutex);
+		threadEvents.Events.push_back(zoneEvent);
+	}
+
+	size_t Profiler::GetHistoryIndex(const char* name)
+	{
+		//Names are compared by their text, since the same literal can have a different address in each file
+		auto [historyIndex, isNew] = HistoryIndices.try_emplace(std::string_view(name), Histories.size());
+		if (isNew)
+		{
+			Histories.push_back(ZoneHistory{ name });
+		}
+
+		return historyIndex->second;
+	}
+}
\ No newline at end of file
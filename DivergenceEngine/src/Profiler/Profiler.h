@@ -0,0 +1,111 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace DivergenceEngine
+{
+	//How long a zone took per frame, over the frames the profiler remembers
+	struct ProfileZoneStatistics
+	{
+		const char* Name;
+		uint32_t CallsLastFrame = 0;
+		double LastMilliseconds = 0;
+		double MinimumMilliseconds = 0;
+		double AverageMilliseconds = 0;
+		double P99Milliseconds = 0;
+		double MaximumMilliseconds = 0;
+	};
+
+	//Times named zones of code on any thread and adds them up per frame. Nothing is timed while the profiler is disabled,
+	//so the zones can be left in place
+	class Profiler
+	{
+	public:
+		//Times the scope it is declared in. The name must outlive the profiler (a string literal), since only the pointer is kept
+		class Zone
+		{
+		private:
+			const char* Name;
+			std::chrono::steady_clock::time_point StartTime;
+			bool IsRecording;
+
+		public:
+			explicit Zone(const char* name) noexcept;
+			~Zone();
+
+			//Deleted stuff
+			Zone(const Zone&) = delete;
+			Zone& operator=(const Zone&) = delete;
+		};
+
+	private:
+		struct ZoneEvent
+		{
+			const char* Name;
+			int64_t StartNanoseconds; //Since the profiler started
+			int64_t DurationNanoseconds;
+			uint32_t ThreadID;
+		};
+
+		//Each thread records into its own list, so threads only contend with the end of the frame
+		struct ThreadEvents
+		{
+			std::mutex Mutex;
+			std::vector<ZoneEvent> Events;
+		};
+
+		//Constants
+		static constexpr size_t FRAME_HISTORY_SIZE = 240;
+		static constexpr size_t MAX_TRACE_EVENTS = 1000000;
+
+		struct ZoneHistory
+		{
+			const char* Name;
+			std::array<double, FRAME_HISTORY_SIZE> FrameMilliseconds{}; //Ring of the time spent in the zone each frame
+			uint32_t CallsLastFrame = 0;
+		};
+
+		//Datafields
+		inline static std::atomic<bool> Enabled = false;
+		inline static const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+		inline static std::mutex ProfilerMutex;
+		inline static std::vector<std::shared_ptr<ThreadEvents>> ThreadEventLists;
+		inline static std::vector<ZoneHistory> Histories;
+		inline static std::unordered_map<std::string_view, size_t> HistoryIndices;
+		inline static uint64_t FramesRecorded = 0;
+		inline static bool IsCapturingTrace = false;
+		inline static std::vector<ZoneEvent> TraceEvents;
+
+		//Helpers
+		static ThreadEvents& GetThreadEvents();
+		static void Record(const char* name, std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime);
+		static size_t GetHistoryIndex(const char* name);
+
+	public:
+		//Setters
+		static void SetEnabled(bool isEnabled) noexcept;
+		static void Reset();
+
+		//Getters
+		static bool IsEnabled() noexcept;
+
+		//Sorted from the zone that took the longest on average
+		static std::vector<ProfileZoneStatistics> GetZoneStatistics();
+
+		//Public functions
+		//Adds up the zones that finished since the last call as one frame. The application calls this after every frame
+		static void EndFrame();
+
+		//Keeps every zone from now on, until the capture is ended and written as a Chrome trace (which Perfetto also opens)
+		static void BeginTraceCapture();
+		static void EndTraceCapture(const std::filesystem::path& filePath);
+	};
+}
\ No newline at end of file
@@ -33,5 +33,17 @@ namespace DivergenceEngine
 
 			return ansiString;
 		}
+
+		static std::string ConvertWideStringToUTF8(const std::wstring& wideString)
+		{
+			//Allocates a string with appropriate number of bytes (except for null) to take in the converted wide string
+			int numberOfBytesInUTF8String = WideCharToMultiByte(CP_UTF8, 0, wideString.c_str(), -1, NULL, 0, NULL, NULL) - 1;
+			std::string utf8String(numberOfBytesInUTF8String, 0);
+
+			//Fills and returns the UTF-8 string
+			WideCharToMultiByte(CP_UTF8, 0, wideString.c_str(), -1, &utf8String[0], numberOfBytesInUTF8String, NULL, NULL);
+
+			return utf8String;
+		}
 	};
 }
\ No newline at end of file
@@ -41,7 +41,35 @@ namespace DivergenceEngine::Templates
 		return false;
 	}
 
-	void ButtonMenu::OnMouseOver(DirectX::XMINT2 mousePos)
+	std::optional<DirectX::SimpleMath::Rectangle> ButtonMenu::GetBounds()
+	{
+		//The menu can only be hit where one of its buttons can
+		std::optional<DirectX::SimpleMath::Rectangle> menuBounds = DirectX::SimpleMath::Rectangle();
+		for (auto& button : ButtonList)
+		{
+			std::optional<DirectX::SimpleMath::Rectangle> buttonBounds = button.ButtonDescription.DefaultVisual->GetBounds();
+			if (!buttonBounds)
+			{
+				return std::nullopt;
+			}
+
+			menuBounds = menuBounds->IsEmpty() ? *buttonBounds : DirectX::SimpleMath::Rectangle::Union(*menuBounds, *buttonBounds);
+		}
+		return menuBounds;
+	}
+
+	void ButtonMenu::OnMouseEnter(DirectX::XMINT2 mousePos)
+	{
+		UpdateHoveredButtons(mousePos);
+	}
+
+	void ButtonMenu::OnMouseMove(DirectX::XMINT2 mousePos)
+	{
+		UpdateHoveredButtons(mousePos);
+	}
+
+	//The cursor can move from one button to another without leaving the menu, so which one is hovered is worked out on every move
+	void ButtonMenu::UpdateHoveredButtons(DirectX::XMINT2 mousePos)
 	{
 		for (auto& button : ButtonList)
 		{	
@@ -50,20 +78,79 @@ namespace DivergenceEngine::Templates
 			{
 				//TODO: Maybe do something here to trigger a sound for when a button is hovered
 				button.IsCursorHoveringOver = true;
+				MarkDirty();
+			}
+			else if(!isCursorHoveringOver && button.IsCursorHoveringOver)
+			{
+				button.IsCursorHoveringOver = false;
+				MarkDirty();
 			}
-			else if(!isCursorHoveringOver)
+		}
+	}
+
+	void ButtonMenu::OnMouseLeave()
+	{
+		for (auto& button : ButtonList)
+		{
+			if (button.IsCursorHoveringOver)
 			{
 				button.IsCursorHoveringOver = false;
+				MarkDirty();
+			}
+		}
+	}
+
+	bool ButtonMenu::IsMarkedDirty() const noexcept
+	{
+		//The visuals are not in any layer themselves, so the menu is dirty if any of them are
+		if (IDrawable::IsMarkedDirty())
+		{
+			return true;
+		}
+
+		for (const auto& button : ButtonList)
+		{
+			if (button.ButtonDescription.DefaultVisual->IsMarkedDirty() || button.ButtonDescription.HoverVisual->IsMarkedDirty())
+			{
+				return true;
 			}
 		}
+		return false;
+	}
+
+	void ButtonMenu::ClearDirty() noexcept
+	{
+		IDrawable::ClearDirty();
+		for (auto& button : ButtonList)
+		{
+			button.ButtonDescription.DefaultVisual->ClearDirty();
+			button.ButtonDescription.HoverVisual->ClearDirty();
+		}
 	}
 
-	void ButtonMenu::OnMouseNotOver()
+	void ButtonMenu::SetPosition(DirectX::SimpleMath::Vector2 position)
 	{
+		DirectX::SimpleMath::Vector2 offset = position - Position;
+		Position = position;
+
+		auto moveVisual = [&offset](IDrawable* visual)
+			{
+				if (IPositionable* positionableVisual = dynamic_cast<IPositionable*>(visual))
+				{
+					positionableVisual->SetPosition(positionableVisual->GetPosition() + offset);
+				}
+			};
+
 		for (auto& button : ButtonList)
 		{
-			button.IsCursorHoveringOver = false;
+			//A button may use the same visual for both, which must only be moved once
+			moveVisual(button.ButtonDescription.DefaultVisual.get());
+			if (button.ButtonDescription.HoverVisual != button.ButtonDescription.DefaultVisual)
+			{
+				moveVisual(button.ButtonDescription.HoverVisual.get());
+			}
 		}
+		MarkBoundsChanged();
 	}
 
 	bool ButtonMenu::OnLeftPress(DirectX::XMINT2 mousePos)
@@ -1,12 +1,13 @@
 #pragma once
 #include "Templates/UnclickableDrawable.h"
+#include "Window/IPositionable.h"
 #include <functional>
 #include <memory>
 #include <vector>
 
 namespace DivergenceEngine::Templates
 {
-	class ButtonMenu : public IDrawable
+	class ButtonMenu : public IDrawable, public IPositionable
 	{
 	public:
 		//The Default and Hover visuals should always be in the same position and size
@@ -23,8 +24,10 @@ namespace DivergenceEngine::Templates
 		//Overriden Functions
 		void Draw() override;
 		bool IsCoordInObject(DirectX::XMINT2 mousePos) override;
-		void OnMouseOver(DirectX::XMINT2 mousePos) override;
-		void OnMouseNotOver() override;
+		std::optional<DirectX::SimpleMath::Rectangle> GetBounds() override;
+		void OnMouseEnter(DirectX::XMINT2 mousePos) override;
+		void OnMouseMove(DirectX::XMINT2 mousePos) override;
+		void OnMouseLeave() override;
 		bool OnLeftPress(DirectX::XMINT2 mousePos) override;
 		
 		bool OnLeftRelease(DirectX::XMINT2 mousePos) override { return false; }
@@ -32,6 +35,12 @@ namespace DivergenceEngine::Templates
 		bool OnMiddleRelease(DirectX::XMINT2 mousePos) override { return false; }
 		bool OnRightPress(DirectX::XMINT2 mousePos) override { return false; }
 		bool OnRightRelease(DirectX::XMINT2 mousePos) override { return false; }
+		bool IsMarkedDirty() const noexcept override;
+		void ClearDirty() noexcept override;
+
+		//The menu starts at (0, 0) and moving it moves every visual that can be positioned by the same amount
+		DirectX::SimpleMath::Vector2 GetPosition() const noexcept override { return Position; }
+		void SetPosition(DirectX::SimpleMath::Vector2 position) override;
 
 	private:
 		struct Button
@@ -42,5 +51,9 @@ namespace DivergenceEngine::Templates
 
 		//Datafields
 		std::vector<Button> ButtonList;
+		DirectX::SimpleMath::Vector2 Position;
+
+		//Helpers
+		void UpdateHoveredButtons(DirectX::XMINT2 mousePos);
 	};
 }
\ No newline at end of file
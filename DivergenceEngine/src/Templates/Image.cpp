@@ -2,6 +2,7 @@
 #include "Logger/Logger.h"
 #include "DXComErrorHandler.h"
 #include <wrl.h>
+#include <cmath>
 
 namespace wrl = Microsoft::WRL;
 
@@ -13,14 +14,13 @@ namespace DivergenceEngine::Templates
 		Position(position)
 	{
 		//Load the texture
-		CD3D11_TEXTURE2D_DESC textureDescription;
-		WindowGraphicsController.lock()->LoadTexture(FilePath, ImageTexture, textureDescription);
+		WindowGraphicsController.lock()->LoadTexture(FilePath, ImageTexture);
 
 		//Record the size of the texture
-		Size.x = static_cast<float>(textureDescription.Width);
-		Size.y = static_cast<float>(textureDescription.Height);
+		Size.x = static_cast<float>(ImageTexture->Description.Width);
+		Size.y = static_cast<float>(ImageTexture->Description.Height);
 
-		Logger::Log(std::format(L"Image loaded from file: {}", FilePath));
+		DIVERGENCE_LOG_DEBUG(L"Image loaded from file: {}", FilePath);
 	}
 
 	Image::Image(std::wstring filePath, std::weak_ptr<Graphics> graphicsController, DirectX::SimpleMath::Vector2 position, DirectX::SimpleMath::Vector2 size):
@@ -32,17 +32,17 @@ namespace DivergenceEngine::Templates
 		//Load the texture
 		WindowGraphicsController.lock()->LoadTexture(FilePath, ImageTexture);
 
-		Logger::Log(std::format(L"Image loaded from file: {}", FilePath));
+		DIVERGENCE_LOG_DEBUG(L"Image loaded from file: {}", FilePath);
 	}
 
 	Image::~Image()
 	{
-		Logger::Log(std::format(L"Image destructed: {}", FilePath));
+		DIVERGENCE_LOG_DEBUG(L"Image destructed: {}", FilePath);
 	}
 
 	void Image::Draw()
 	{
-		WindowGraphicsController.lock()->DrawSizedSprite(ImageTexture.Get(), Position, Size);
+		WindowGraphicsController.lock()->DrawSizedSprite(ImageTexture->ShaderResourceView.Get(), Position, Size, ImageTexture->TextureAlpha);
 	}
 	
 	bool Image::IsCoordInObject(DirectX::XMINT2 mousePos)
@@ -52,4 +52,20 @@ namespace DivergenceEngine::Templates
 
 		return withinXBounds && withinYBounds;
 	}
+
+	void Image::SetPosition(DirectX::SimpleMath::Vector2 position)
+	{
+		Position = position;
+		MarkBoundsChanged();
+	}
+
+	std::optional<DirectX::SimpleMath::Rectangle> Image::GetBounds()
+	{
+		//IsCoordInObject includes the right and bottom edges, so the bounds reach one pixel past them
+		long left = static_cast<long>(std::floor(Position.x));
+		long top = static_cast<long>(std::floor(Position.y));
+		long right = static_cast<long>(std::floor(Position.x + Size.x)) + 1;
+		long bottom = static_cast<long>(std::floor(Position.y + Size.y)) + 1;
+		return DirectX::SimpleMath::Rectangle(left, top, right - left, bottom - top);
+	}
 }
\ No newline at end of file
@@ -1,17 +1,18 @@
 #pragma once
 #include "Templates/UnclickableDrawable.h"
+#include "Window/IPositionable.h"
 #include "Graphics/Graphics.h"
 #include <string>
 
 namespace DivergenceEngine::Templates
 {
-	class Image : public DivergenceEngine::UnclickableDrawable
+	class Image : public DivergenceEngine::UnclickableDrawable, public DivergenceEngine::IPositionable
 	{
 	private:
 		//Datafields
 		std::wstring FilePath;
 		std::weak_ptr<Graphics> WindowGraphicsController;
-		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> ImageTexture;
+		std::shared_ptr<Texture> ImageTexture;
 		DirectX::SimpleMath::Vector2 Position;
 		DirectX::SimpleMath::Vector2 Size;
 		
@@ -22,11 +23,13 @@ namespace DivergenceEngine::Templates
 		~Image();
 
 		//Helpers
-		DirectX::SimpleMath::Vector2 GetPosition() { return Position; }
+		DirectX::SimpleMath::Vector2 GetPosition() const noexcept override { return Position; }
 		DirectX::SimpleMath::Vector2 GetSize() { return Size; }
 		
 		//Overriden functions
 		void Draw() override;
 		bool IsCoordInObject(DirectX::XMINT2 mousePos) override;
+		std::optional<DirectX::SimpleMath::Rectangle> GetBounds() override;
+		void SetPosition(DirectX::SimpleMath::Vector2 position) override;
 	};
 }
@@ -1,4 +1,5 @@
 #include "Templates/InvisibleDrawable.h"
+#include <cmath>
 
 namespace DivergenceEngine::Templates
 {
@@ -14,4 +15,20 @@ namespace DivergenceEngine::Templates
 
 		return withinXBounds && withinYBounds;
 	}
+
+	void InvisibleDrawable::SetPosition(DirectX::SimpleMath::Vector2 position)
+	{
+		Position = position;
+		MarkBoundsChanged();
+	}
+
+	std::optional<DirectX::SimpleMath::Rectangle> InvisibleDrawable::GetBounds()
+	{
+		//One pixel wider and taller than the size, to hold the edges IsCoordInObject accepts
+		long left = static_cast<long>(std::floor(Position.x));
+		long top = static_cast<long>(std::floor(Position.y));
+		long right = static_cast<long>(std::floor(Position.x + Size.x)) + 1;
+		long bottom = static_cast<long>(std::floor(Position.y + Size.y)) + 1;
+		return DirectX::SimpleMath::Rectangle(left, top, right - left, bottom - top);
+	}
 }
\ No newline at end of file
@@ -1,10 +1,11 @@
 #pragma once
 #include "Templates//UnclickableDrawable.h"
+#include "Window/IPositionable.h"
 #include <SimpleMath.h>
 
 namespace DivergenceEngine::Templates
 {
-	class InvisibleDrawable : public UnclickableDrawable
+	class InvisibleDrawable : public UnclickableDrawable, public IPositionable
 	{
 	private:
 		//Datafields
@@ -16,11 +17,13 @@ namespace DivergenceEngine::Templates
 		InvisibleDrawable(DirectX::SimpleMath::Vector2 position, DirectX::SimpleMath::Vector2 size);
 
 		//Helpers
-		DirectX::SimpleMath::Vector2 GetPosition() { return Position; }
+		DirectX::SimpleMath::Vector2 GetPosition() const noexcept override { return Position; }
 		DirectX::SimpleMath::Vector2 GetSize() { return Size; }
 
 		//Overriden functions
 		void Draw() override {}
 		bool IsCoordInObject(DirectX::XMINT2 mousePos) override;
+		std::optional<DirectX::SimpleMath::Rectangle> GetBounds() override;
+		void SetPosition(DirectX::SimpleMath::Vector2 position) override;
 	};
 }
\ No newline at end of file
@@ -7,60 +7,178 @@ namespace DivergenceEngine::Templates
 		WindowGraphicsController(graphicsController),
 		TextString(textString),
 		PositionCoord(positionCoord),
+		OriginClass(originClass),
 		Colour(colour),
-		DropShadow(dropShadow)
+		DropShadow(dropShadow),
+		FontSize(0)
 	{
 		//Load the font
 		WindowGraphicsController.lock()->LoadFont(spriteFontPath, SpriteFont);
 
-		//Compute the origin
-		OriginCoord = ComputeOrigin(originClass);
+		//Lay out the glyphs and compute the origin
+		RebuildLayout();
+	}
+
+	PlainText::PlainText(std::weak_ptr<Graphics> graphicsController, const std::wstring& textString, const std::wstring& sdfFontPath, float fontSize, DirectX::SimpleMath::Vector2 positionCoord, TextOriginClass originClass, DirectX::SimpleMath::Color colour, bool dropShadow) :
+		WindowGraphicsController(graphicsController),
+		TextString(textString),
+		PositionCoord(positionCoord),
+		OriginClass(originClass),
+		Colour(colour),
+		DropShadow(dropShadow),
+		FontSize(fontSize)
+	{
+		//Load the distance field font, which is shared by every size
+		WindowGraphicsController.lock()->LoadSDFFont(sdfFontPath, DistanceFieldFont);
+
+		//Lay out the glyphs and compute the origin
+		RebuildLayout();
 	}
 
 	DirectX::SimpleMath::Rectangle PlainText::GetBoundingRectangle() const noexcept
 	{
-		//Get the top left corner of the text
-		DirectX::SimpleMath::Vector2 topLeft = PositionCoord - OriginCoord;
+		return BoundingRectangle;
+	}
 
-		//Get the rectangle bounding the text
-		RECT boundingRect = SpriteFont.lock()->MeasureDrawBounds(TextString.c_str(), topLeft, false);
-		return DirectX::SimpleMath::Rectangle(boundingRect.left, boundingRect.top, boundingRect.right - boundingRect.left, boundingRect.bottom - boundingRect.top);
+	DirectX::SimpleMath::Vector2 PlainText::GetPosition() const noexcept
+	{
+		return PositionCoord;
 	}
 
 	void PlainText::SetTextString(const std::wstring& textString)
 	{
 		TextString = textString;
-		OriginCoord = ComputeOrigin(TextOriginClass::TopLeft);
+		RebuildLayout();
 	}
 
-	void PlainText::SetDropShadow(bool dropShadow) noexcept
+	void PlainText::SetFont(const std::wstring& spriteFontPath)
+	{
+		WindowGraphicsController.lock()->LoadFont(spriteFontPath, SpriteFont);
+		DistanceFieldFont.reset();
+		RebuildLayout();
+	}
+
+	void PlainText::SetSDFFont(const std::wstring& sdfFontPath, float fontSize)
+	{
+		WindowGraphicsController.lock()->LoadSDFFont(sdfFontPath, DistanceFieldFont);
+		SpriteFont.reset();
+		FontSize = fontSize;
+		RebuildLayout();
+	}
+
+	void PlainText::SetFontSize(float fontSize)
+	{
+		//Sprite fonts are baked at one size, so only distance field text can be resized
+		if (DistanceFieldFont.expired())
+		{
+			DIVERGENCE_LOG_WARNING(L"PlainText::SetFontSize() called on text without an SDF font");
+			return;
+		}
+
+		FontSize = fontSize;
+		RebuildLayout();
+	}
+
+	void PlainText::SetDropShadow(bool dropShadow)
 	{
 		DropShadow = dropShadow;
+		RebuildLayout();
+	}
+
+	void PlainText::SetOutline(uint32_t width, DirectX::SimpleMath::Color outlineColour, DirectX::XMINT2 offset)
+	{
+		//An explicit outline replaces the drop shadow
+		DropShadow = false;
+		Outline = TextOutlineDesc{ .Width = width, .Offset = offset };
+		OutlineColour = outlineColour;
+		RebuildLayout();
+	}
+
+	void PlainText::ClearOutline()
+	{
+		DropShadow = false;
+		Outline.reset();
+		RebuildLayout();
 	}
 
 	void PlainText::SetColour(DirectX::SimpleMath::Color colour) noexcept
 	{
 		Colour = colour;
+		MarkDirty();
+	}
+
+	void PlainText::SetPosition(DirectX::SimpleMath::Vector2 position)
+	{
+		//Moving the text does not change its layout, only where the bounds sit
+		PositionCoord = position;
+		PlaceBoundingRectangle();
+		MarkBoundsChanged();
 	}
 
 	void PlainText::Draw()
 	{
-		WindowGraphicsController.lock()->DrawString(SpriteFont.lock().get(), TextString, PositionCoord, OriginCoord, Colour, DropShadow);
+		//The drop shadow is a one pixel outline in the negation of the font colour
+		DirectX::SimpleMath::Color outlineColour = OutlineColour;
+		if (DropShadow)
+		{
+			outlineColour = Colour;
+			outlineColour.Negate();
+		}
+
+		if (std::shared_ptr<SDFFont> distanceFieldFont = DistanceFieldFont.lock())
+		{
+			WindowGraphicsController.lock()->DrawGlyphRun(distanceFieldFont.get(), TextGlyphRun, PositionCoord, OriginCoord, Colour, outlineColour);
+			return;
+		}
+
+		WindowGraphicsController.lock()->DrawGlyphRun(SpriteFont.lock().get(), TextGlyphRun, PositionCoord, OriginCoord, Colour, outlineColour);
 	}
 
 	bool PlainText::IsCoordInObject(DirectX::XMINT2 mousePos)
 	{
-		//Get the rectangle bounding the text
-		DirectX::SimpleMath::Rectangle boundingRectangle = GetBoundingRectangle();
+		//Check if the mouse is in the cached rectangle bounding the text
+		return BoundingRectangle.Contains(static_cast<long>(mousePos.x), static_cast<long> (mousePos.y));
+	}
+
+	std::optional<DirectX::SimpleMath::Rectangle> PlainText::GetBounds()
+	{
+		return BoundingRectangle;
+	}
 
-		//Check if the mouse is in the rectangle
-		return boundingRectangle.Contains(static_cast<long>(mousePos.x), static_cast<long> (mousePos.y));
+	void PlainText::RebuildLayout()
+	{
+		//Lay out the glyphs once, so drawing and hit testing never have to walk the string again
+		std::optional<TextOutlineDesc> outlineDescription = DropShadow ? TextOutlineDesc{ .Width = 1 } : Outline;
+		if (std::shared_ptr<SDFFont> distanceFieldFont = DistanceFieldFont.lock())
+		{
+			//Distance field outlines are drawn around the edge in place, so their offset is ignored
+			std::optional<float> outlineWidth = outlineDescription ? std::optional<float>(static_cast<float>(outlineDescription->Width)) : std::nullopt;
+			WindowGraphicsController.lock()->BuildGlyphRun(distanceFieldFont.get(), TextString, FontSize, TextGlyphRun, outlineWidth);
+		}
+		else
+		{
+			WindowGraphicsController.lock()->BuildGlyphRun(SpriteFont.lock().get(), TextString, TextGlyphRun, outlineDescription);
+		}
+		OriginCoord = ComputeOrigin(OriginClass);
+		PlaceBoundingRectangle();
+
+		//Anything that needs the layout rebuilt also changes how the text looks, and may move its bounds
+		MarkBoundsChanged();
+	}
+
+	void PlainText::PlaceBoundingRectangle() noexcept
+	{
+		//Move the bounds of the run to where the text is actually drawn
+		DirectX::SimpleMath::Vector2 topLeft = PositionCoord - OriginCoord;
+		BoundingRectangle = TextGlyphRun.Bounds;
+		BoundingRectangle.x += static_cast<long>(topLeft.x);
+		BoundingRectangle.y += static_cast<long>(topLeft.y);
 	}
 
 	DirectX::SimpleMath::Vector2 PlainText::ComputeOrigin(TextOriginClass originClass) noexcept
 	{
 		//Get the size of the string
-		DirectX::SimpleMath::Vector2 stringSize = SpriteFont.lock()->MeasureString(TextString.c_str(), false);
+		DirectX::SimpleMath::Vector2 stringSize = TextGlyphRun.Size;
 
 		//If the size is zero, return 0
 		if (stringSize == DirectX::SimpleMath::Vector2(0, 0))
@@ -101,7 +219,7 @@ namespace DivergenceEngine::Templates
 			break;
 
 		default:
-			DivergenceEngine::Logger::Log(L"Invalid TextOriginClass");
+			DIVERGENCE_LOG_WARNING(L"Invalid TextOriginClass");
 			assert(false);
 			return DirectX::SimpleMath::Vector2(0, 0);
 			break;
@@ -1,11 +1,13 @@
 #pragma once
 #include "Templates/UnclickableDrawable.h"
+#include "Window/IPositionable.h"
 #include "Graphics/Graphics.h"
 #include <string>
+#include <optional>
 
 namespace DivergenceEngine::Templates
 {
-	class PlainText : public DivergenceEngine::UnclickableDrawable
+	class PlainText : public DivergenceEngine::UnclickableDrawable, public DivergenceEngine::IPositionable
 	{
 	public:
 		enum class TextOriginClass
@@ -24,29 +26,48 @@ namespace DivergenceEngine::Templates
 		std::wstring TextString;
 		DirectX::SimpleMath::Vector2 PositionCoord;
 		DirectX::SimpleMath::Vector2 OriginCoord;
+		TextOriginClass OriginClass;
 		DirectX::SimpleMath::Color Colour;
 		bool DropShadow;
+		std::optional<TextOutlineDesc> Outline;
+		DirectX::SimpleMath::Color OutlineColour;
 		std::weak_ptr<DirectX::SpriteFont> SpriteFont;
+		std::weak_ptr<SDFFont> DistanceFieldFont; //Used instead of SpriteFont when the text was given an .sdffont
+		float FontSize;
 		std::weak_ptr<Graphics> WindowGraphicsController;
 
+		//Cached layout (only rebuilt when the text, font or outline changes)
+		GlyphRun TextGlyphRun;
+		DirectX::SimpleMath::Rectangle BoundingRectangle;
+
 		//Helpers
 		DirectX::SimpleMath::Vector2 ComputeOrigin(TextOriginClass originClass) noexcept;
+		void RebuildLayout();
+		void PlaceBoundingRectangle() noexcept;
 
 	public:
 		//Constructors and Destructor
 		PlainText(std::weak_ptr<Graphics> graphicsController, const std::wstring& textString, const std::wstring& spriteFontPath, DirectX::SimpleMath::Vector2 positionCoord, TextOriginClass originClass = TextOriginClass::TopLeft, DirectX::SimpleMath::Color colour = DirectX::Colors::White.v, bool dropShadow = false);
+		PlainText(std::weak_ptr<Graphics> graphicsController, const std::wstring& textString, const std::wstring& sdfFontPath, float fontSize, DirectX::SimpleMath::Vector2 positionCoord, TextOriginClass originClass = TextOriginClass::TopLeft, DirectX::SimpleMath::Color colour = DirectX::Colors::White.v, bool dropShadow = false);
 
 		//Getters
 		DirectX::SimpleMath::Rectangle GetBoundingRectangle() const noexcept;
+		DirectX::SimpleMath::Vector2 GetPosition() const noexcept override;
 
 		//Setters
 		void SetTextString(const std::wstring& textString);
-		void SetDropShadow(bool dropShadow) noexcept;
+		void SetFont(const std::wstring& spriteFontPath);
+		void SetSDFFont(const std::wstring& sdfFontPath, float fontSize);
+		void SetFontSize(float fontSize);
+		void SetDropShadow(bool dropShadow);
+		void SetOutline(uint32_t width, DirectX::SimpleMath::Color outlineColour, DirectX::XMINT2 offset = DirectX::XMINT2(0, 0));
+		void ClearOutline();
 		void SetColour(DirectX::SimpleMath::Color colour) noexcept;
-
+		void SetPosition(DirectX::SimpleMath::Vector2 position) override;
 
 		//Overriden functions
 		void Draw() override;
 		bool IsCoordInObject(DirectX::XMINT2 mousePos) override;
+		std::optional<DirectX::SimpleMath::Rectangle> GetBounds() override;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "Templates/ProfilerOverlay.h"
+#include "Profiler/Profiler.h"
+#include "StringConverter.h"
+#include <format>
+
+namespace DivergenceEngine::Templates
+{
+	ProfilerOverlay::ProfilerOverlay(std::weak_ptr<Graphics> graphicsController, const std::wstring& spriteFontPath, DirectX::SimpleMath::Vector2 position, size_t zoneCount, double refreshSeconds) :
+		Text(std::make_unique<PlainText>(graphicsController, L"Profiler", spriteFontPath, position)),
+		ZoneCount(zoneCount),
+		RefreshInterval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(refreshSeconds)))
+	{
+	}
+
+	DirectX::SimpleMath::Vector2 ProfilerOverlay::GetPosition() const noexcept
+	{
+		return Text->GetPosition();
+	}
+
+	void ProfilerOverlay::SetPosition(DirectX::SimpleMath::Vector2 position)
+	{
+		Text->SetPosition(position);
+	}
+
+	void ProfilerOverlay::Draw()
+	{
+		if (IsRefreshDue())
+		{
+			Refresh();
+		}
+
+		Text->Draw();
+	}
+
+	//Refreshing is what keeps the overlay changing, so a retained layer holding it is redrawn every refresh
+	bool ProfilerOverlay::IsMarkedDirty() const noexcept
+	{
+		return Text->IsMarkedDirty() || IsRefreshDue();
+	}
+
+	void ProfilerOverlay::ClearDirty() noexcept
+	{
+		Text->ClearDirty();
+	}
+
+	bool ProfilerOverlay::IsRefreshDue() const noexcept
+	{
+		return std::chrono::steady_clock::now() - LastRefreshTime >= RefreshInterval;
+	}
+
+	void ProfilerOverlay::Refresh()
+	{
+		LastRefreshTime = std::chrono::steady_clock::now();
+		if (!Profiler::IsEnabled())
+		{
+			Text->SetTextString(L"Profiler disabled");
+			return;
+		}
+
+		std::vector<ProfileZoneStatistics> listOfStatistics = Profiler::GetZoneStatistics();
+		std::wstring overlayText = L"Zone: avg / p99 / max ms (calls)";
+		for (size_t index = 0; index < listOfStatistics.size() && index < ZoneCount; index++)
+		{
+			const ProfileZoneStatistics& statistics = listOfStatistics[index];
+			overlayText += std::format(L"\n{}: {:.2f} / {:.2f} / {:.2f} ({})",
+				StringConverter::ConvertNarrowStringToWideString(statistics.Name),
+				statistics.AverageMilliseconds,
+				statistics.P99Milliseconds,
+				statistics.MaximumMilliseconds,
+				statistics.CallsLastFrame);
+		}
+
+		Text->SetTextString(overlayText);
+	}
+}
\ No newline at end of file
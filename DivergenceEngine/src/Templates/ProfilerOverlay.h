@@ -0,0 +1,42 @@
+#pragma once
+#include "Templates/UnclickableDrawable.h"
+#include "Templates/PlainText.h"
+#include "Window/IPositionable.h"
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace DivergenceEngine::Templates
+{
+	//Lists the zones that take the longest per frame. Add it to a layer above the page while the profiler is enabled
+	class ProfilerOverlay : public UnclickableDrawable, public IPositionable
+	{
+	private:
+		//Datafields
+		std::unique_ptr<PlainText> Text;
+		size_t ZoneCount;
+		std::chrono::steady_clock::duration RefreshInterval;
+		std::chrono::steady_clock::time_point LastRefreshTime;
+
+		//Helpers
+		bool IsRefreshDue() const noexcept;
+		void Refresh();
+
+	public:
+		//Constructors and Destructors
+		ProfilerOverlay(std::weak_ptr<Graphics> graphicsController, const std::wstring& spriteFontPath, DirectX::SimpleMath::Vector2 position, size_t zoneCount = 8, double refreshSeconds = 0.5);
+
+		//Getters
+		DirectX::SimpleMath::Vector2 GetPosition() const noexcept override;
+
+		//Setters
+		void SetPosition(DirectX::SimpleMath::Vector2 position) override;
+
+		//Overriden functions
+		void Draw() override;
+		bool IsCoordInObject(DirectX::XMINT2 mousePos) override { return false; }
+		std::optional<DirectX::SimpleMath::Rectangle> GetBounds() override { return DirectX::SimpleMath::Rectangle(); }
+		bool IsMarkedDirty() const noexcept override;
+		void ClearDirty() noexcept override;
+	};
+}
\ No newline at end of file
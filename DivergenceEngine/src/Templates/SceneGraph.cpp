@@ -0,0 +1,529 @@
+#include "SceneGraph.h"
+#include "Window/Window.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace DivergenceEngine::Templates
+{
+	SceneGraph::SceneGraph(Window* windowReference) :
+		WindowReference(windowReference),
+		WindowGraphicsController(windowReference->GraphicsController)
+	{}
+
+	SceneGraph::~SceneGraph()
+	{
+		//The drawables can outlive the graph, so they must stop reporting to it
+		for (auto& [drawable, slot] : SlotsOfDrawables)
+		{
+			drawable->BoundsUpdateQueue = nullptr;
+			drawable->IsBoundsUpdateQueued = false;
+		}
+	}
+
+	//Nodes----------------------------------------------------------------------------------------
+	SceneNodeHandle SceneGraph::AddNode(DirectX::SimpleMath::Vector2 localPosition, std::shared_ptr<IDrawable> drawable, SceneNodeHandle parent)
+	{
+		//The node goes at the end of its parent's subtree, so it is drawn after (over) its siblings. Nodes without a parent go at the end
+		uint32_t parentNode = parent.IsValid() ? GetNode(parent) : NO_NODE;
+		uint32_t node = (parentNode != NO_NODE) ? SubtreeEnds[parentNode] : static_cast<uint32_t>(Parents.size());
+
+		//Everything from the new node on moves back by one, and its ancestors' subtrees grow to hold it
+		for (size_t otherNode = 0; otherNode < Parents.size(); otherNode++)
+		{
+			if (Parents[otherNode] != NO_NODE && Parents[otherNode] >= node)
+			{
+				Parents[otherNode]++;
+			}
+			if (otherNode >= node)
+			{
+				SubtreeEnds[otherNode]++;
+			}
+		}
+		for (uint32_t ancestor = parentNode; ancestor != NO_NODE; ancestor = Parents[ancestor])
+		{
+			SubtreeEnds[ancestor]++;
+		}
+
+		uint32_t slot;
+		if (!FreeSlots.empty())
+		{
+			slot = FreeSlots.back();
+			FreeSlots.pop_back();
+		}
+		else
+		{
+			slot = static_cast<uint32_t>(NodesOfSlots.size());
+			NodesOfSlots.push_back(NO_NODE);
+			SlotGenerations.push_back(0);
+		}
+
+		IPositionable* positionable = dynamic_cast<IPositionable*>(drawable.get());
+		if (drawable)
+		{
+			drawable->BoundsUpdateQueue = &ChildBoundsUpdates;
+			SlotsOfDrawables[drawable.get()] = slot;
+		}
+
+		Parents.insert(Parents.begin() + node, parentNode);
+		SubtreeEnds.insert(SubtreeEnds.begin() + node, node + 1);
+		LocalPositions.insert(LocalPositions.begin() + node, localPosition);
+		WorldPositions.insert(WorldPositions.begin() + node, localPosition);
+		AreVisible.insert(AreVisible.begin() + node, 1);
+		AreTransformsDirty.insert(AreTransformsDirty.begin() + node, 1);
+		AreDrawableBoundsDirty.insert(AreDrawableBoundsDirty.begin() + node, 1);
+		AreSubtreesDirty.insert(AreSubtreesDirty.begin() + node, 0);
+		DrawableBounds.insert(DrawableBounds.begin() + node, DirectX::SimpleMath::Rectangle());
+		AreDrawablesUnbounded.insert(AreDrawablesUnbounded.begin() + node, 0);
+		SubtreeBounds.insert(SubtreeBounds.begin() + node, DirectX::SimpleMath::Rectangle());
+		AreSubtreesUnbounded.insert(AreSubtreesUnbounded.begin() + node, 0);
+		Drawables.insert(Drawables.begin() + node, std::move(drawable));
+		Positionables.insert(Positionables.begin() + node, positionable);
+		SlotsOfNodes.insert(SlotsOfNodes.begin() + node, slot);
+
+		for (size_t movedNode = node; movedNode < SlotsOfNodes.size(); movedNode++)
+		{
+			NodesOfSlots[SlotsOfNodes[movedNode]] = static_cast<uint32_t>(movedNode);
+		}
+
+		//What is under the cursor may have changed, so the Window hovers again
+		MarkSubtreeDirty(node);
+		MarkBoundsChanged();
+		return SceneNodeHandle{ .Index = slot, .Generation = SlotGenerations[slot] };
+	}
+
+	void SceneGraph::RemoveNode(SceneNodeHandle node)
+	{
+		//Removing a node removes its whole subtree with it
+		uint32_t firstNode = GetNode(node);
+		uint32_t lastNode = SubtreeEnds[firstNode];
+		uint32_t removedCount = lastNode - firstNode;
+		uint32_t parentNode = Parents[firstNode];
+
+		for (uint32_t ancestor = parentNode; ancestor != NO_NODE; ancestor = Parents[ancestor])
+		{
+			SubtreeEnds[ancestor] -= removedCount;
+		}
+		for (size_t otherNode = lastNode; otherNode < Parents.size(); otherNode++)
+		{
+			if (Parents[otherNode] != NO_NODE && Parents[otherNode] >= lastNode)
+			{
+				Parents[otherNode] -= removedCount;
+			}
+			SubtreeEnds[otherNode] -= removedCount;
+		}
+
+		for (uint32_t removedNode = firstNode; removedNode < lastNode; removedNode++)
+		{
+			uint32_t slot = SlotsOfNodes[removedNode];
+			NodesOfSlots[slot] = NO_NODE;
+			SlotGenerations[slot]++;
+			FreeSlots.push_back(slot);
+
+			if (Drawables[removedNode])
+			{
+				IDrawable* drawable = Drawables[removedNode].get();
+				if (drawable->IsBoundsUpdateQueued)
+				{
+					std::erase(ChildBoundsUpdates, drawable);
+					drawable->IsBoundsUpdateQueued = false;
+				}
+				drawable->BoundsUpdateQueue = nullptr;
+				SlotsOfDrawables.erase(drawable);
+
+				std::erase(HoveredDrawables, Drawables[removedNode].get());
+				std::erase(PreviouslyHoveredDrawables, Drawables[removedNode].get());
+				WindowReference->ReleaseDrawable(std::move(Drawables[removedNode]));
+			}
+		}
+
+		auto eraseNodes = [firstNode, lastNode](auto& field)
+			{
+				field.erase(field.begin() + firstNode, field.begin() + lastNode);
+			};
+		eraseNodes(Parents);
+		eraseNodes(SubtreeEnds);
+		eraseNodes(LocalPositions);
+		eraseNodes(WorldPositions);
+		eraseNodes(AreVisible);
+		eraseNodes(AreTransformsDirty);
+		eraseNodes(AreDrawableBoundsDirty);
+		eraseNodes(AreSubtreesDirty);
+		eraseNodes(DrawableBounds);
+		eraseNodes(AreDrawablesUnbounded);
+		eraseNodes(SubtreeBounds);
+		eraseNodes(AreSubtreesUnbounded);
+		eraseNodes(Drawables);
+		eraseNodes(Positionables);
+		eraseNodes(SlotsOfNodes);
+
+		for (size_t movedNode = firstNode; movedNode < SlotsOfNodes.size(); movedNode++)
+		{
+			NodesOfSlots[SlotsOfNodes[movedNode]] = static_cast<uint32_t>(movedNode);
+		}
+
+		//The bounds of the ancestors shrink. The parent comes before the removed nodes, so it has not moved
+		if (parentNode != NO_NODE)
+		{
+			MarkSubtreeDirty(parentNode);
+		}
+		MarkBoundsChanged();
+	}
+
+	bool SceneGraph::IsNodeValid(SceneNodeHandle node) const noexcept
+	{
+		return node.Index < NodesOfSlots.size() && SlotGenerations[node.Index] == node.Generation && NodesOfSlots[node.Index] != NO_NODE;
+	}
+
+	//Getters--------------------------------------------------------------------------------------
+	DirectX::SimpleMath::Vector2 SceneGraph::GetLocalPosition(SceneNodeHandle node) const
+	{
+		return LocalPositions[GetNode(node)];
+	}
+
+	DirectX::SimpleMath::Vector2 SceneGraph::GetWorldPosition(SceneNodeHandle node)
+	{
+		uint32_t nodeIndex = GetNode(node);
+		UpdateNodes();
+		return WorldPositions[nodeIndex];
+	}
+
+	bool SceneGraph::IsVisible(SceneNodeHandle node) const
+	{
+		return AreVisible[GetNode(node)] != 0;
+	}
+
+	//Setters--------------------------------------------------------------------------------------
+	void SceneGraph::SetLocalPosition(SceneNodeHandle node, DirectX::SimpleMath::Vector2 localPosition)
+	{
+		uint32_t nodeIndex = GetNode(node);
+		if (LocalPositions[nodeIndex] == localPosition)
+		{
+			return;
+		}
+
+		//Only the node and its ancestors are flagged. Its descendants move with it when the transforms are next worked out, and
+		//the Window hovers again in case it moved under or away from a still cursor
+		LocalPositions[nodeIndex] = localPosition;
+		AreTransformsDirty[nodeIndex] = 1;
+		MarkSubtreeDirty(nodeIndex);
+		MarkBoundsChanged();
+	}
+
+	void SceneGraph::SetVisible(SceneNodeHandle node, bool isVisible)
+	{
+		uint32_t nodeIndex = GetNode(node);
+		if ((AreVisible[nodeIndex] != 0) == isVisible)
+		{
+			return;
+		}
+
+		AreVisible[nodeIndex] = isVisible ? 1 : 0;
+		MarkBoundsChanged();
+	}
+
+	//Overriden functions--------------------------------------------------------------------------
+	void SceneGraph::Draw()
+	{
+		UpdateNodes();
+
+		DirectX::XMINT2 bufferSize = WindowGraphicsController.lock()->GetBufferSize();
+		DirectX::SimpleMath::Rectangle bufferRectangle(0, 0, bufferSize.x, bufferSize.y);
+		for (uint32_t node = 0; node < Drawables.size();)
+		{
+			if (IsSubtreeSkipped(node, bufferRectangle))
+			{
+				node = SubtreeEnds[node];
+				continue;
+			}
+
+			if (Drawables[node])
+			{
+				Drawables[node]->Draw();
+			}
+			node++;
+		}
+	}
+
+	bool SceneGraph::IsCoordInObject(DirectX::XMINT2 mousePos)
+	{
+		FindHitDrawables(mousePos);
+		return !HitDrawables.empty();
+	}
+
+	void SceneGraph::OnMouseEnter(DirectX::XMINT2 mousePos)
+	{
+		UpdateHoveredDrawables(mousePos, false);
+	}
+
+	void SceneGraph::OnMouseMove(DirectX::XMINT2 mousePos)
+	{
+		UpdateHoveredDrawables(mousePos, true);
+	}
+
+	void SceneGraph::OnMouseLeave()
+	{
+		std::swap(HoveredDrawables, PreviouslyHoveredDrawables);
+		HoveredDrawables.clear();
+
+		//A handler can remove nodes, so the events go out from a copy and skip anything no longer in the live list
+		PreviouslyHoveredSnapshot.assign(PreviouslyHoveredDrawables.begin(), PreviouslyHoveredDrawables.end());
+		for (IDrawable* drawable : PreviouslyHoveredSnapshot)
+		{
+			if (std::find(PreviouslyHoveredDrawables.begin(), PreviouslyHoveredDrawables.end(), drawable) != PreviouslyHoveredDrawables.end())
+			{
+				drawable->OnMouseLeave();
+			}
+		}
+	}
+
+	bool SceneGraph::OnLeftPress(DirectX::XMINT2 mousePos)
+	{
+		return DispatchPress(mousePos, [](IDrawable* drawable, DirectX::XMINT2 position) { return drawable->OnLeftPress(position); });
+	}
+
+	bool SceneGraph::OnLeftRelease(DirectX::XMINT2 mousePos)
+	{
+		return DispatchPress(mousePos, [](IDrawable* drawable, DirectX::XMINT2 position) { return drawable->OnLeftRelease(position); });
+	}
+
+	bool SceneGraph::OnMiddlePress(DirectX::XMINT2 mousePos)
+	{
+		return DispatchPress(mousePos, [](IDrawable* drawable, DirectX::XMINT2 position) { return drawable->OnMiddlePress(position); });
+	}
+
+	bool SceneGraph::OnMiddleRelease(DirectX::XMINT2 mousePos)
+	{
+		return DispatchPress(mousePos, [](IDrawable* drawable, DirectX::XMINT2 position) { return drawable->OnMiddleRelease(position); });
+	}
+
+	bool SceneGraph::OnRightPress(DirectX::XMINT2 mousePos)
+	{
+		return DispatchPress(mousePos, [](IDrawable* drawable, DirectX::XMINT2 position) { return drawable->OnRightPress(position); });
+	}
+
+	bool SceneGraph::OnRightRelease(DirectX::XMINT2 mousePos)
+	{
+		return DispatchPress(mousePos, [](IDrawable* drawable, DirectX::XMINT2 position) { return drawable->OnRightRelease(position); });
+	}
+
+	bool SceneGraph::IsMarkedDirty() const noexcept
+	{
+		//The drawables are not in any layer themselves, so the graph is dirty if any of them are
+		if (IDrawable::IsMarkedDirty())
+		{
+			return true;
+		}
+
+		return std::any_of(Drawables.begin(), Drawables.end(), [](const std::shared_ptr<IDrawable>& drawable)
+			{
+				return drawable && drawable->IsMarkedDirty();
+			});
+	}
+
+	void SceneGraph::ClearDirty() noexcept
+	{
+		IDrawable::ClearDirty();
+		for (auto& drawable : Drawables)
+		{
+			if (drawable)
+			{
+				drawable->ClearDirty();
+			}
+		}
+	}
+
+	//Helpers--------------------------------------------------------------------------------------
+	uint32_t SceneGraph::GetNode(SceneNodeHandle handle) const
+	{
+		if (!IsNodeValid(handle))
+		{
+			throw std::invalid_argument("SceneGraph::GetNode() - handle does not refer to a node in the graph");
+		}
+
+		return NodesOfSlots[handle.Index];
+	}
+
+	//Flags stop at the first ancestor that already has one, since everything above it is flagged too
+	void SceneGraph::MarkSubtreeDirty(uint32_t node)
+	{
+		for (uint32_t ancestor = node; ancestor != NO_NODE && !AreSubtreesDirty[ancestor]; ancestor = Parents[ancestor])
+		{
+			AreSubtreesDirty[ancestor] = 1;
+		}
+		IsAnySubtreeDirty = true;
+	}
+
+	void SceneGraph::UpdateNodes()
+	{
+		for (IDrawable* drawable : ChildBoundsUpdates)
+		{
+			drawable->IsBoundsUpdateQueued = false;
+			uint32_t node = NodesOfSlots[SlotsOfDrawables.at(drawable)];
+			AreDrawableBoundsDirty[node] = 1;
+			MarkSubtreeDirty(node);
+		}
+		ChildBoundsUpdates.clear();
+
+		if (!IsAnySubtreeDirty)
+		{
+			return;
+		}
+
+		for (uint32_t root = 0; root < Parents.size(); root = SubtreeEnds[root])
+		{
+			if (AreSubtreesDirty[root])
+			{
+				UpdateSubtree(root, false);
+			}
+		}
+		IsAnySubtreeDirty = false;
+
+		//Drawables moved in the pass may have reported their new bounds, which were already read after they moved
+		for (IDrawable* drawable : ChildBoundsUpdates)
+		{
+			drawable->IsBoundsUpdateQueued = false;
+		}
+		ChildBoundsUpdates.clear();
+	}
+
+	//Parents are worked out before their children, and a subtree's bounds after all of its children. Clean children are only
+	//walked into when they moved with their parent
+	void SceneGraph::UpdateSubtree(uint32_t node, bool isParentMoved)
+	{
+		uint32_t parent = Parents[node];
+		bool isMoved = isParentMoved || AreTransformsDirty[node];
+		if (isMoved)
+		{
+			WorldPositions[node] = (parent != NO_NODE) ? WorldPositions[parent] + LocalPositions[node] : LocalPositions[node];
+			if (Positionables[node] != nullptr)
+			{
+				Positionables[node]->SetPosition(WorldPositions[node]);
+			}
+			AreDrawableBoundsDirty[node] = 1;
+		}
+
+		if (AreDrawableBoundsDirty[node])
+		{
+			std::optional<DirectX::SimpleMath::Rectangle> drawableBounds = Drawables[node] ? Drawables[node]->GetBounds() : DirectX::SimpleMath::Rectangle();
+			AreDrawablesUnbounded[node] = drawableBounds.has_value() ? 0 : 1;
+			DrawableBounds[node] = (drawableBounds.has_value() && !drawableBounds->IsEmpty()) ? *drawableBounds : DirectX::SimpleMath::Rectangle();
+		}
+
+		SubtreeBounds[node] = DrawableBounds[node];
+		AreSubtreesUnbounded[node] = AreDrawablesUnbounded[node];
+		for (uint32_t child = node + 1; child < SubtreeEnds[node]; child = SubtreeEnds[child])
+		{
+			if (isMoved || AreSubtreesDirty[child])
+			{
+				UpdateSubtree(child, isMoved);
+			}
+
+			AreSubtreesUnbounded[node] |= AreSubtreesUnbounded[child];
+			if (!SubtreeBounds[child].IsEmpty())
+			{
+				SubtreeBounds[node] = SubtreeBounds[node].IsEmpty() ? SubtreeBounds[child] : DirectX::SimpleMath::Rectangle::Union(SubtreeBounds[node], SubtreeBounds[child]);
+			}
+		}
+
+		AreTransformsDirty[node] = 0;
+		AreDrawableBoundsDirty[node] = 0;
+		AreSubtreesDirty[node] = 0;
+	}
+
+	bool SceneGraph::IsSubtreeSkipped(uint32_t node, const DirectX::SimpleMath::Rectangle& area) const noexcept
+	{
+		if (!AreVisible[node])
+		{
+			return true;
+		}
+
+		return !AreSubtreesUnbounded[node] && !SubtreeBounds[node].Intersects(area);
+	}
+
+	//Fills HitDrawables with the drawables under the mouse, topmost first, down to the first one that blocks input
+	void SceneGraph::FindHitDrawables(DirectX::XMINT2 mousePos)
+	{
+		UpdateNodes();
+
+		HitDrawables.clear();
+		DirectX::SimpleMath::Rectangle mouseRectangle(mousePos.x, mousePos.y, 1, 1);
+		for (uint32_t node = 0; node < Drawables.size();)
+		{
+			if (IsSubtreeSkipped(node, mouseRectangle))
+			{
+				node = SubtreeEnds[node];
+				continue;
+			}
+
+			if (Drawables[node] && Drawables[node]->IsCoordInObject(mousePos))
+			{
+				HitDrawables.push_back(Drawables[node].get());
+			}
+			node++;
+		}
+
+		//Later nodes are drawn over earlier ones
+		std::reverse(HitDrawables.begin(), HitDrawables.end());
+		auto blockingDrawable = std::find_if(HitDrawables.begin(), HitDrawables.end(), [](IDrawable* drawable) { return drawable->BlocksInput(); });
+		IsLastHitBlocking = blockingDrawable != HitDrawables.end();
+		if (IsLastHitBlocking)
+		{
+			HitDrawables.erase(blockingDrawable + 1, HitDrawables.end());
+		}
+	}
+
+	void SceneGraph::UpdateHoveredDrawables(DirectX::XMINT2 mousePos, bool isMove)
+	{
+		FindHitDrawables(mousePos);
+		std::swap(HoveredDrawables, PreviouslyHoveredDrawables);
+		HoveredDrawables = HitDrawables;
+
+		//A handler can remove nodes, which takes their drawables out of both lists, so the events go out from copies and skip
+		//anything no longer in the live list
+		HoveredSnapshot.assign(HoveredDrawables.begin(), HoveredDrawables.end());
+		PreviouslyHoveredSnapshot.assign(PreviouslyHoveredDrawables.begin(), PreviouslyHoveredDrawables.end());
+		for (IDrawable* drawable : PreviouslyHoveredSnapshot)
+		{
+			if (std::find(PreviouslyHoveredDrawables.begin(), PreviouslyHoveredDrawables.end(), drawable) == PreviouslyHoveredDrawables.end())
+			{
+				continue;
+			}
+
+			if (std::find(HoveredSnapshot.begin(), HoveredSnapshot.end(), drawable) == HoveredSnapshot.end())
+			{
+				drawable->OnMouseLeave();
+			}
+		}
+
+		for (IDrawable* drawable : HoveredSnapshot)
+		{
+			if (std::find(HoveredDrawables.begin(), HoveredDrawables.end(), drawable) == HoveredDrawables.end())
+			{
+				continue;
+			}
+
+			if (std::find(PreviouslyHoveredSnapshot.begin(), PreviouslyHoveredSnapshot.end(), drawable) == PreviouslyHoveredSnapshot.end())
+			{
+				drawable->OnMouseEnter(mousePos);
+			}
+			else if (isMove)
+			{
+				drawable->OnMouseMove(mousePos);
+			}
+		}
+	}
+
+	//Offers the press to the drawables under the mouse from the top down, like the Window does with its layers
+	bool SceneGraph::DispatchPress(DirectX::XMINT2 mousePos, const std::function<bool(IDrawable*, DirectX::XMINT2)>& handler)
+	{
+		FindHitDrawables(mousePos);
+		for (IDrawable* drawable : HitDrawables)
+		{
+			if (handler(drawable, mousePos))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
\ No newline at end of file
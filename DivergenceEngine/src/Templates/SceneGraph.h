@@ -0,0 +1,123 @@
+#pragma once
+#include "Window/IDrawable.h"
+#include "Window/IPositionable.h"
+#include "Graphics/Graphics.h"
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace DivergenceEngine
+{
+	class Window;
+}
+
+namespace DivergenceEngine::Templates
+{
+	//Refers to a node in a SceneGraph. A handle stays safe to use after its node is removed, it just stops finding anything
+	struct SceneNodeHandle
+	{
+		static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+		uint32_t Index = INVALID_INDEX;
+		uint32_t Generation = 0;
+
+		bool IsValid() const noexcept { return Index != INVALID_INDEX; }
+		bool operator==(const SceneNodeHandle& other) const noexcept = default;
+	};
+
+	//Places drawables in a hierarchy where every node is positioned relative to its parent, so moving a node moves everything
+	//under it. The whole graph goes into a Window layer as one drawable, and draws and hit tests its nodes itself. It has no
+	//bounds of its own, so the Window always hit tests it and it culls its own nodes.
+	//Nodes are kept depth first with each of their fields in its own array. That way a subtree is one run of nodes, so a subtree
+	//that is hidden, off the buffer or unchanged is skipped in a single jump. Moving a node or changing a drawable's bounds flags
+	//it and its ancestors, and only the flagged subtrees have their transforms and bounds worked out again
+	class SceneGraph : public IDrawable
+	{
+	private:
+		//Constants
+		static constexpr uint32_t NO_NODE = std::numeric_limits<uint32_t>::max();
+
+		//Nodes (depth first, so the subtree of a node is the range [node, SubtreeEnds[node]))
+		std::vector<uint32_t> Parents;
+		std::vector<uint32_t> SubtreeEnds;
+		std::vector<DirectX::SimpleMath::Vector2> LocalPositions;
+		std::vector<DirectX::SimpleMath::Vector2> WorldPositions;
+		std::vector<uint8_t> AreVisible;
+		std::vector<uint8_t> AreTransformsDirty;
+		std::vector<uint8_t> AreDrawableBoundsDirty;
+		std::vector<uint8_t> AreSubtreesDirty; //Set on every ancestor of a node with either flag above, so clean subtrees are skipped
+		std::vector<DirectX::SimpleMath::Rectangle> DrawableBounds;
+		std::vector<uint8_t> AreDrawablesUnbounded;
+		std::vector<DirectX::SimpleMath::Rectangle> SubtreeBounds;
+		std::vector<uint8_t> AreSubtreesUnbounded; //A drawable without bounds could be anywhere, so its subtree is never culled
+		std::vector<std::shared_ptr<IDrawable>> Drawables;
+		std::vector<IPositionable*> Positionables;
+		std::vector<uint32_t> SlotsOfNodes;
+
+		//Handle slots
+		std::vector<uint32_t> NodesOfSlots;
+		std::vector<uint32_t> SlotGenerations;
+		std::vector<uint32_t> FreeSlots;
+		std::unordered_map<IDrawable*, uint32_t> SlotsOfDrawables;
+
+		//Datafields
+		Window* WindowReference;
+		std::weak_ptr<Graphics> WindowGraphicsController;
+		bool IsAnySubtreeDirty = false;
+		std::vector<IDrawable*> ChildBoundsUpdates; //Drawables in the graph that called MarkBoundsChanged since the last update
+		bool IsLastHitBlocking = false;
+		std::vector<IDrawable*> HitDrawables;
+		std::vector<IDrawable*> HoveredDrawables;
+		std::vector<IDrawable*> PreviouslyHoveredDrawables;
+		std::vector<IDrawable*> HoveredSnapshot; //Copies of the two lists above that hover events are sent from
+		std::vector<IDrawable*> PreviouslyHoveredSnapshot;
+
+		//Helpers
+		uint32_t GetNode(SceneNodeHandle handle) const;
+		void MarkSubtreeDirty(uint32_t node);
+		void UpdateNodes();
+		void UpdateSubtree(uint32_t node, bool isParentMoved);
+		bool IsSubtreeSkipped(uint32_t node, const DirectX::SimpleMath::Rectangle& area) const noexcept;
+		void FindHitDrawables(DirectX::XMINT2 mousePos);
+		void UpdateHoveredDrawables(DirectX::XMINT2 mousePos, bool isMove);
+		bool DispatchPress(DirectX::XMINT2 mousePos, const std::function<bool(IDrawable*, DirectX::XMINT2)>& handler);
+
+	public:
+		//Constructors and Destructors
+		SceneGraph(Window* windowReference); //Removed nodes are handed back to the window, which keeps them until nothing can still use them
+		~SceneGraph();
+
+		//Nodes. A drawable that can be positioned is moved to the world position of its node, and kept there
+		SceneNodeHandle AddNode(DirectX::SimpleMath::Vector2 localPosition, std::shared_ptr<IDrawable> drawable = nullptr, SceneNodeHandle parent = SceneNodeHandle());
+		void RemoveNode(SceneNodeHandle node);
+		bool IsNodeValid(SceneNodeHandle node) const noexcept;
+
+		//Getters
+		DirectX::SimpleMath::Vector2 GetLocalPosition(SceneNodeHandle node) const;
+		DirectX::SimpleMath::Vector2 GetWorldPosition(SceneNodeHandle node);
+		bool IsVisible(SceneNodeHandle node) const;
+
+		//Setters
+		void SetLocalPosition(SceneNodeHandle node, DirectX::SimpleMath::Vector2 localPosition);
+		void SetVisible(SceneNodeHandle node, bool isVisible);
+
+		//Overriden functions
+		void Draw() override;
+		bool IsCoordInObject(DirectX::XMINT2 mousePos) override;
+		bool BlocksInput() const noexcept override { return IsLastHitBlocking; }
+		void OnMouseEnter(DirectX::XMINT2 mousePos) override;
+		void OnMouseMove(DirectX::XMINT2 mousePos) override;
+		void OnMouseLeave() override;
+		bool OnLeftPress(DirectX::XMINT2 mousePos) override;
+		bool OnLeftRelease(DirectX::XMINT2 mousePos) override;
+		bool OnMiddlePress(DirectX::XMINT2 mousePos) override;
+		bool OnMiddleRelease(DirectX::XMINT2 mousePos) override;
+		bool OnRightPress(DirectX::XMINT2 mousePos) override;
+		bool OnRightRelease(DirectX::XMINT2 mousePos) override;
+		bool IsMarkedDirty() const noexcept override;
+		void ClearDirty() noexcept override;
+	};
+}
\ No newline at end of file
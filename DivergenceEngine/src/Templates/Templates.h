@@ -3,4 +3,6 @@
 #include "UnclickableDrawable.h"
 #include "ButtonMenu.h"
 #include "InvisibleDrawable.h"
-#include "PlainText.h"
\ No newline at end of file
+#include "PlainText.h"
+#include "SceneGraph.h"
+#include "ProfilerOverlay.h"
\ No newline at end of file
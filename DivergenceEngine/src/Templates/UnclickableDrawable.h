@@ -7,13 +7,15 @@ namespace DivergenceEngine
 	class UnclickableDrawable : public IDrawable
 	{
 	public:
-		void OnMouseOver(DirectX::XMINT2 mousePos) override {};
-		void OnMouseNotOver() override {};
+		void OnMouseEnter(DirectX::XMINT2 mousePos) override {};
+		void OnMouseMove(DirectX::XMINT2 mousePos) override {};
+		void OnMouseLeave() override {};
 		bool OnLeftPress(DirectX::XMINT2 mousePos) override { return false; };
 		bool OnLeftRelease(DirectX::XMINT2 mousePos) override { return false; };
 		bool OnMiddlePress(DirectX::XMINT2 mousePos) override { return false; };
 		bool OnMiddleRelease(DirectX::XMINT2 mousePos) override { return false; };
 		bool OnRightPress(DirectX::XMINT2 mousePos) override { return false; };
 		bool OnRightRelease(DirectX::XMINT2 mousePos) override { return false; };
+		bool BlocksInput() const noexcept override { return false; };
 	};
 }
@@ -1,10 +1,21 @@
 #pragma once
 #include <SimpleMath.h>
+#include <optional>
+#include <vector>
 
 namespace DivergenceEngine
 {
+	namespace Templates
+	{
+		class SceneGraph;
+	}
+
 	class IDrawable
 	{	
+		friend class SpatialGrid;
+		friend class Templates::SceneGraph;
+		friend class Application;
+
 	public:
 
 		virtual ~IDrawable() {};
@@ -22,16 +33,36 @@ namespace DivergenceEngine
 		virtual bool IsCoordInObject(DirectX::XMINT2 mousePos) = 0;
 
 		/// <summary>
-		/// Called whenever the Window has deemed that the cursor is over the object. This is called
-		/// on every iteration of the message loop that the cursor is over it.
+		/// Called once when the cursor comes over the object, either because the cursor moved onto it or the object
+		/// moved under it. Objects under one that blocks input are not considered under the cursor.
+		/// </summary>
+		/// <param name="mousePos">The coordinate of the mouse on the entire screen buffer</param>
+		virtual void OnMouseEnter(DirectX::XMINT2 mousePos) = 0;
+
+		/// <summary>
+		/// Called when the cursor moves while it stays over the object. Nothing is called while the cursor is still.
 		/// </summary>
-		virtual void OnMouseOver(DirectX::XMINT2 mousePos) = 0;
+		/// <param name="mousePos">The coordinate of the mouse on the entire screen buffer</param>
+		virtual void OnMouseMove(DirectX::XMINT2 mousePos) = 0;
 
 		/// <summary>
-		/// Called whenever the Window has deemed that the cursor is not over the object. This is called
-		/// on every iteration of the message loop that the cursor is not over it.
+		/// Called once when the cursor stops being over an object it entered.
 		/// </summary>
-		virtual void OnMouseNotOver() = 0;
+		virtual void OnMouseLeave() = 0;
+
+		/// <summary>
+		/// Gets the rectangle, in buffer coordinates, outside of which IsCoordInObject is always false. The Window uses it
+		/// to only hit test objects near the cursor. Call MarkBoundsChanged whenever the rectangle changes.
+		/// </summary>
+		/// <returns>The bounds of the object, or nothing if it could be hit anywhere</returns>
+		virtual std::optional<DirectX::SimpleMath::Rectangle> GetBounds() { return std::nullopt; }
+
+		/// <summary>
+		/// Checks if the object hides the objects drawn under it from the mouse. Where an object that blocks input is hit,
+		/// the objects under it are not hovered or pressed, even if it did not handle the press itself.
+		/// </summary>
+		/// <returns>True if the object is opaque to input, false if input passes through it</returns>
+		virtual bool BlocksInput() const noexcept { return true; }
 
 		/// <summary>
 		/// The code that runs when the object is pressed down with the left button
@@ -74,5 +105,48 @@ namespace DivergenceEngine
 		/// <param name="mousePos">The coordinate of the mouse on the entire screen buffer</param>
 		/// <returns></returns>
 		virtual bool OnRightRelease(DirectX::XMINT2 mousePos) = 0;
+
+		/// <summary>
+		/// Flags the object as changed, so a Window in retained render mode draws its layer again on the next frame.
+		/// Call this whenever something that changes how the object looks is modified.
+		/// </summary>
+		void MarkDirty() noexcept { IsDirty = true; }
+
+		/// <summary>
+		/// Checks if the object has changed since its layer was last drawn in retained render mode.
+		/// </summary>
+		/// <returns>True if the object needs to be drawn again</returns>
+		virtual bool IsMarkedDirty() const noexcept { return IsDirty; }
+
+		/// <summary>
+		/// Called by the Window once the object has been drawn into its retained layer.
+		/// </summary>
+		virtual void ClearDirty() noexcept { IsDirty = false; }
+
+		/// <summary>
+		/// Tells the Window that GetBounds has changed, so the object is hit tested at its new place. This also marks it dirty.
+		/// </summary>
+		void MarkBoundsChanged()
+		{
+			MarkDirty();
+			if (BoundsUpdateQueue != nullptr && !IsBoundsUpdateQueued)
+			{
+				BoundsUpdateQueue->push_back(this);
+				IsBoundsUpdateQueued = true;
+			}
+		}
+
+		/// <summary>
+		/// Gets how far, from 0 to 1, the frame being drawn is between the last page update and the next. Pages only
+		/// update at their own fixed rate in the FixedInterpolated simulation, where an object that moves in UpdatePage can
+		/// draw at Lerp(previous, current, alpha) to move smoothly. In every other simulation, this is 1.
+		/// </summary>
+		static float GetInterpolationAlpha() noexcept { return InterpolationAlpha; }
+
+	private:
+		inline static float InterpolationAlpha = 1.0f; //Set by the Application before the windows draw
+		bool IsDirty = true;
+		std::vector<IDrawable*>* BoundsUpdateQueue = nullptr; //Set by the SpatialGrid or SceneGraph the object is in
+		bool IsBoundsUpdateQueued = false;
 	};
 }
\ No newline at end of file
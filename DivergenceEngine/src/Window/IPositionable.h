@@ -0,0 +1,25 @@
+#pragma once
+#include <SimpleMath.h>
+
+namespace DivergenceEngine
+{
+	class IPositionable
+	{
+	public:
+
+		virtual ~IPositionable() {};
+
+		/// <summary>
+		/// Gets where the object is placed on the buffer.
+		/// </summary>
+		/// <returns>The position of the object, in buffer coordinates</returns>
+		virtual DirectX::SimpleMath::Vector2 GetPosition() const noexcept = 0;
+
+		/// <summary>
+		/// Moves the object so it is placed at the given position on the buffer. A SceneGraph calls this with the
+		/// world position of the node the object is attached to.
+		/// </summary>
+		/// <param name="position">The new position of the object, in buffer coordinates</param>
+		virtual void SetPosition(DirectX::SimpleMath::Vector2 position) = 0;
+	};
+}
\ No newline at end of file
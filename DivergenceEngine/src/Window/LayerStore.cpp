@@ -0,0 +1,242 @@
+#include "LayerStore.h"
+#include <stdexcept>
+
+namespace DivergenceEngine
+{
+	LayerStore::IterationGuard::IterationGuard(LayerStore& store) noexcept :
+		Store(store)
+	{
+		Store.IterationDepth++;
+	}
+
+	LayerStore::IterationGuard::~IterationGuard()
+	{
+		Store.IterationDepth--;
+		if (Store.IterationDepth == 0)
+		{
+			Store.CompactLayers();
+			if (!Store.IsRetainingReleases)
+			{
+				Store.PendingReleases.clear();
+			}
+		}
+	}
+
+	DrawableHandle LayerStore::Add(std::shared_ptr<IDrawable> drawable, size_t layer)
+	{
+		if (!drawable)
+		{
+			throw std::invalid_argument("LayerStore::Add() - drawable cannot be null");
+		}
+
+		//Reuse the slot of a removed drawable if there is one. Its generation moves on, so old handles to it stop working
+		uint32_t slotIndex;
+		if (!FreeSlots.empty())
+		{
+			slotIndex = FreeSlots.back();
+			FreeSlots.pop_back();
+		}
+		else
+		{
+			slotIndex = static_cast<uint32_t>(Slots.size());
+			Slots.emplace_back();
+		}
+
+		if (Layers.size() <= layer)
+		{
+			Layers.resize(layer + 1);
+		}
+
+		Layer& targetLayer = Layers[layer];
+		Slot& slot = Slots[slotIndex];
+		slot.Drawable = std::move(drawable);
+		slot.Layer = static_cast<uint32_t>(layer);
+		slot.DenseIndex = static_cast<uint32_t>(targetLayer.Drawables.size());
+		targetLayer.Drawables.push_back(slot.Drawable.get());
+		targetLayer.SlotIndices.push_back(slotIndex);
+		SlotIndexOfDrawable[slot.Drawable.get()] = slotIndex;
+
+		return DrawableHandle{ .Index = slotIndex, .Generation = slot.Generation };
+	}
+
+	bool LayerStore::Remove(DrawableHandle handle)
+	{
+		if (Get(handle) == nullptr)
+		{
+			return false;
+		}
+
+		Slot& slot = Slots[handle.Index];
+		Layer& layer = Layers[slot.Layer];
+		layer.Drawables[slot.DenseIndex] = nullptr;
+		layer.TombstoneCount++;
+		ReleaseSlot(handle.Index);
+
+		//Compact once a quarter of the layer is tombstones, so iterating never walks mostly empty entries
+		if (IterationDepth == 0 && layer.TombstoneCount * 4 > layer.Drawables.size())
+		{
+			CompactLayer(layer);
+		}
+		return true;
+	}
+
+	void LayerStore::ClearLayer(size_t layer)
+	{
+		if (Layers.size() <= layer)
+		{
+			return;
+		}
+
+		//Tombstone the whole layer at once rather than removing one by one, which could compact the layer partway through
+		Layer& clearedLayer = Layers[layer];
+		for (size_t denseIndex = 0; denseIndex < clearedLayer.Drawables.size(); denseIndex++)
+		{
+			if (clearedLayer.Drawables[denseIndex] == nullptr)
+			{
+				continue;
+			}
+
+			ReleaseSlot(clearedLayer.SlotIndices[denseIndex]);
+			clearedLayer.Drawables[denseIndex] = nullptr;
+			clearedLayer.TombstoneCount++;
+		}
+
+		if (IterationDepth == 0)
+		{
+			CompactLayer(clearedLayer);
+		}
+	}
+
+	void LayerStore::Clear()
+	{
+		for (size_t layer = 0; layer < Layers.size(); layer++)
+		{
+			ClearLayer(layer);
+		}
+
+		if (IterationDepth == 0)
+		{
+			Layers.clear();
+		}
+	}
+
+	void LayerStore::SetRetainingReleases(bool isRetainingReleases) noexcept
+	{
+		IsRetainingReleases = isRetainingReleases;
+	}
+
+	void LayerStore::Release(std::shared_ptr<IDrawable> drawable)
+	{
+		//Something may still be calling into the drawable, so it is only let go of once iteration is over
+		if (IterationDepth > 0 || IsRetainingReleases)
+		{
+			PendingReleases.push_back(std::move(drawable));
+		}
+	}
+
+	void LayerStore::TakeReleasedDrawables(std::vector<std::shared_ptr<IDrawable>>& releasedDrawables)
+	{
+		//Drawables removed during iteration may still be in use until it is over
+		if (IterationDepth > 0)
+		{
+			return;
+		}
+
+		for (std::shared_ptr<IDrawable>& releasedDrawable : PendingReleases)
+		{
+			releasedDrawables.push_back(std::move(releasedDrawable));
+		}
+		PendingReleases.clear();
+	}
+
+	//Getters--------------------------------------------------------------------------------------
+	std::optional<DrawableHandle> LayerStore::Find(const IDrawable* drawable) const
+	{
+		auto slotIterator = SlotIndexOfDrawable.find(const_cast<IDrawable*>(drawable));
+		if (slotIterator == SlotIndexOfDrawable.end())
+		{
+			return std::nullopt;
+		}
+
+		return DrawableHandle{ .Index = slotIterator->second, .Generation = Slots[slotIterator->second].Generation };
+	}
+
+	IDrawable* LayerStore::Get(DrawableHandle handle) const noexcept
+	{
+		if (handle.Index >= Slots.size() || Slots[handle.Index].Generation != handle.Generation)
+		{
+			return nullptr;
+		}
+
+		return Slots[handle.Index].Drawable.get();
+	}
+
+	size_t LayerStore::GetLayerIndex(DrawableHandle handle) const
+	{
+		if (Get(handle) == nullptr)
+		{
+			throw std::invalid_argument("LayerStore::GetLayerIndex() - handle does not refer to a drawable in the store");
+		}
+
+		return Slots[handle.Index].Layer;
+	}
+
+	size_t LayerStore::GetLayerCount() const noexcept
+	{
+		return Layers.size();
+	}
+
+	const std::vector<IDrawable*>& LayerStore::GetLayer(size_t layer) const
+	{
+		return Layers.at(layer).Drawables;
+	}
+
+	//Helpers--------------------------------------------------------------------------------------
+
+	//Frees the slot of a drawable that has been taken out of its layer. Old handles to the slot stop finding anything
+	void LayerStore::ReleaseSlot(uint32_t slotIndex)
+	{
+		Slot& slot = Slots[slotIndex];
+		SlotIndexOfDrawable.erase(slot.Drawable.get());
+
+		Release(std::move(slot.Drawable));
+		slot.Drawable.reset();
+		slot.Generation++;
+		FreeSlots.push_back(slotIndex);
+	}
+
+	//Slides the live drawables down over the tombstones, keeping their order, and points their slots at their new places
+	void LayerStore::CompactLayer(Layer& layer)
+	{
+		if (layer.TombstoneCount == 0)
+		{
+			return;
+		}
+
+		size_t writeIndex = 0;
+		for (size_t readIndex = 0; readIndex < layer.Drawables.size(); readIndex++)
+		{
+			if (layer.Drawables[readIndex] == nullptr)
+			{
+				continue;
+			}
+
+			layer.Drawables[writeIndex] = layer.Drawables[readIndex];
+			layer.SlotIndices[writeIndex] = layer.SlotIndices[readIndex];
+			Slots[layer.SlotIndices[writeIndex]].DenseIndex = static_cast<uint32_t>(writeIndex);
+			writeIndex++;
+		}
+
+		layer.Drawables.resize(writeIndex);
+		layer.SlotIndices.resize(writeIndex);
+		layer.TombstoneCount = 0;
+	}
+
+	void LayerStore::CompactLayers()
+	{
+		for (Layer& layer : Layers)
+		{
+			CompactLayer(layer);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+#include "Window/IDrawable.h"
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace DivergenceEngine
+{
+	//Refers to a drawable in a LayerStore. A handle stays safe to use after its drawable is removed, it just stops finding anything
+	struct DrawableHandle
+	{
+		static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+		uint32_t Index = INVALID_INDEX;
+		uint32_t Generation = 0;
+
+		bool IsValid() const noexcept { return Index != INVALID_INDEX; }
+		bool operator==(const DrawableHandle& other) const noexcept = default;
+	};
+
+	//Keeps the drawables of each layer in a contiguous array in draw order, with a sparse table of slots behind the handles.
+	//Removing leaves a tombstone in the layer, so it takes constant time and never shifts what is being iterated. The layers
+	//are compacted once no one is iterating them
+	class LayerStore
+	{
+	public:
+		//While one of these exists, removed drawables are kept alive and the layers are not compacted, so whatever is being
+		//iterated stays valid even if a callback removes drawables
+		class IterationGuard
+		{
+		private:
+			LayerStore& Store;
+
+		public:
+			IterationGuard(LayerStore& store) noexcept;
+			~IterationGuard();
+			IterationGuard(const IterationGuard&) = delete;
+			IterationGuard& operator=(const IterationGuard&) = delete;
+		};
+
+	private:
+		struct Slot
+		{
+			std::shared_ptr<IDrawable> Drawable;
+			uint32_t Generation = 0;
+			uint32_t Layer = 0;
+			uint32_t DenseIndex = 0;
+		};
+
+		struct Layer
+		{
+			std::vector<IDrawable*> Drawables; //nullptr marks a removed drawable
+			std::vector<uint32_t> SlotIndices;
+			size_t TombstoneCount = 0;
+		};
+
+		//Datafields
+		std::vector<Slot> Slots;
+		std::vector<uint32_t> FreeSlots;
+		std::vector<Layer> Layers;
+		std::unordered_map<IDrawable*, uint32_t> SlotIndexOfDrawable;
+		uint32_t IterationDepth = 0;
+		bool IsRetainingReleases = false;
+		std::vector<std::shared_ptr<IDrawable>> PendingReleases;
+
+		//Helpers
+		void ReleaseSlot(uint32_t slotIndex);
+
+		void CompactLayer(Layer& layer);
+		void CompactLayers();
+
+	public:
+		//Public functions
+		DrawableHandle Add(std::shared_ptr<IDrawable> drawable, size_t layer);
+		bool Remove(DrawableHandle handle);
+		void ClearLayer(size_t layer);
+		void Clear();
+
+		//While retaining, removed drawables are kept alive until they are taken, for when something other than the store may
+		//still be reading them, such as a frame recorded on another thread
+		void SetRetainingReleases(bool isRetainingReleases) noexcept;
+		void TakeReleasedDrawables(std::vector<std::shared_ptr<IDrawable>>& releasedDrawables);
+
+		//Lets go of a drawable that was drawn from inside one of the layers, such as a node of a SceneGraph, under the same rules
+		//as a drawable removed from the store
+		void Release(std::shared_ptr<IDrawable> drawable);
+
+		//Getters
+		std::optional<DrawableHandle> Find(const IDrawable* drawable) const;
+		IDrawable* Get(DrawableHandle handle) const noexcept;
+		size_t GetLayerIndex(DrawableHandle handle) const;
+		size_t GetLayerCount() const noexcept;
+
+		//The drawables of a layer in draw order. Entries are nullptr where a drawable was removed while the layer was being iterated
+		const std::vector<IDrawable*>& GetLayer(size_t layer) const;
+	};
+}
\ No newline at end of file
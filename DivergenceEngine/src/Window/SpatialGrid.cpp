@@ -0,0 +1,191 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace DivergenceEngine
+{
+	SpatialGrid::SpatialGrid(DirectX::XMINT2 bufferSize) :
+		Columns(std::max<int32_t>(1, (bufferSize.x + CELL_SIZE - 1) / CELL_SIZE)),
+		Rows(std::max<int32_t>(1, (bufferSize.y + CELL_SIZE - 1) / CELL_SIZE))
+	{
+		Cells.resize(static_cast<size_t>(Columns) * Rows);
+	}
+
+	SpatialGrid::~SpatialGrid()
+	{
+		Clear();
+	}
+
+	void SpatialGrid::Insert(IDrawable* drawable, size_t layer, uint64_t order)
+	{
+		//A drawable already in the grid just moves to its new place in the draw order
+		Remove(drawable);
+
+		uint32_t entryIndex;
+		if (!FreeEntries.empty())
+		{
+			entryIndex = FreeEntries.back();
+			FreeEntries.pop_back();
+		}
+		else
+		{
+			entryIndex = static_cast<uint32_t>(Entries.size());
+			Entries.emplace_back();
+		}
+
+		Entries[entryIndex] = { .Drawable = drawable, .Layer = layer, .Order = order };
+		EntryIndices[drawable] = entryIndex;
+		drawable->BoundsUpdateQueue = &PendingBoundsUpdates;
+		PlaceEntry(entryIndex);
+	}
+
+	void SpatialGrid::Remove(IDrawable* drawable)
+	{
+		auto entryIterator = EntryIndices.find(drawable);
+		if (entryIterator == EntryIndices.end())
+		{
+			return;
+		}
+
+		//Anything it queued is dropped, since the drawable may be destroyed before the next query
+		if (drawable->IsBoundsUpdateQueued)
+		{
+			std::erase(PendingBoundsUpdates, drawable);
+			drawable->IsBoundsUpdateQueued = false;
+		}
+		drawable->BoundsUpdateQueue = nullptr;
+
+		UnplaceEntry(entryIterator->second);
+		Entries[entryIterator->second].Drawable = nullptr;
+		FreeEntries.push_back(entryIterator->second);
+		EntryIndices.erase(entryIterator);
+	}
+
+	void SpatialGrid::Clear()
+	{
+		for (auto& [drawable, entryIndex] : EntryIndices)
+		{
+			drawable->BoundsUpdateQueue = nullptr;
+			drawable->IsBoundsUpdateQueued = false;
+		}
+
+		for (auto& cell : Cells)
+		{
+			cell.clear();
+		}
+		UnboundedEntries.clear();
+		Entries.clear();
+		FreeEntries.clear();
+		EntryIndices.clear();
+		PendingBoundsUpdates.clear();
+	}
+
+	void SpatialGrid::Query(DirectX::XMINT2 point, std::vector<Candidate>& candidates)
+	{
+		ApplyPendingBoundsUpdates();
+		candidates.clear();
+
+		auto addCandidate = [this, &candidates](uint32_t entryIndex)
+			{
+				const Entry& entry = Entries[entryIndex];
+				candidates.push_back({ .Drawable = entry.Drawable, .Layer = entry.Layer, .Order = entry.Order });
+			};
+
+		//Points off the buffer can only be over drawables without bounds
+		if (point.x >= 0 && point.y >= 0 && point.x < Columns * CELL_SIZE && point.y < Rows * CELL_SIZE)
+		{
+			DirectX::XMINT2 cell = GetCell(point);
+			for (uint32_t entryIndex : Cells[static_cast<size_t>(cell.y) * Columns + cell.x])
+			{
+				addCandidate(entryIndex);
+			}
+		}
+
+		for (uint32_t entryIndex : UnboundedEntries)
+		{
+			addCandidate(entryIndex);
+		}
+
+		//Whatever was drawn last is on top, so it gets the first chance at the input
+		std::sort(candidates.begin(), candidates.end(), [](const Candidate& left, const Candidate& right)
+			{
+				return left.Layer != right.Layer ? left.Layer > right.Layer : left.Order > right.Order;
+			});
+	}
+
+	//Getters--------------------------------------------------------------------------------------
+	bool SpatialGrid::HasPendingBoundsUpdates() const noexcept
+	{
+		return !PendingBoundsUpdates.empty();
+	}
+
+	//Helpers--------------------------------------------------------------------------------------
+	void SpatialGrid::PlaceEntry(uint32_t entryIndex)
+	{
+		Entry& entry = Entries[entryIndex];
+		std::optional<DirectX::SimpleMath::Rectangle> bounds = entry.Drawable->GetBounds();
+		entry.IsUnbounded = !bounds.has_value();
+		if (entry.IsUnbounded)
+		{
+			UnboundedEntries.push_back(entryIndex);
+			return;
+		}
+
+		//Empty bounds cannot hold any point, so the drawable is left out of every cell
+		if (bounds->width <= 0 || bounds->height <= 0)
+		{
+			entry.FirstCell = DirectX::XMINT2(0, 0);
+			entry.LastCell = DirectX::XMINT2(-1, -1);
+			return;
+		}
+
+		entry.FirstCell = GetCell(DirectX::XMINT2(bounds->x, bounds->y));
+		entry.LastCell = GetCell(DirectX::XMINT2(bounds->x + bounds->width - 1, bounds->y + bounds->height - 1));
+		for (int32_t row = entry.FirstCell.y; row <= entry.LastCell.y; row++)
+		{
+			for (int32_t column = entry.FirstCell.x; column <= entry.LastCell.x; column++)
+			{
+				Cells[static_cast<size_t>(row) * Columns + column].push_back(entryIndex);
+			}
+		}
+	}
+
+	void SpatialGrid::UnplaceEntry(uint32_t entryIndex)
+	{
+		const Entry& entry = Entries[entryIndex];
+		if (entry.IsUnbounded)
+		{
+			std::erase(UnboundedEntries, entryIndex);
+			return;
+		}
+
+		for (int32_t row = entry.FirstCell.y; row <= entry.LastCell.y; row++)
+		{
+			for (int32_t column = entry.FirstCell.x; column <= entry.LastCell.x; column++)
+			{
+				std::erase(Cells[static_cast<size_t>(row) * Columns + column], entryIndex);
+			}
+		}
+	}
+
+	//Moves the drawables that changed their bounds since the last query. Only they are touched, not the whole grid
+	void SpatialGrid::ApplyPendingBoundsUpdates()
+	{
+		for (IDrawable* drawable : PendingBoundsUpdates)
+		{
+			drawable->IsBoundsUpdateQueued = false;
+			uint32_t entryIndex = EntryIndices.at(drawable);
+			UnplaceEntry(entryIndex);
+			PlaceEntry(entryIndex);
+		}
+		PendingBoundsUpdates.clear();
+	}
+
+	//Bounds that reach off the buffer are clamped to the cells on its edge
+	DirectX::XMINT2 SpatialGrid::GetCell(DirectX::XMINT2 point) const noexcept
+	{
+		return DirectX::XMINT2(
+			std::clamp(point.x / CELL_SIZE, 0, Columns - 1),
+			std::clamp(point.y / CELL_SIZE, 0, Rows - 1));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+#include "Window/IDrawable.h"
+#include <SimpleMath.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace DivergenceEngine
+{
+	//Buckets drawables by the cells of the buffer their bounds cover, so finding what is under a point only has to look at the
+	//drawables in one cell instead of every drawable in the window
+	class SpatialGrid
+	{
+	public:
+		//A drawable that may be under a point, along with where it sits in the draw order
+		struct Candidate
+		{
+			IDrawable* Drawable;
+			size_t Layer;
+			uint64_t Order;
+		};
+
+	private:
+		struct Entry
+		{
+			IDrawable* Drawable;
+			size_t Layer;
+			uint64_t Order;
+			bool IsUnbounded; //Drawables without bounds are checked at every point
+			DirectX::XMINT2 FirstCell;
+			DirectX::XMINT2 LastCell;
+		};
+
+		//Constants
+		static constexpr int32_t CELL_SIZE = 64;
+
+		//Datafields
+		int32_t Columns;
+		int32_t Rows;
+		std::vector<std::vector<uint32_t>> Cells;
+		std::vector<uint32_t> UnboundedEntries;
+		std::vector<Entry> Entries;
+		std::vector<uint32_t> FreeEntries;
+		std::unordered_map<IDrawable*, uint32_t> EntryIndices;
+		std::vector<IDrawable*> PendingBoundsUpdates;
+
+		//Helpers
+		void PlaceEntry(uint32_t entryIndex);
+		void UnplaceEntry(uint32_t entryIndex);
+		void ApplyPendingBoundsUpdates();
+		DirectX::XMINT2 GetCell(DirectX::XMINT2 point) const noexcept;
+
+	public:
+		//Constructors and Destructors
+		SpatialGrid(DirectX::XMINT2 bufferSize);
+		~SpatialGrid();
+
+		//Deleted stuff
+		SpatialGrid(const SpatialGrid&) = delete;
+		SpatialGrid& operator=(const SpatialGrid&) = delete;
+
+		//Public functions
+		void Insert(IDrawable* drawable, size_t layer, uint64_t order);
+		void Remove(IDrawable* drawable);
+		void Clear();
+
+		//Fills candidates with every drawable whose bounds hold the point, in reverse draw order (the topmost drawable first)
+		void Query(DirectX::XMINT2 point, std::vector<Candidate>& candidates);
+
+		//Getters
+		bool HasPendingBoundsUpdates() const noexcept;
+	};
+}
\ No newline at end of file
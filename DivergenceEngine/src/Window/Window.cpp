@@ -1,7 +1,16 @@
 #include "Window.h"
 #include "Logger/Logger.h"
+#include "Profiler/Profiler.h"
+#include "Metrics/Metrics.h"
 #include <Windows.h>
 #include <format>
+#include <chrono>
+#include <exception>
+#include <execution>
+#include <mutex>
+#include <algorithm>
+#include <numeric>
+#include <utility>
 #include "Application/Application.h"
 
 namespace DivergenceEngine
@@ -25,13 +34,13 @@ namespace DivergenceEngine
 		windowClass.hIconSm = nullptr;
 		RegisterClassEx(&windowClass);
 
-		Logger::Log(std::format(L"WindowClass '{}' Constructed", WindowClassName));
+		DIVERGENCE_LOG_DEBUG(L"WindowClass '{}' Constructed", WindowClassName);
 	}
 
 	Window::WindowClass::~WindowClass()
 	{
 		UnregisterClass(GetName(), GetModuleHandle(nullptr));
-		Logger::Log(std::format(L"WindowClass '{}' Destructed", WindowClassName));
+		DIVERGENCE_LOG_DEBUG(L"WindowClass '{}' Destructed", WindowClassName);
 	}
 
 	Window::WindowClass& Window::WindowClass::GetCurrentInstance()
@@ -86,6 +95,7 @@ namespace DivergenceEngine
 		
 		//Initialize the graphics controller
 		GraphicsController = std::make_shared<Graphics>(Application::GetFrameRate(), WindowHandle, clientWidth, clientHeight);
+		HitTestGrid = std::make_unique<SpatialGrid>(GraphicsController->GetBufferSize());
 
 		//Initialize the audio
 		DirectX::AUDIO_ENGINE_FLAGS eflags = DirectX::AudioEngine_Default;
@@ -98,13 +108,10 @@ namespace DivergenceEngine
 		IsAudioControllerUpdating = true;
 		AudioUpdateThread = std::thread(&Window::AudioUpdateThreadFunction, this);
 
-		//Initialize size for three layers of drawables
-		LayersOfDrawableComponents.reserve(3);
-		
 		//Initialize the page, with the window pointer
 		PageReference->Initialize(this);
 
-		Logger::Log(std::format(L"Window '{}' Constructed", WindowTitle));
+		DIVERGENCE_LOG_DEBUG(L"Window '{}' Constructed", WindowTitle);
 	}
 
 	Window::~Window()
@@ -114,6 +121,9 @@ namespace DivergenceEngine
 		{
 			return;
 		}
+
+		//The render thread draws with the Graphics controller, so it has to stop before anything is torn down
+		StopRenderThread();
 		
 		//Suspend audio on window close
 		if (AudioController)
@@ -126,7 +136,7 @@ namespace DivergenceEngine
 		AudioUpdateThread.join();
 		
 		DestroyWindow(WindowHandle);
-		Logger::Log(std::format(L"Window '{}' Destructed", WindowTitle));
+		DIVERGENCE_LOG_DEBUG(L"Window '{}' Destructed", WindowTitle);
 	}
 
 	LRESULT Window::HandleMessageSetup(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
@@ -143,7 +153,7 @@ namespace DivergenceEngine
 
 			//Set the new message proc as the HandleMessageThunk function
 			SetWindowLongPtr(hWnd, GWLP_WNDPROC, reinterpret_cast<LONG_PTR>(&Window::HandleMessageThunk));
-			Logger::Log(std::format(L"Set non-static class message proc to Window '{}'", pWindow->WindowTitle));
+			DIVERGENCE_LOG_TRACE(L"Set non-static class message proc to Window '{}'", pWindow->WindowTitle);
 
 			//Forward the message to the actual message handler function
 			return pWindow->HandleMessage(hWnd, uMsg, wParam, lParam);
@@ -186,6 +196,9 @@ namespace DivergenceEngine
 			{
 				GraphicsController->ResetRenderTargetAndViewport(ClientWidth, ClientHeight);
 			}
+
+			//The back buffer has to be composed again, even if no layer changed
+			IsCompositionStale = true;
 			break;
 
 		case WM_KILLFOCUS:
@@ -216,14 +229,10 @@ namespace DivergenceEngine
 		{
 			POINTS mousePosition = MAKEPOINTS(lParam);
 
-			//Scale the mousePosition to the internal graphics buffer, to make collision of mouse to objects easier
-			DirectX::XMINT2 bufferSize = GraphicsController->GetBufferSize();
-			double xScaleRatio = static_cast<double>(bufferSize.x) / static_cast<double>(ClientWidth);
-			double yScaleRatio = static_cast<double>(bufferSize.y) / static_cast<double>(ClientHeight);
-			mousePosition.x = static_cast<short>(mousePosition.x * xScaleRatio);
-			mousePosition.y = static_cast<short>(mousePosition.y * yScaleRatio);
+			//Map the mousePosition to the internal graphics buffer, through the same scaling the scene is drawn with, to make collision of mouse to objects easier
+			DirectX::XMINT2 bufferPosition = GraphicsController->ClientToBuffer(DirectX::XMINT2(mousePosition.x, mousePosition.y));
 
-			MouseObject.OnMouseMove(mousePosition.x, mousePosition.y);
+			MouseObject.OnMouseMove(bufferPosition.x, bufferPosition.y);
 			break;
 		}
 
@@ -266,26 +275,504 @@ namespace DivergenceEngine
 
 	void Window::RenderWindow()
 	{
-		//Clear the screen
+		Profiler::Zone profileZone("Window::RenderWindow");
+		std::chrono::steady_clock::time_point frameStartTime = std::chrono::steady_clock::now();
+		IsLastFrameSkipped = false;
+
+		if (RenderMode == RenderModeClass::Retained)
+		{
+			RenderRetainedWindow();
+		}
+		else
+		{
+			//Clear the screen
+			GraphicsController->ClearFrame(0.5f, 0.0f, 0.9f);
+
+			//Cycle through the layers and render them
+			for (size_t layer = 0; layer < Layers.GetLayerCount(); layer++)
+			{
+				GraphicsController->BeginGPUPass("Layer", static_cast<uint32_t>(layer));
+				DrawLayer(layer);
+				GraphicsController->EndGPUPass();
+			}
+
+			//Present frame. If the device was lost, the frame is dropped and the next one is drawn on the new device
+			if (GraphicsController->Present())
+			{
+				Statistics.FramesPresented++;
+			}
+			Statistics.LayersRedrawn += Layers.GetLayerCount();
+		}
+
+		//Record how long the CPU spent on the frame
+		Statistics.LastFrameCPUMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStartTime).count();
+		TotalFrameCPUMilliseconds += Statistics.LastFrameCPUMilliseconds;
+		Statistics.AverageFrameCPUMilliseconds = TotalFrameCPUMilliseconds / static_cast<double>(Statistics.FramesPresented + Statistics.FramesSkipped);
+		UpdateProcessCPUUsage();
+	}
+
+	void Window::RenderRetainedWindow()
+	{
+		//The caches were drawn at the old resolution if dynamic resolution changed it
+		if (GraphicsController->GetRenderScale() != LayerCacheRenderScale)
+		{
+			LayerCacheRenderScale = GraphicsController->GetRenderScale();
+			DirtyLayers.assign(Layers.GetLayerCount(), true);
+		}
+
+		//A lost device takes the caches with it, so every layer is drawn again on the new one
+		if (GraphicsController->GetDeviceLostCount() != LayerCacheDeviceLostCount)
+		{
+			LayerCacheDeviceLostCount = GraphicsController->GetDeviceLostCount();
+			DirtyLayers.assign(Layers.GetLayerCount(), true);
+		}
+
+		//Find the layers that have a drawable which changed since the layer was cached
+		DirtyLayers.resize(Layers.GetLayerCount(), true);
+		bool isAnyLayerDirty = false;
+		for (size_t layer = 0; layer < Layers.GetLayerCount(); layer++)
+		{
+			for (IDrawable* component : Layers.GetLayer(layer))
+			{
+				if (component != nullptr && component->IsMarkedDirty())
+				{
+					DirtyLayers[layer] = true;
+					break;
+				}
+			}
+			isAnyLayerDirty = isAnyLayerDirty || DirtyLayers[layer];
+		}
+
+		//Nothing changed, so the last presented frame is still on screen. The frame is waited out instead of drawn again, once
+		//for all the windows by the Application, so windows that skip together do not wait one after the other
+		if (!isAnyLayerDirty && !IsCompositionStale)
+		{
+			IsLastFrameSkipped = true;
+			Statistics.FramesSkipped++;
+			return;
+		}
+
+		//Only draw the dirty layers again, into their caches
+		for (size_t layer = 0; layer < Layers.GetLayerCount(); layer++)
+		{
+			if (!DirtyLayers[layer])
+			{
+				continue;
+			}
+
+			GraphicsController->BeginLayerCache(layer);
+			GraphicsController->BeginGPUPass("Layer", static_cast<uint32_t>(layer));
+			DrawLayer(layer);
+			GraphicsController->EndGPUPass();
+			for (IDrawable* component : Layers.GetLayer(layer))
+			{
+				if (component != nullptr)
+				{
+					component->ClearDirty();
+				}
+			}
+			GraphicsController->EndLayerCache();
+
+			DirtyLayers[layer] = false;
+			Statistics.LayersRedrawn++;
+		}
+
+		//Compose the cached layers and present. The flip model discards the back buffer, so it is composed from the caches every time
 		GraphicsController->ClearFrame(0.5f, 0.0f, 0.9f);
+		GraphicsController->BeginGPUPass("LayerCaches");
+		GraphicsController->DrawLayerCaches(Layers.GetLayerCount());
+		GraphicsController->EndGPUPass();
+		if (!GraphicsController->Present())
+		{
+			//The layer caches went with the lost device, so every layer has to be drawn again
+			DirtyLayers.assign(Layers.GetLayerCount(), true);
+			IsCompositionStale = true;
+			return;
+		}
 
-		//Cycle through the layers and render them
-		for (auto& layer : LayersOfDrawableComponents)
+		IsCompositionStale = false;
+		Statistics.FramesPresented++;
+	}
+
+	void Window::DrawLayer(size_t layer)
+	{
+		Profiler::Zone profileZone("Window::DrawLayer");
+
+		//Layers without a state of their own are drawn with the default one
+		LayerRenderState layerRenderState = layer < LayerRenderStates.size() ? LayerRenderStates[layer] : LayerRenderState();
+		GraphicsController->SetLayerRenderState(layerRenderState);
+		GraphicsController->SetSpriteLayerDepth(0.0f);
+
+		//Removed drawables leave a null entry behind until the layer is compacted, so those are skipped
+		const std::vector<IDrawable*>& drawables = Layers.GetLayer(layer);
+		if (CommandRecording == CommandRecordingClass::Off)
 		{
-			for (auto& component : layer)
+			for (size_t drawable = 0; drawable < drawables.size(); drawable++)
 			{
-				component->Draw();
+				if (drawables[drawable] != nullptr)
+				{
+					drawables[drawable]->Draw();
+				}
 			}
+			return;
 		}
-		
-		//Present frame
-		GraphicsController->Present();
+
+		//Split the layer into chunks in order, so that joining the chunks' lists back together keeps the layer's draw order
+
+		size_t chunkCount = 1;
+		if (CommandRecording == CommandRecordingClass::Parallel)
+		{
+			chunkCount = std::max<size_t>(1, (drawables.size() + DRAWABLES_PER_RECORDING_CHUNK - 1) / DRAWABLES_PER_RECORDING_CHUNK);
+		}
+		if (RecordingChunkCommandLists.size() < chunkCount)
+		{
+			RecordingChunkCommandLists.resize(chunkCount);
+		}
+		RecordingChunkIndices.resize(chunkCount);
+		std::iota(RecordingChunkIndices.begin(), RecordingChunkIndices.end(), size_t(0));
+
+		//Exceptions cannot leave a parallel algorithm without terminating, so the first one is carried back to this thread
+		std::exception_ptr recordingException;
+		std::mutex recordingExceptionMutex;
+		auto recordChunk = [&](size_t chunk)
+			{
+				RenderCommandList& chunkCommandList = RecordingChunkCommandLists[chunk];
+				chunkCommandList.Clear();
+
+				size_t firstDrawable = chunk * DRAWABLES_PER_RECORDING_CHUNK;
+				size_t lastDrawable = (chunkCount == 1) ? drawables.size() : (std::min)(firstDrawable + DRAWABLES_PER_RECORDING_CHUNK, drawables.size());
+
+				GraphicsController->BeginCommandRecording(chunkCommandList);
+				GraphicsController->SetSpriteLayerDepth(0.0f);
+				try
+				{
+					for (size_t drawable = firstDrawable; drawable < lastDrawable; drawable++)
+					{
+						if (drawables[drawable] != nullptr)
+						{
+							drawables[drawable]->Draw();
+						}
+					}
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> exceptionLock(recordingExceptionMutex);
+					if (!recordingException)
+					{
+						recordingException = std::current_exception();
+					}
+				}
+				GraphicsController->EndCommandRecording();
+			};
+
+		if (chunkCount > 1)
+		{
+			std::for_each(std::execution::par, RecordingChunkIndices.begin(), RecordingChunkIndices.end(), recordChunk);
+		}
+		else
+		{
+			recordChunk(0);
+		}
+
+		if (recordingException)
+		{
+			std::rethrow_exception(recordingException);
+		}
+
+		//Join the chunks and submit them on this thread, which owns the device context. Texture sorted layers are also grouped
+		//by shader here, since the batch has to restart whenever the shader changes
+		LayerCommandList.Clear();
+		for (size_t chunk = 0; chunk < chunkCount; chunk++)
+		{
+			LayerCommandList.Append(RecordingChunkCommandLists[chunk]);
+		}
+		GraphicsController->SubmitCommandList(LayerCommandList, layerRenderState.SortMode == DirectX::SpriteSortMode_Texture);
+	}
+
+	//Pipelined rendering--------------------------------------------------------------------------
+	void Window::RecordAndPublishSnapshot()
+	{
+		Profiler::Zone profileZone("Window::RecordAndPublishSnapshot");
+		std::chrono::steady_clock::time_point recordStartTime = std::chrono::steady_clock::now();
+
+		//Record every layer with its state, so the render thread needs nothing from the drawables or the window
+		FrameSnapshot& snapshot = Snapshots[RecordingSnapshotIndex];
+		snapshot.FrameNumber = NextSnapshotNumber++;
+		snapshot.DeviceLostCount = GraphicsController->GetDeviceLostCount();
+		snapshot.Layers.resize(Layers.GetLayerCount());
+		for (size_t layer = 0; layer < snapshot.Layers.size(); layer++)
+		{
+			LayerSnapshot& layerSnapshot = snapshot.Layers[layer];
+			layerSnapshot.RenderState = layer < LayerRenderStates.size() ? LayerRenderStates[layer] : LayerRenderState();
+			layerSnapshot.CommandList.Clear();
+
+			GraphicsController->BeginCommandRecording(layerSnapshot.CommandList);
+			GraphicsController->SetSpriteLayerDepth(0.0f);
+			try
+			{
+				for (IDrawable* component : Layers.GetLayer(layer))
+				{
+					if (component != nullptr)
+					{
+						component->Draw();
+					}
+				}
+			}
+			catch (...)
+			{
+				GraphicsController->EndCommandRecording();
+				throw;
+			}
+			GraphicsController->EndCommandRecording();
+		}
+		Statistics.LayersRedrawn += snapshot.Layers.size();
+
+		//Hand the snapshot over. If the render thread has not started on the last one yet, this replaces it
+		{
+			std::lock_guard<std::mutex> snapshotLock(SnapshotMutex);
+			if (IsSnapshotReady)
+			{
+				RenderThreadSnapshotsDropped++;
+			}
+			std::swap(RecordingSnapshotIndex, ReadySnapshotIndex);
+			IsSnapshotReady = true;
+		}
+		SnapshotCondition.notify_one();
+
+		//Gather what the render thread has counted since the last frame
+		Statistics.FramesPresented += RenderThreadFramesPresented.exchange(0);
+		Statistics.SnapshotsDropped += RenderThreadSnapshotsDropped.exchange(0);
+		TotalRenderThreadMilliseconds += static_cast<double>(RenderThreadTotalMicroseconds.exchange(0)) / 1000.0;
+		RenderedSnapshotCount += RenderThreadSnapshotCount.exchange(0);
+		Statistics.RenderThreadFramesPerSecond = RenderThreadFramesPerSecond;
+		if (RenderedSnapshotCount != 0)
+		{
+			Statistics.AverageRenderThreadMilliseconds = TotalRenderThreadMilliseconds / static_cast<double>(RenderedSnapshotCount);
+		}
+
+		Statistics.LastFrameCPUMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStartTime).count();
+		TotalFrameCPUMilliseconds += Statistics.LastFrameCPUMilliseconds;
+		RecordedSnapshotCount++;
+		Statistics.AverageFrameCPUMilliseconds = TotalFrameCPUMilliseconds / static_cast<double>(RecordedSnapshotCount);
+		UpdateProcessCPUUsage();
+	}
+
+	void Window::RenderThreadFunction(std::wstring threadName)
+	{
+		//Named so each window's render thread can be told apart in a debugger or profiler
+		SetThreadDescription(GetCurrentThread(), threadName.c_str());
+		RenderThreadTimer.ResetElapsedTime();
+
+		while (true)
+		{
+			//Take the newest finished snapshot, leaving the one just drawn for the main thread to record into
+			{
+				std::unique_lock<std::mutex> snapshotLock(SnapshotMutex);
+				SnapshotCondition.wait(snapshotLock, [this]() { return IsSnapshotReady || !IsRenderThreadRunning; });
+				if (!IsRenderThreadRunning)
+				{
+					return;
+				}
+
+				std::swap(ReadySnapshotIndex, RenderingSnapshotIndex);
+				IsSnapshotReady = false;
+			}
+
+			const FrameSnapshot& snapshot = Snapshots[RenderingSnapshotIndex];
+			std::chrono::steady_clock::time_point renderStartTime = std::chrono::steady_clock::now();
+			try
+			{
+				Profiler::Zone profileZone("Window::RenderSnapshot");
+				if (Application::GetFramePacing() == FramePacingClass::SwapChainWaitable)
+				{
+					GraphicsController->WaitForNextFrame();
+				}
+
+				//Nothing can be drawn until the main thread recovers a lost device, and snapshots from before then point at
+				//textures that no longer exist
+				std::unique_lock<std::recursive_mutex> contextLock = GraphicsController->LockContext();
+				if (GraphicsController->IsDeviceLostPending() || snapshot.DeviceLostCount != GraphicsController->GetDeviceLostCount())
+				{
+					RenderThreadSnapshotsDropped++;
+				}
+				else
+				{
+					GraphicsController->ClearFrame(0.5f, 0.0f, 0.9f);
+					for (size_t layer = 0; layer < snapshot.Layers.size(); layer++)
+					{
+						const LayerSnapshot& layerSnapshot = snapshot.Layers[layer];
+						GraphicsController->BeginGPUPass("Layer", static_cast<uint32_t>(layer));
+						GraphicsController->SetLayerRenderState(layerSnapshot.RenderState);
+						GraphicsController->SubmitCommandList(layerSnapshot.CommandList, layerSnapshot.RenderState.SortMode == DirectX::SpriteSortMode_Texture);
+						GraphicsController->EndGPUPass();
+					}
+
+					if (GraphicsController->Present())
+					{
+						RenderThreadFramesPresented++;
+						RenderThreadTimer.Tick([]() {});
+						RenderThreadFramesPerSecond = RenderThreadTimer.GetFramesPerSecond();
+					}
+				}
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> snapshotLock(SnapshotMutex);
+				RenderThreadException = std::current_exception();
+				IsRenderThreadRunning = false;
+				return;
+			}
+
+			RenderThreadTotalMicroseconds += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - renderStartTime).count());
+			RenderThreadSnapshotCount++;
+			LastRenderedSnapshotNumber = snapshot.FrameNumber;
+		}
+	}
+
+	void Window::StartRenderThread()
+	{
+		//The render thread may still be drawing a snapshot when a drawable is removed, so removed drawables are kept until it is done.
+		//A lost device can only be recovered by the main thread, between recordings
+		Layers.SetRetainingReleases(true);
+		GraphicsController->SetDeviceLostRecoveryDeferred(true);
+
+		{
+			std::lock_guard<std::mutex> snapshotLock(SnapshotMutex);
+			IsSnapshotReady = false;
+			IsRenderThreadRunning = true;
+			RenderThreadException = nullptr;
+		}
+		RenderThread = std::thread(&Window::RenderThreadFunction, this, std::format(L"Render thread ({})", WindowTitle));
+	}
+
+	void Window::StopRenderThread()
+	{
+		if (!RenderThread.joinable())
+		{
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> snapshotLock(SnapshotMutex);
+			IsRenderThreadRunning = false;
+		}
+		SnapshotCondition.notify_all();
+		RenderThread.join();
+
+		//Nothing reads the snapshots any more, so whatever was kept alive for them can go
+		Layers.SetRetainingReleases(false);
+		Layers.TakeReleasedDrawables(ReleasedDrawables);
+		ReleasedDrawables.clear();
+		RetiredDrawables.clear();
+		GraphicsController->SetDeviceLostRecoveryDeferred(false);
+		GraphicsController->RecoverLostDevice();
+	}
+
+	//Drawables removed from the layers may still be in a snapshot the render thread has not finished with. Each waits until the
+	//render thread has moved past the snapshot just published, which is the newest one that could hold it
+	void Window::RetireReleasedDrawables()
+	{
+		uint64_t publishedSnapshotNumber = NextSnapshotNumber - 1;
+		Layers.TakeReleasedDrawables(ReleasedDrawables);
+		for (std::shared_ptr<IDrawable>& releasedDrawable : ReleasedDrawables)
+		{
+			RetiredDrawables.emplace_back(publishedSnapshotNumber, std::move(releasedDrawable));
+		}
+		ReleasedDrawables.clear();
+
+		uint64_t lastRenderedSnapshotNumber = LastRenderedSnapshotNumber;
+		std::erase_if(RetiredDrawables, [lastRenderedSnapshotNumber](const std::pair<uint64_t, std::shared_ptr<IDrawable>>& retiredDrawable)
+			{
+				return retiredDrawable.first <= lastRenderedSnapshotNumber;
+			});
+	}
+
+	void Window::MarkLayerDirty(size_t layer)
+	{
+		if (DirtyLayers.size() <= layer)
+		{
+			DirtyLayers.resize(layer + 1, true);
+		}
+		DirtyLayers[layer] = true;
+	}
+
+	void Window::UpdateProcessCPUUsage()
+	{
+		//Only sample about once a second, since GetProcessTimes is coarse
+		FILETIME currentTime;
+		GetSystemTimeAsFileTime(&currentTime);
+		uint64_t currentTimeTicks = (static_cast<uint64_t>(currentTime.dwHighDateTime) << 32) | currentTime.dwLowDateTime;
+		if (currentTimeTicks - CPUUsageSampleTime < 10'000'000)
+		{
+			return;
+		}
+
+		FILETIME creationTime, exitTime, kernelTime, userTime;
+		if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+		{
+			return;
+		}
+		uint64_t processTimeTicks =
+			((static_cast<uint64_t>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime) +
+			((static_cast<uint64_t>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime);
+
+		if (CPUUsageSampleTime != 0)
+		{
+			Statistics.ProcessCPUUsage = static_cast<double>(processTimeTicks - CPUUsageSampleProcessTime) / static_cast<double>(currentTimeTicks - CPUUsageSampleTime);
+		}
+
+		CPUUsageSampleTime = currentTimeTicks;
+		CPUUsageSampleProcessTime = processTimeTicks;
 	}
 	
 	void Window::UpdateAndDraw(const DX::StepTimer& timer)
 	{
+		BeginFrame();
 		UpdateWindow(timer);
-		RenderWindow();
+		DrawFrame();
+	}
+
+	void Window::BeginFrame()
+	{
+		if (RenderPipeline == RenderPipelineClass::Pipelined)
+		{
+			//An error on the render thread is thrown from here, where the message loop can handle it
+			{
+				std::lock_guard<std::mutex> snapshotLock(SnapshotMutex);
+				if (RenderThreadException)
+				{
+					std::rethrow_exception(std::exchange(RenderThreadException, nullptr));
+				}
+			}
+
+			//A lost device is only recovered between recordings, since recovery replaces the textures the drawables point at
+			GraphicsController->RecoverLostDevice();
+		}
+
+		//Sleep until the swap chain can take another frame, then read input and update right before drawing
+		else if (Application::GetFramePacing() == FramePacingClass::SwapChainWaitable)
+		{
+			GraphicsController->WaitForNextFrame();
+		}
+
+		//Input is handled once every frame, even when the page is updated more or less often than the window is drawn
+		LayerStore::IterationGuard iterationGuard(Layers);
+		Profiler::Zone profileZone("Window::DispatchMouseEvents");
+		DispatchMouseEvents();
+	}
+
+	void Window::DrawFrame()
+	{
+		if (RenderPipeline == RenderPipelineClass::Pipelined)
+		{
+			//The render thread presents the last frame while this one is recorded
+			RecordAndPublishSnapshot();
+			RetireReleasedDrawables();
+		}
+		else
+		{
+			RenderWindow();
+		}
 
 		//Swap out page if user requests
 		if (QueuedPage != nullptr)
@@ -296,6 +783,12 @@ namespace DivergenceEngine
 			//Reset the audio
 			AudioController->Reset();
 			
+			//The new page starts drawn in immediate mode, like the first page. A page that turns retained rendering on must
+			//mark its drawables dirty, and the next page may never do that
+			SetRenderMode(RenderModeClass::Immediate);
+			DirtyLayers.assign(Layers.GetLayerCount(), true);
+			IsCompositionStale = true;
+
 			PageReference = std::move(QueuedPage);
 			QueuedPage = nullptr;
 
@@ -303,61 +796,181 @@ namespace DivergenceEngine
 		}
 	}
 
-	void Window::AddDrawableComponent(std::shared_ptr<IDrawable> drawableComponent, size_t layer)
+	DrawableHandle Window::AddDrawableComponent(std::shared_ptr<IDrawable> drawableComponent, size_t layer)
+	{
+		//Add the drawable component to the specified layer, which is made if it does not exist yet. It is drawn after everything already added, so it is hit tested before them
+		IDrawable* drawable = drawableComponent.get();
+		DrawableHandle drawableHandle = Layers.Add(std::move(drawableComponent), layer);
+		HitTestGrid->Insert(drawable, layer, NextDrawableOrder++);
+		IsHoverStale = true;
+		MarkLayerDirty(layer);
+		return drawableHandle;
+	}
+
+	void Window::RemoveDrawableComponent(DrawableHandle drawableHandle)
 	{
-		//If the number of layers is less than the layer specified, resize the layer vector (NOTE: layer is a 0-based index)
-		if (LayersOfDrawableComponents.size() <= layer)
+		//Handles to drawables that were already removed find nothing, so there is nothing to do for them
+		IDrawable* drawable = Layers.Get(drawableHandle);
+		if (drawable == nullptr)
 		{
-			LayersOfDrawableComponents.resize(layer + 1);
+			return;
 		}
 
-		//Add the drawable component to the specified layer
-		LayersOfDrawableComponents[layer].push_back(drawableComponent);
+		size_t layer = Layers.GetLayerIndex(drawableHandle);
+		ForgetDrawable(drawable);
+		Layers.Remove(drawableHandle);
+		MarkLayerDirty(layer);
 	}
 
 	void Window::RemoveDrawableComponent(std::shared_ptr<IDrawable> drawableComponent, size_t layer)
 	{
-		//If the number of layers is less than the layer specified, the layer does not exist and the function can return, doing nothing
-		if (LayersOfDrawableComponents.size() <= layer)
+		//If the drawable component is not in the specified layer, the function can return, doing nothing
+		std::optional<DrawableHandle> drawableHandle = Layers.Find(drawableComponent.get());
+		if (!drawableHandle.has_value() || Layers.GetLayerIndex(drawableHandle.value()) != layer)
 		{
 			return;
 		}
 
-		//Search within the specified layer for the drawable component and remove it from the layers
-		for (auto it = LayersOfDrawableComponents[layer].begin(); it != LayersOfDrawableComponents[layer].end(); ++it)
-		{
-			if (*it == drawableComponent)
-			{
-				LayersOfDrawableComponents[layer].erase(it);
-				return;
-			}
-		}
+		ForgetDrawable(drawableComponent.get());
+		Layers.Remove(drawableHandle.value());
+		MarkLayerDirty(layer);
+	}
+
+	void Window::ReleaseDrawable(std::shared_ptr<IDrawable> drawable)
+	{
+		//Kept while the layers are iterated, or until the render thread is done with the snapshots that could hold it
+		Layers.Release(std::move(drawable));
 	}
 
 	void Window::ClearLayer(size_t layer)
 	{
 		//If the layer index is out of range, return
-		if (LayersOfDrawableComponents.size() <= layer)
+		if (Layers.GetLayerCount() <= layer)
 		{
 			return;
 		}
 
 		//Clear the layer
-		LayersOfDrawableComponents[layer].clear();
+		for (IDrawable* component : Layers.GetLayer(layer))
+		{
+			if (component != nullptr)
+			{
+				ForgetDrawable(component);
+			}
+		}
+		Layers.ClearLayer(layer);
+		MarkLayerDirty(layer);
 	}
 
 	void Window::ClearAllLayers()
 	{
 		//Clear all layers
-		LayersOfDrawableComponents.clear();
+		HitTestGrid->Clear();
+		IsHoverStale = true;
+		HoveredDrawables.clear();
+		PreviouslyHoveredDrawables.clear();
+		Layers.Clear();
+		LayerRenderStates.clear();
+		DirtyLayers.clear();
+		IsCompositionStale = true;
+	}
+
+	void Window::SetRenderMode(RenderModeClass renderMode)
+	{
+		if (RenderMode == renderMode)
+		{
+			return;
+		}
+
+		//Whatever was cached before is out of date, and immediate mode has no use for the caches
+		RenderMode = renderMode;
+		DirtyLayers.assign(Layers.GetLayerCount(), true);
+		IsCompositionStale = true;
+		if (RenderMode == RenderModeClass::Immediate)
+		{
+			GraphicsController->ReleaseLayerCaches();
+		}
+	}
+
+	Window::RenderModeClass Window::GetRenderMode() const noexcept
+	{
+		return RenderMode;
+	}
+
+	void Window::SetCommandRecording(CommandRecordingClass commandRecording) noexcept
+	{
+		CommandRecording = commandRecording;
+	}
+
+	void Window::SetLayerRenderState(size_t layer, const LayerRenderState& layerRenderState)
+	{
+		if (LayerRenderStates.size() <= layer)
+		{
+			LayerRenderStates.resize(layer + 1);
+		}
+
+		//The layer looks different under a new state, so its cache is out of date
+		LayerRenderStates[layer] = layerRenderState;
+		MarkLayerDirty(layer);
+	}
+
+	//Pipelining overlaps updating the next frame with presenting the last. The layer caches of retained mode are not used
+	//while pipelined, and each layer is recorded on the main thread whatever the command recording is set to
+	void Window::SetRenderPipeline(RenderPipelineClass renderPipeline)
+	{
+		if (RenderPipeline == renderPipeline)
+		{
+			return;
+		}
+
+		RenderPipeline = renderPipeline;
+		if (RenderPipeline == RenderPipelineClass::Pipelined)
+		{
+			GraphicsController->ReleaseLayerCaches();
+			StartRenderThread();
+		}
+		else
+		{
+			StopRenderThread();
+			DirtyLayers.assign(Layers.GetLayerCount(), true);
+			IsCompositionStale = true;
+		}
+	}
+
+	Window::RenderPipelineClass Window::GetRenderPipeline() const noexcept
+	{
+		return RenderPipeline;
+	}
+
+	bool Window::WasLastFrameSkipped() const noexcept
+	{
+		return IsLastFrameSkipped && RenderPipeline == RenderPipelineClass::Serial;
+	}
+
+	const Window::RenderStatistics& Window::GetRenderStatistics() const noexcept
+	{
+		return Statistics;
+	}
+
+	void Window::ResetRenderStatistics() noexcept
+	{
+		Statistics = RenderStatistics();
+		TotalFrameCPUMilliseconds = 0;
+		CPUUsageSampleTime = 0;
+		CPUUsageSampleProcessTime = 0;
+		TotalRenderThreadMilliseconds = 0;
+		RenderedSnapshotCount = 0;
+		RecordedSnapshotCount = 0;
 	}
 
 	void Window::DispatchMouseEvents()
 	{
-		HandleMouseOverEvents();
-		
+		static Counter& mouseEventsDispatched = MetricsRegistry::GetCounter("Window.MouseEventsDispatched");
+		bool hasMouseMoved = false;
 		while (!MouseObject.IsQueueEmpty())
 		{
+			mouseEventsDispatched.Add();
+
 			//Get the mouse event (will not be empty because it only is if the queue is empty, which is checked in the while loop)
 			DivergenceEngine::Mouse::Event currentEvent = *MouseObject.GetNextMouseEvent();
 
@@ -368,6 +981,7 @@ namespace DivergenceEngine
 				break;
 
 			case DivergenceEngine::Mouse::Event::Type::Move:
+				hasMouseMoved = true;
 				PageReference->HandleMouseMove(DirectX::XMINT2(currentEvent.GetPosX(), currentEvent.GetPosY()));
 				break;
 
@@ -377,87 +991,147 @@ namespace DivergenceEngine
 					
 			}
 		}
+
+		//What is under the cursor only changes when it moves or the drawables under it change, so hovering is skipped otherwise
+		if (hasMouseMoved || IsHoverStale || HitTestGrid->HasPendingBoundsUpdates())
+		{
+			HandleHoverEvents(hasMouseMoved);
+		}
+	}
+
+	//Drawables are not touched after they leave the window, so they are taken out of hit testing as they go
+	void Window::ForgetDrawable(IDrawable* drawable)
+	{
+		HitTestGrid->Remove(drawable);
+		std::erase(HoveredDrawables, drawable);
+		std::erase(PreviouslyHoveredDrawables, drawable);
+		IsHoverStale = true;
 	}
 
 	void Window::HandleMousePressReleaseEvent(DivergenceEngine::Mouse::Event newEvent)
 	{
-		//Iterate through the layers and check if the mouse is over any of the drawables. If it is, try to trigger the appropriate event. When an event is successful, break out
-		for (auto& layer : LayersOfDrawableComponents)
+		//Go through the drawables whose bounds hold the mouse, from the top down, and check if the mouse is over them. If it is, try to trigger the appropriate event. When an event is successful, or the drawable blocks input, break out
+		HitTestGrid->Query(newEvent.GetPos(), HitTestCandidates);
+		for (const SpatialGrid::Candidate& candidate : HitTestCandidates)
 		{
-			for (auto& component : layer)
+			//A handler that did not take the event may have removed drawables further down. They are still alive until the
+			//iteration is over, but are no longer in the window, so they are skipped
+			IDrawable* component = candidate.Drawable;
+			if (!Layers.Find(component).has_value())
+			{
+				continue;
+			}
+
+			if (component->IsCoordInObject(newEvent.GetPos()))
 			{
-				if (component->IsCoordInObject(newEvent.GetPos()))
+				switch (newEvent.GetType())
 				{
-					switch (newEvent.GetType())
+				case DivergenceEngine::Mouse::Event::Type::LPress:
+					if (component->OnLeftPress(newEvent.GetPos()))
 					{
-					case DivergenceEngine::Mouse::Event::Type::LPress:
-						if (component->OnLeftPress(newEvent.GetPos()))
-						{
-							return;
-						}
-						break;
+						return;
+					}
+					break;
 
-					case DivergenceEngine::Mouse::Event::Type::LRelease:
-						if (component->OnLeftRelease(newEvent.GetPos()))
-						{
-							return;
-						}
-						break;
+				case DivergenceEngine::Mouse::Event::Type::LRelease:
+					if (component->OnLeftRelease(newEvent.GetPos()))
+					{
+						return;
+					}
+					break;
 
-					case DivergenceEngine::Mouse::Event::Type::MPress:
-						if (component->OnMiddlePress(newEvent.GetPos()))
-						{
-							return;
-						}
-						break;
+				case DivergenceEngine::Mouse::Event::Type::MPress:
+					if (component->OnMiddlePress(newEvent.GetPos()))
+					{
+						return;
+					}
+					break;
 
-					case DivergenceEngine::Mouse::Event::Type::MRelease:
-						if (component->OnMiddleRelease(newEvent.GetPos()))
-						{
-							return;
-						}
-						break;
-						
-					case DivergenceEngine::Mouse::Event::Type::RPress:
-						if (component->OnRightPress(newEvent.GetPos()))
-						{
-							return;
-						}
-						break;
+				case DivergenceEngine::Mouse::Event::Type::MRelease:
+					if (component->OnMiddleRelease(newEvent.GetPos()))
+					{
+						return;
+					}
+					break;
+					
+				case DivergenceEngine::Mouse::Event::Type::RPress:
+					if (component->OnRightPress(newEvent.GetPos()))
+					{
+						return;
+					}
+					break;
 
-					case DivergenceEngine::Mouse::Event::Type::RRelease:
-						if (component->OnRightRelease(newEvent.GetPos()))
-						{
-							return;
-						}
-						break;
+				case DivergenceEngine::Mouse::Event::Type::RRelease:
+					if (component->OnRightRelease(newEvent.GetPos()))
+					{
+						return;
 					}
+					break;
+				}
+
+				if (component->BlocksInput())
+				{
+					return;
 				}
 			}
 		}
 	}
 
-	void Window::HandleMouseOverEvents()
+	void Window::HandleHoverEvents(bool hasMouseMoved)
 	{
+		IsHoverStale = false;
+
 		//Get the current mouse position
 		DirectX::XMINT2 mousePosition = MouseObject.GetPos();
 
-		//Iterate through every object starting from layer 0, to see if the mouse is over it. When the mouse is over an object, call OnMouseOver. After that, call OnMouseNotOver for rest without checking
-		bool mouseFoundObject = false;
-		for (auto& layer : LayersOfDrawableComponents)
+		//Only the drawables whose bounds hold the mouse can be under it. Find every one that is, from the top down, stopping
+		//at the first one that blocks input since everything under it is hidden from the mouse
+		std::swap(HoveredDrawables, PreviouslyHoveredDrawables);
+		HoveredDrawables.clear();
+		HitTestGrid->Query(mousePosition, HitTestCandidates);
+		for (const SpatialGrid::Candidate& candidate : HitTestCandidates)
 		{
-			for (auto& component : layer)
+			if (candidate.Drawable->IsCoordInObject(mousePosition))
 			{
-				if (!mouseFoundObject || component->IsCoordInObject(mousePosition))
+				HoveredDrawables.push_back(candidate.Drawable);
+				if (candidate.Drawable->BlocksInput())
 				{
-					component->OnMouseOver(mousePosition);
-					mouseFoundObject = true;
+					break;
 				}
+			}
+		}
 
-				else
-				{
-					component->OnMouseNotOver();
-				}
+		//Drawables the mouse has left hear about it before the ones it has come over. A handler can remove drawables, which
+		//takes them out of both lists, so the events go out from copies and skip anything no longer in the live list
+		HoveredSnapshot.assign(HoveredDrawables.begin(), HoveredDrawables.end());
+		PreviouslyHoveredSnapshot.assign(PreviouslyHoveredDrawables.begin(), PreviouslyHoveredDrawables.end());
+		for (IDrawable* drawable : PreviouslyHoveredSnapshot)
+		{
+			if (std::find(PreviouslyHoveredDrawables.begin(), PreviouslyHoveredDrawables.end(), drawable) == PreviouslyHoveredDrawables.end())
+			{
+				continue;
+			}
+
+			if (std::find(HoveredSnapshot.begin(), HoveredSnapshot.end(), drawable) == HoveredSnapshot.end())
+			{
+				drawable->OnMouseLeave();
+			}
+		}
+
+		for (IDrawable* drawable : HoveredSnapshot)
+		{
+			if (std::find(HoveredDrawables.begin(), HoveredDrawables.end(), drawable) == HoveredDrawables.end())
+			{
+				continue;
+			}
+
+			if (std::find(PreviouslyHoveredSnapshot.begin(), PreviouslyHoveredSnapshot.end(), drawable) == PreviouslyHoveredSnapshot.end())
+			{
+				drawable->OnMouseEnter(mousePosition);
+			}
+			else if (hasMouseMoved)
+			{
+				drawable->OnMouseMove(mousePosition);
 			}
 		}
 	}
@@ -470,7 +1144,9 @@ namespace DivergenceEngine
 
 	void Window::UpdateWindow(const DX::StepTimer& timer)
 	{
-		DispatchMouseEvents();
+		//Event handlers and the page may remove drawables while the layers are in use, including the drawable being called
+		LayerStore::IterationGuard iterationGuard(Layers);
+		Profiler::Zone profileZone("IPage::UpdatePage");
 		PageReference->UpdatePage(timer);
 	}
 
@@ -486,6 +1162,8 @@ namespace DivergenceEngine
 
 	void Window::UpdateAudio()
 	{
+		Profiler::Zone profileZone("Window::UpdateAudio");
+
 		if (RetryAudio)
 		{
 			RetryAudio = false;
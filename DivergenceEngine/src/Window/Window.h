@@ -3,20 +3,64 @@
 #include <cstdint>
 #include <string>
 #include <memory>
-#include <list>
 #include "Keyboard.h"
 #include "Mouse.h"
 #include "Application/StepTimer.h"
 #include "Graphics/Graphics.h"
 #include "IDrawable.h"
+#include "SpatialGrid.h"
+#include "LayerStore.h"
 #include "IPage.h"
 #include <Audio.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 namespace DivergenceEngine
 {
 	class Window
 	{
+	public:
+		//How the layers are drawn every frame
+		enum class RenderModeClass
+		{
+			Immediate, //Every drawable is drawn every frame
+			Retained //Layers are cached offscreen and only drawn again when one of their drawables is marked dirty
+		};
+
+		//How drawables get their sprites to the Graphics controller
+		enum class CommandRecordingClass
+		{
+			Off, //Drawables draw straight into the sprite batch
+			Serial, //Drawables record into a command list on the render thread, which is then submitted
+			Parallel //Each layer is split into chunks that record on worker threads. Every Draw must then be safe to call from any thread
+		};
+
+		//Which threads a frame is worked on
+		enum class RenderPipelineClass
+		{
+			Serial, //Each frame is updated, drawn and presented on the main thread, one after the other
+			Pipelined //The main thread updates and records a snapshot of the frame, while a render thread submits and presents the one before it
+		};
+
+		//Counters for how much rendering work the window has done. The CPU figures are a stand in for power usage
+		struct RenderStatistics
+		{
+			uint64_t FramesPresented = 0;
+			uint64_t FramesSkipped = 0; //Frames where nothing changed, so nothing was drawn or presented
+			uint64_t LayersRedrawn = 0;
+			double LastFrameCPUMilliseconds = 0; //Time spent in RenderWindow on the last frame (recording the snapshot, when pipelined)
+			double AverageFrameCPUMilliseconds = 0;
+			double ProcessCPUUsage = 0; //CPU time the process used over the last second, as a fraction of one core
+			uint64_t SnapshotsDropped = 0; //Pipelined only. Snapshots replaced by a newer one before the render thread got to them
+			double AverageRenderThreadMilliseconds = 0; //Pipelined only. Time the render thread spends submitting and presenting a snapshot
+			uint32_t RenderThreadFramesPerSecond = 0; //Pipelined only. Frames the render thread presented over the last second
+		};
+
 	private:
 
 		//Singleton class. Only one instance of this class can exist.
@@ -53,19 +97,99 @@ namespace DivergenceEngine
 		LRESULT HandleMessage(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
 		//Rendering
-		std::vector<std::list<std::shared_ptr<IDrawable>>> LayersOfDrawableComponents;
+		LayerStore Layers;
+		std::vector<LayerRenderState> LayerRenderStates;
 		void RenderWindow();
 
+		//Command recording
+		static constexpr size_t DRAWABLES_PER_RECORDING_CHUNK = 256;
+		CommandRecordingClass CommandRecording = CommandRecordingClass::Off;
+		std::vector<size_t> RecordingChunkIndices;
+		std::vector<RenderCommandList> RecordingChunkCommandLists;
+		RenderCommandList LayerCommandList;
+		void DrawLayer(size_t layer);
+
+		//Pipelined rendering. The main thread records into one snapshot, the newest finished one waits in another, and the render
+		//thread draws from the third, so neither thread ever waits for the other to let go of a snapshot
+		struct LayerSnapshot
+		{
+			LayerRenderState RenderState;
+			RenderCommandList CommandList;
+		};
+		struct FrameSnapshot
+		{
+			std::vector<LayerSnapshot> Layers;
+			uint64_t FrameNumber = 0;
+			uint32_t DeviceLostCount = 0; //Snapshots recorded before the device was lost point at textures that are gone
+		};
+		static constexpr size_t SNAPSHOT_COUNT = 3;
+		RenderPipelineClass RenderPipeline = RenderPipelineClass::Serial;
+		std::array<FrameSnapshot, SNAPSHOT_COUNT> Snapshots;
+		size_t RecordingSnapshotIndex = 0;
+		size_t ReadySnapshotIndex = 1;
+		size_t RenderingSnapshotIndex = 2;
+		bool IsSnapshotReady = false;
+		bool IsRenderThreadRunning = false;
+		uint64_t NextSnapshotNumber = 1;
+		std::mutex SnapshotMutex;
+		std::condition_variable SnapshotCondition;
+		std::thread RenderThread;
+		std::exception_ptr RenderThreadException;
+		std::atomic<uint64_t> LastRenderedSnapshotNumber = 0;
+		std::atomic<uint64_t> RenderThreadFramesPresented = 0;
+		std::atomic<uint64_t> RenderThreadSnapshotsDropped = 0;
+		std::atomic<uint64_t> RenderThreadTotalMicroseconds = 0;
+		std::atomic<uint64_t> RenderThreadSnapshotCount = 0;
+		std::atomic<uint32_t> RenderThreadFramesPerSecond = 0;
+		DX::StepTimer RenderThreadTimer; //Only touched by the render thread, which keeps its own time apart from the application's
+		double TotalRenderThreadMilliseconds = 0;
+		uint64_t RenderedSnapshotCount = 0;
+		uint64_t RecordedSnapshotCount = 0;
+		std::vector<std::shared_ptr<IDrawable>> ReleasedDrawables;
+		std::vector<std::pair<uint64_t, std::shared_ptr<IDrawable>>> RetiredDrawables;
+		void RecordAndPublishSnapshot();
+		void RenderThreadFunction(std::wstring threadName);
+		void StartRenderThread();
+		void StopRenderThread();
+		void RetireReleasedDrawables();
+
+		//Retained rendering
+		RenderModeClass RenderMode = RenderModeClass::Immediate;
+		std::vector<bool> DirtyLayers;
+		bool IsCompositionStale = true;
+		float LayerCacheRenderScale = 1.0f;
+		uint32_t LayerCacheDeviceLostCount = 0;
+		bool IsLastFrameSkipped = false; //Nothing changed, so nothing was presented. The Application waits the frame out
+		void RenderRetainedWindow();
+		void MarkLayerDirty(size_t layer);
+
+		//Render statistics
+		RenderStatistics Statistics;
+		double TotalFrameCPUMilliseconds = 0;
+		uint64_t CPUUsageSampleTime = 0;
+		uint64_t CPUUsageSampleProcessTime = 0;
+		void UpdateProcessCPUUsage();
+
+		//Hit testing
+		std::unique_ptr<SpatialGrid> HitTestGrid;
+		std::vector<SpatialGrid::Candidate> HitTestCandidates;
+		std::vector<IDrawable*> HoveredDrawables;
+		std::vector<IDrawable*> PreviouslyHoveredDrawables;
+		std::vector<IDrawable*> HoveredSnapshot; //Copies of the two lists above that hover events are sent from
+		std::vector<IDrawable*> PreviouslyHoveredSnapshot;
+		uint64_t NextDrawableOrder = 0;
+		bool IsHoverStale = true; //Drawables were added or removed, so what is under the cursor may have changed without it moving
+		void ForgetDrawable(IDrawable* drawable);
+
 		//Layer mouse event handler functions
 		void DispatchMouseEvents();
 		void HandleMousePressReleaseEvent(DivergenceEngine::Mouse::Event newEvent);
-		void HandleMouseOverEvents();
+		void HandleHoverEvents(bool hasMouseMoved);
 
 		//Page
 		std::unique_ptr<IPage> QueuedPage;
 		std::unique_ptr<IPage> PageReference;
 		bool OnWindowDestructionRequest();
-		void UpdateWindow(const DX::StepTimer& timer);
 
 		//Audio
 		bool IsAudioControllerUpdating;
@@ -93,11 +217,30 @@ namespace DivergenceEngine
 		//Public functions
 		void UpdateAndDraw(const DX::StepTimer& timer);
 
+		//The steps of UpdateAndDraw, for when the page is updated a different number of times than the window is drawn.
+		//BeginFrame handles the mouse events, so input is never held back waiting for an update
+		void BeginFrame();
+		void UpdateWindow(const DX::StepTimer& timer);
+		void DrawFrame();
+
 		//Rendering functions
-		void AddDrawableComponent(std::shared_ptr<IDrawable> drawableComponent, size_t layer);
+		DrawableHandle AddDrawableComponent(std::shared_ptr<IDrawable> drawableComponent, size_t layer);
+		void RemoveDrawableComponent(DrawableHandle drawableHandle);
 		void RemoveDrawableComponent(std::shared_ptr<IDrawable> drawableComponent, size_t layer);
 		void ClearLayer(size_t layer);
 		void ClearAllLayers();
+		void ReleaseDrawable(std::shared_ptr<IDrawable> drawable); //For drawables removed from inside a layer's drawable, which may still be drawn or handling input
+		void SetRenderMode(RenderModeClass renderMode);
+		RenderModeClass GetRenderMode() const noexcept;
+		void SetCommandRecording(CommandRecordingClass commandRecording) noexcept;
+		void SetLayerRenderState(size_t layer, const LayerRenderState& layerRenderState);
+		void SetRenderPipeline(RenderPipelineClass renderPipeline);
+		RenderPipelineClass GetRenderPipeline() const noexcept;
+		bool WasLastFrameSkipped() const noexcept;
+
+		//Statistics
+		const RenderStatistics& GetRenderStatistics() const noexcept;
+		void ResetRenderStatistics() noexcept;
 
 		//Helpers
 		bool IsEqualHandle(HWND windowHandle) const noexcept;